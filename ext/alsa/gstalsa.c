@@ -709,6 +709,50 @@ const GstAudioChannelPosition alsa_position[][8] = {
       GST_AUDIO_CHANNEL_POSITION_SIDE_RIGHT}
 };
 
+/* Copies up to @frames interleaved frames between @data and the mmapped
+ * hardware buffer of @handle, in the direction of the stream. Returns the
+ * number of transferred frames, -EAGAIN when the device has no room or data
+ * available or another negative error code, like snd_pcm_writei() and
+ * snd_pcm_readi() do. */
+snd_pcm_sframes_t
+gst_alsa_mmap_transfer (snd_pcm_t * handle, guint8 * data,
+    snd_pcm_uframes_t frames)
+{
+  const snd_pcm_channel_area_t *areas;
+  snd_pcm_uframes_t offset, size;
+  snd_pcm_sframes_t avail, res;
+  gboolean capture;
+  guint8 *hw;
+
+  capture = snd_pcm_stream (handle) == SND_PCM_STREAM_CAPTURE;
+
+  /* capture is not started implicitly when we don't use snd_pcm_readi() */
+  if (capture && snd_pcm_state (handle) == SND_PCM_STATE_PREPARED) {
+    if ((res = snd_pcm_start (handle)) < 0)
+      return res;
+  }
+
+  if ((avail = snd_pcm_avail_update (handle)) < 0)
+    return avail;
+
+  size = MIN (frames, (snd_pcm_uframes_t) avail);
+  if (size == 0)
+    return -EAGAIN;
+
+  if ((res = snd_pcm_mmap_begin (handle, &areas, &offset, &size)) < 0)
+    return res;
+
+  /* with interleaved access all channels share the first area */
+  hw = (guint8 *) areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+
+  if (capture)
+    memcpy (data, hw, snd_pcm_frames_to_bytes (handle, size));
+  else
+    memcpy (hw, data, snd_pcm_frames_to_bytes (handle, size));
+
+  return snd_pcm_mmap_commit (handle, offset, size);
+}
+
 #ifdef SND_CHMAP_API_VERSION
 /* +1 is to make zero as holes */
 #define ITEM(x, y) \
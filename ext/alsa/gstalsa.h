@@ -70,6 +70,10 @@ gchar *   gst_alsa_find_card_name   (GstObject        * obj,
 void      gst_alsa_add_channel_reorder_map (GstObject * obj,
                                             GstCaps   * caps);
 
+snd_pcm_sframes_t gst_alsa_mmap_transfer (snd_pcm_t         * handle,
+                                          guint8            * data,
+                                          snd_pcm_uframes_t   frames);
+
 extern const GstAudioChannelPosition alsa_position[][8];
 #ifdef SND_CHMAP_API_VERSION
 gboolean alsa_chmap_to_channel_positions (const snd_pcm_chmap_t *chmap,
@@ -59,6 +59,7 @@
 #define DEFAULT_DEVICE		"default"
 #define DEFAULT_DEVICE_NAME	""
 #define DEFAULT_CARD_NAME	""
+#define DEFAULT_USE_MMAP	FALSE
 #define SPDIF_PERIOD_SIZE 1536
 #define SPDIF_BUFFER_SIZE 15360
 
@@ -68,6 +69,7 @@ enum
   PROP_DEVICE,
   PROP_DEVICE_NAME,
   PROP_CARD_NAME,
+  PROP_USE_MMAP,
   PROP_LAST
 };
 
@@ -196,6 +198,21 @@ gst_alsasink_class_init (GstAlsaSinkClass * klass)
       g_param_spec_string ("card-name", "Card name",
           "Human-readable name of the sound card", DEFAULT_CARD_NAME,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAlsaSink:use-mmap:
+   *
+   * Write the samples directly into the mmapped hardware buffer instead of
+   * going through snd_pcm_writei(). Falls back to read/write access when the
+   * device does not support mmap. Takes effect the next time the device is
+   * configured.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Transfer samples through the mmapped hardware buffer",
+          DEFAULT_USE_MMAP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -215,6 +232,9 @@ gst_alsasink_set_property (GObject * object, guint prop_id,
         sink->device = g_strdup (DEFAULT_DEVICE);
       }
       break;
+    case PROP_USE_MMAP:
+      sink->use_mmap = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -243,6 +263,9 @@ gst_alsasink_get_property (GObject * object, guint prop_id,
           gst_alsa_find_card_name (GST_OBJECT_CAST (sink),
               sink->device, SND_PCM_STREAM_PLAYBACK));
       break;
+    case PROP_USE_MMAP:
+      g_value_set_boolean (value, sink->use_mmap);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -255,6 +278,7 @@ gst_alsasink_init (GstAlsaSink * alsasink)
   GST_DEBUG_OBJECT (alsasink, "initializing alsasink");
 
   alsasink->device = g_strdup (DEFAULT_DEVICE);
+  alsasink->use_mmap = DEFAULT_USE_MMAP;
   alsasink->handle = NULL;
   alsasink->cached_caps = NULL;
   g_mutex_init (&alsasink->alsa_lock);
@@ -442,6 +466,11 @@ retry:
   /* choose all parameters */
   CHECK (snd_pcm_hw_params_any (alsa->handle, params), no_config);
   /* set the interleaved read/write format */
+  if (alsa->access == SND_PCM_ACCESS_MMAP_INTERLEAVED &&
+      snd_pcm_hw_params_set_access (alsa->handle, params, alsa->access) < 0) {
+    GST_WARNING_OBJECT (alsa, "mmap access not available, using read/write");
+    alsa->access = SND_PCM_ACCESS_RW_INTERLEAVED;
+  }
   CHECK (snd_pcm_hw_params_set_access (alsa->handle, params, alsa->access),
       wrong_access);
   /* set the sample format */
@@ -817,7 +846,8 @@ alsasink_parse_spec (GstAlsaSink * alsa, GstAudioRingBufferSpec * spec)
   alsa->channels = GST_AUDIO_INFO_CHANNELS (&spec->info);
   alsa->buffer_time = spec->buffer_time;
   alsa->period_time = spec->latency_time;
-  alsa->access = SND_PCM_ACCESS_RW_INTERLEAVED;
+  alsa->access = alsa->use_mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED :
+      SND_PCM_ACCESS_RW_INTERLEAVED;
 
   if (spec->type == GST_AUDIO_RING_BUFFER_FORMAT_TYPE_RAW && alsa->channels < 9)
     gst_audio_ring_buffer_set_channel_positions (GST_AUDIO_BASE_SINK
@@ -1014,6 +1044,29 @@ xrun_recovery (GstAlsaSink * alsa, snd_pcm_t * handle, gint err)
   return err;
 }
 
+/* mmap variant of snd_pcm_writei(), which starts the stream once the buffer
+ * is filled up to the start threshold */
+static snd_pcm_sframes_t
+gst_alsasink_write_mmap (GstAlsaSink * alsa, guint8 * data,
+    snd_pcm_uframes_t frames)
+{
+  snd_pcm_sframes_t res, avail;
+
+  res = gst_alsa_mmap_transfer (alsa->handle, data, frames);
+  if (res <= 0)
+    return res;
+
+  if (snd_pcm_state (alsa->handle) == SND_PCM_STATE_PREPARED) {
+    avail = snd_pcm_avail_update (alsa->handle);
+    if (avail >= 0 && avail < alsa->period_size) {
+      GST_DEBUG_OBJECT (alsa, "buffer filled, starting");
+      if ((avail = snd_pcm_start (alsa->handle)) < 0)
+        return avail;
+    }
+  }
+  return res;
+}
+
 static gint
 gst_alsasink_write (GstAudioSink * asink, gpointer data, guint length)
 {
@@ -1047,7 +1100,10 @@ gst_alsasink_write (GstAudioSink * asink, gpointer data, guint length)
       GST_DEBUG_OBJECT (asink, "wait error, %d", err);
     } else {
       GST_DELAY_SINK_LOCK (asink);
-      err = snd_pcm_writei (alsa->handle, ptr, cptr);
+      if (alsa->access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+        err = gst_alsasink_write_mmap (alsa, ptr, cptr);
+      else
+        err = snd_pcm_writei (alsa->handle, ptr, cptr);
       GST_DELAY_SINK_UNLOCK (asink);
     }
 
@@ -68,6 +68,7 @@ struct _GstAlsaSink {
   gint bpf;
   gboolean iec958;
   gboolean need_swap;
+  gboolean use_mmap;
 
   guint buffer_time;
   guint period_time;
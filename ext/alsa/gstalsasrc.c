@@ -56,6 +56,7 @@
 #define DEFAULT_PROP_DEVICE		"default"
 #define DEFAULT_PROP_DEVICE_NAME	""
 #define DEFAULT_PROP_CARD_NAME	        ""
+#define DEFAULT_PROP_USE_MMAP		FALSE
 
 enum
 {
@@ -63,6 +64,7 @@ enum
   PROP_DEVICE,
   PROP_DEVICE_NAME,
   PROP_CARD_NAME,
+  PROP_USE_MMAP,
   PROP_LAST
 };
 
@@ -170,6 +172,21 @@ gst_alsasrc_class_init (GstAlsaSrcClass * klass)
       g_param_spec_string ("card-name", "Card name",
           "Human-readable name of the sound card",
           DEFAULT_PROP_CARD_NAME, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAlsaSrc:use-mmap:
+   *
+   * Read the samples directly from the mmapped hardware buffer instead of
+   * going through snd_pcm_readi(). Falls back to read/write access when the
+   * device does not support mmap. Takes effect the next time the device is
+   * configured.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Transfer samples through the mmapped hardware buffer",
+          DEFAULT_PROP_USE_MMAP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -188,6 +205,9 @@ gst_alsasrc_set_property (GObject * object, guint prop_id,
         src->device = g_strdup (DEFAULT_PROP_DEVICE);
       }
       break;
+    case PROP_USE_MMAP:
+      src->use_mmap = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -216,6 +236,9 @@ gst_alsasrc_get_property (GObject * object, guint prop_id,
           gst_alsa_find_card_name (GST_OBJECT_CAST (src),
               src->device, SND_PCM_STREAM_CAPTURE));
       break;
+    case PROP_USE_MMAP:
+      g_value_set_boolean (value, src->use_mmap);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -267,6 +290,7 @@ gst_alsasrc_init (GstAlsaSrc * alsasrc)
   GST_DEBUG_OBJECT (alsasrc, "initializing");
 
   alsasrc->device = g_strdup (DEFAULT_PROP_DEVICE);
+  alsasrc->use_mmap = DEFAULT_PROP_USE_MMAP;
   alsasrc->cached_caps = NULL;
   alsasrc->driver_timestamps = FALSE;
 
@@ -345,6 +369,11 @@ set_hwparams (GstAlsaSrc * alsa)
   /* choose all parameters */
   CHECK (snd_pcm_hw_params_any (alsa->handle, params), no_config);
   /* set the interleaved read/write format */
+  if (alsa->access == SND_PCM_ACCESS_MMAP_INTERLEAVED &&
+      snd_pcm_hw_params_set_access (alsa->handle, params, alsa->access) < 0) {
+    GST_WARNING_OBJECT (alsa, "mmap access not available, using read/write");
+    alsa->access = SND_PCM_ACCESS_RW_INTERLEAVED;
+  }
   CHECK (snd_pcm_hw_params_set_access (alsa->handle, params, alsa->access),
       wrong_access);
   /* set the sample format */
@@ -701,7 +730,8 @@ alsasrc_parse_spec (GstAlsaSrc * alsa, GstAudioRingBufferSpec * spec)
   alsa->channels = GST_AUDIO_INFO_CHANNELS (&spec->info);
   alsa->buffer_time = spec->buffer_time;
   alsa->period_time = spec->latency_time;
-  alsa->access = SND_PCM_ACCESS_RW_INTERLEAVED;
+  alsa->access = alsa->use_mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED :
+      SND_PCM_ACCESS_RW_INTERLEAVED;
 
   if (spec->type == GST_AUDIO_RING_BUFFER_FORMAT_TYPE_RAW && alsa->channels < 9)
     gst_audio_ring_buffer_set_channel_positions (GST_AUDIO_BASE_SRC
@@ -962,9 +992,17 @@ gst_alsasrc_read (GstAudioSrc * asrc, gpointer data, guint length,
 
   GST_ALSA_SRC_LOCK (asrc);
   while (cptr > 0) {
-    if ((err = snd_pcm_readi (alsa->handle, ptr, cptr)) < 0) {
+    if (alsa->access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+      err = gst_alsa_mmap_transfer (alsa->handle, ptr, cptr);
+    else
+      err = snd_pcm_readi (alsa->handle, ptr, cptr);
+
+    if (err < 0) {
       if (err == -EAGAIN) {
         GST_DEBUG_OBJECT (asrc, "Read error: %s", snd_strerror (err));
+        /* nothing captured yet, wait for the next period */
+        if (alsa->access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+          snd_pcm_wait (alsa->handle, (4 * alsa->period_time / 1000));
         continue;
       } else if (err == -ENODEV) {
         goto device_disappeared;
@@ -128,6 +128,12 @@ vorbis_dec_finalize (GObject * object)
   vorbis_dsp_clear (&vd->vd);
   vorbis_comment_clear (&vd->vc);
   vorbis_info_clear (&vd->vi);
+#ifdef USE_TREMOLO
+  if (vd->reorder) {
+    gst_audio_channel_reorder_free (vd->reorder);
+    vd->reorder = NULL;
+  }
+#endif
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -158,6 +164,12 @@ vorbis_dec_stop (GstAudioDecoder * dec)
   vorbis_dsp_clear (&vd->vd);
   vorbis_comment_clear (&vd->vc);
   vorbis_info_clear (&vd->vi);
+#ifdef USE_TREMOLO
+  if (vd->reorder) {
+    gst_audio_channel_reorder_free (vd->reorder);
+    vd->reorder = NULL;
+  }
+#endif
 
   return TRUE;
 }
@@ -204,6 +216,16 @@ vorbis_handle_identification_packet (GstVorbisDec * vd)
   /* select a copy_samples function, this way we can have specialized versions
    * for mono/stereo and avoid the depth switch in tremor case */
   vd->copy_samples = gst_vorbis_get_copy_sample_func (info.channels);
+#ifdef USE_TREMOLO
+  /* tremolo outputs in vorbis channel order, plan the reordering once */
+  if (vd->reorder)
+    gst_audio_channel_reorder_free (vd->reorder);
+  vd->reorder = NULL;
+  if (info.channels < 9)
+    vd->reorder = gst_audio_channel_reorder_new (GST_VORBIS_AUDIO_FORMAT,
+        info.channels, gst_vorbis_channel_positions[info.channels - 1],
+        gst_vorbis_default_channel_positions[info.channels - 1]);
+#endif
 
   return GST_FLOW_OK;
 }
@@ -492,10 +514,8 @@ vorbis_handle_data_packet (GstVorbisDec * vd, ogg_packet * packet,
     goto wrong_samples;
 
 #ifdef USE_TREMOLO
-  if (vd->info.channels < 9)
-    gst_audio_reorder_channels (map.data, map.size, GST_VORBIS_AUDIO_FORMAT,
-        vd->info.channels, gst_vorbis_channel_positions[vd->info.channels - 1],
-        gst_vorbis_default_channel_positions[vd->info.channels - 1]);
+  if (vd->reorder)
+    gst_audio_channel_reorder_samples (vd->reorder, map.data, map.size);
 #else
   /* copy samples in buffer */
   vd->copy_samples ((vorbis_sample_t *) map.data, pcm,
@@ -65,6 +65,9 @@ struct _GstVorbisDec {
   GstAudioInfo      info;
 
   CopySampleFunc    copy_samples;
+#ifdef USE_TREMOLO
+  GstAudioChannelReorder *reorder;
+#endif
 };
 
 struct _GstVorbisDecClass {
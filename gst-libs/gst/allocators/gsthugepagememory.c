@@ -0,0 +1,370 @@
+/* GStreamer huge page backed memory
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gsthugepagememory
+ * @short_description: Memory allocator backed by huge pages
+ * @see_also: #GstMemory, #GstAllocator
+ *
+ * The huge page allocator maps anonymous memory and asks the kernel to back
+ * it with huge pages, which greatly reduces TLB pressure when processing
+ * large video frames. Allocations smaller than a huge page are served from
+ * regular pages.
+ *
+ * With #GST_HUGE_PAGE_FLAG_EXPLICIT, memory is first taken from the
+ * reserved hugetlb pool. With #GST_HUGE_PAGE_FLAG_NUMA_LOCAL, memory is
+ * preferably placed on the NUMA node of the allocating thread.
+ *
+ * Video buffer pools use this allocator when
+ * #GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES is enabled on their configuration
+ * and an allocator was registered under the #GST_ALLOCATOR_HUGE_PAGE name:
+ * |[
+ *   gst_allocator_register (GST_ALLOCATOR_HUGE_PAGE,
+ *       gst_huge_page_allocator_new (GST_HUGE_PAGE_FLAG_NUMA_LOCAL));
+ * ]|
+ *
+ * Since: 1.8
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#include "gsthugepagememory.h"
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#if defined (SYS_getcpu) && defined (SYS_mbind)
+#define HAVE_NUMA_SYSCALLS 1
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#define NUMA_MASK_LONGS 16
+#endif
+
+GST_DEBUG_CATEGORY_STATIC (hugepage_debug);
+#define GST_CAT_DEFAULT hugepage_debug
+
+#define DEFAULT_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+typedef struct
+{
+  GstMemory mem;
+
+  /* the mapping, NULL for shared memory */
+  gpointer base;
+  gsize map_size;
+  /* aligned start of the memory */
+  guint8 *data;
+} GstHugePageMemory;
+
+static gsize
+get_huge_page_size (void)
+{
+  gsize size = DEFAULT_HUGE_PAGE_SIZE;
+  gchar *contents, *line;
+
+  if (g_file_get_contents ("/proc/meminfo", &contents, NULL, NULL)) {
+    if ((line = strstr (contents, "Hugepagesize:"))) {
+      guint64 kb = g_ascii_strtoull (line + strlen ("Hugepagesize:"), NULL, 10);
+      if (kb > 0)
+        size = kb * 1024;
+    }
+    g_free (contents);
+  }
+  return size;
+}
+
+#ifdef HAVE_NUMA_SYSCALLS
+static void
+bind_to_local_node (gpointer base, gsize size)
+{
+  unsigned long mask[NUMA_MASK_LONGS] = { 0, };
+  const guint bits = sizeof (unsigned long) * 8;
+  unsigned int cpu, node;
+
+  if (syscall (SYS_getcpu, &cpu, &node, NULL) != 0)
+    return;
+
+  if (node >= NUMA_MASK_LONGS * bits)
+    return;
+
+  mask[node / bits] |= 1UL << (node % bits);
+
+  /* pages are not faulted in yet, so this decides where they end up */
+  if (syscall (SYS_mbind, base, size, MPOL_PREFERRED, mask,
+          (unsigned long) (NUMA_MASK_LONGS * bits + 1), 0) != 0)
+    GST_DEBUG ("mbind to node %u failed: %s", node, g_strerror (errno));
+  else
+    GST_LOG ("%p: bound to node %u", base, node);
+}
+#endif
+
+static GstMemory *
+gst_huge_page_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+#ifdef HAVE_MMAP
+  GstHugePageAllocator *hpalloc = GST_HUGE_PAGE_ALLOCATOR_CAST (allocator);
+  GstHugePageMemory *mem;
+  gsize maxsize, map_size, align, aoffset;
+  gboolean huge;
+  gpointer base = MAP_FAILED;
+
+  maxsize = size + params->prefix + params->padding;
+  align = params->align | gst_memory_alignment;
+
+  /* mappings are page aligned, only bigger alignments need extra room */
+  map_size = maxsize;
+  if (align >= hpalloc->page_size)
+    map_size += align;
+
+  huge = map_size >= hpalloc->huge_page_size;
+  if (huge) {
+    map_size = GST_ROUND_UP_N (map_size, hpalloc->huge_page_size);
+#ifdef MAP_HUGETLB
+    if (hpalloc->flags & GST_HUGE_PAGE_FLAG_EXPLICIT) {
+      base = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (base == MAP_FAILED)
+        GST_DEBUG ("hugetlb mapping of %" G_GSIZE_FORMAT " bytes failed: %s",
+            map_size, g_strerror (errno));
+    }
+#endif
+  } else {
+    map_size = GST_ROUND_UP_N (map_size, hpalloc->page_size);
+  }
+
+  if (base == MAP_FAILED) {
+    base = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+      goto mmap_failed;
+
+#ifdef MADV_HUGEPAGE
+    if (huge && madvise (base, map_size, MADV_HUGEPAGE) != 0)
+      GST_DEBUG ("madvise MADV_HUGEPAGE failed: %s", g_strerror (errno));
+#endif
+  }
+#ifdef HAVE_NUMA_SYSCALLS
+  if (hpalloc->flags & GST_HUGE_PAGE_FLAG_NUMA_LOCAL)
+    bind_to_local_node (base, map_size);
+#endif
+
+  mem = g_slice_new (GstHugePageMemory);
+  mem->base = base;
+  mem->map_size = map_size;
+  mem->data = base;
+
+  if ((aoffset = ((guintptr) mem->data & align)))
+    mem->data += (align + 1) - aoffset;
+
+  /* anonymous mappings are zero filled so the ZERO_PREFIXED and ZERO_PADDED
+   * flags are honoured for free */
+  gst_memory_init (GST_MEMORY_CAST (mem), params->flags, allocator, NULL,
+      maxsize, align, params->prefix, size);
+
+  GST_LOG ("%p: allocated %" G_GSIZE_FORMAT " bytes, mapping %"
+      G_GSIZE_FORMAT " at %p%s", mem, maxsize, map_size, base,
+      huge ? " (huge)" : "");
+
+  return GST_MEMORY_CAST (mem);
+
+  /* ERRORS */
+mmap_failed:
+  {
+    GST_WARNING ("mmap of %" G_GSIZE_FORMAT " bytes failed: %s", map_size,
+        g_strerror (errno));
+    return NULL;
+  }
+#else /* !HAVE_MMAP */
+  return NULL;
+#endif
+}
+
+static void
+gst_huge_page_allocator_free (GstAllocator * allocator, GstMemory * gmem)
+{
+  GstHugePageMemory *mem = (GstHugePageMemory *) gmem;
+
+#ifdef HAVE_MMAP
+  if (mem->base)
+    munmap (mem->base, mem->map_size);
+#endif
+  GST_LOG ("%p: freed", mem);
+  g_slice_free (GstHugePageMemory, mem);
+}
+
+static gpointer
+gst_huge_page_mem_map (GstMemory * gmem, gsize maxsize, GstMapFlags flags)
+{
+  GstHugePageMemory *mem = (GstHugePageMemory *) gmem;
+
+  return mem->data;
+}
+
+static void
+gst_huge_page_mem_unmap (GstMemory * gmem)
+{
+}
+
+static GstMemory *
+gst_huge_page_mem_share (GstMemory * gmem, gssize offset, gssize size)
+{
+  GstHugePageMemory *mem = (GstHugePageMemory *) gmem;
+  GstHugePageMemory *sub;
+  GstMemory *parent;
+
+  /* find the real parent */
+  if ((parent = gmem->parent) == NULL)
+    parent = gmem;
+
+  if (size == -1)
+    size = gmem->size - offset;
+
+  sub = g_slice_new (GstHugePageMemory);
+  sub->base = NULL;
+  sub->map_size = 0;
+  sub->data = mem->data;
+
+  /* the shared memory is always readonly */
+  gst_memory_init (GST_MEMORY_CAST (sub), GST_MINI_OBJECT_FLAGS (parent) |
+      GST_MINI_OBJECT_FLAG_LOCK_READONLY, gmem->allocator, parent,
+      gmem->maxsize, gmem->align, gmem->offset + offset, size);
+
+  return GST_MEMORY_CAST (sub);
+}
+
+static GstMemory *
+gst_huge_page_mem_copy (GstMemory * gmem, gssize offset, gssize size)
+{
+  GstHugePageMemory *mem = (GstHugePageMemory *) gmem;
+  GstAllocationParams params;
+  GstMemory *copy;
+  GstMapInfo info;
+
+  if (size == -1)
+    size = gmem->size > offset ? gmem->size - offset : 0;
+
+  gst_allocation_params_init (&params);
+  params.align = gmem->align;
+
+  copy = gst_allocator_alloc (gmem->allocator, size, &params);
+  if (copy == NULL)
+    return NULL;
+
+  if (!gst_memory_map (copy, &info, GST_MAP_WRITE)) {
+    gst_memory_unref (copy);
+    return NULL;
+  }
+  memcpy (info.data, mem->data + gmem->offset + offset, size);
+  gst_memory_unmap (copy, &info);
+
+  return copy;
+}
+
+G_DEFINE_TYPE (GstHugePageAllocator, gst_huge_page_allocator,
+    GST_TYPE_ALLOCATOR);
+
+static void
+gst_huge_page_allocator_class_init (GstHugePageAllocatorClass * klass)
+{
+  GstAllocatorClass *allocator_class;
+
+  allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = gst_huge_page_allocator_alloc;
+  allocator_class->free = gst_huge_page_allocator_free;
+
+  GST_DEBUG_CATEGORY_INIT (hugepage_debug, "hugepagememory", 0,
+      "huge page memory allocator");
+}
+
+static void
+gst_huge_page_allocator_init (GstHugePageAllocator * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  alloc->mem_type = GST_ALLOCATOR_HUGE_PAGE;
+
+  alloc->mem_map = gst_huge_page_mem_map;
+  alloc->mem_unmap = gst_huge_page_mem_unmap;
+  alloc->mem_share = gst_huge_page_mem_share;
+  alloc->mem_copy = gst_huge_page_mem_copy;
+
+#ifdef HAVE_MMAP
+  allocator->page_size = sysconf (_SC_PAGESIZE);
+#else
+  allocator->page_size = 4096;
+#endif
+  allocator->huge_page_size = get_huge_page_size ();
+}
+
+/**
+ * gst_huge_page_allocator_new:
+ * @flags: #GstHugePageFlags
+ *
+ * Return a new huge page allocator. Register it with gst_allocator_register()
+ * under the #GST_ALLOCATOR_HUGE_PAGE name to make video buffer pools use it.
+ *
+ * Returns: (transfer full): a new huge page allocator. Use
+ *    gst_object_unref() to release the allocator after usage
+ *
+ * Since: 1.8
+ */
+GstAllocator *
+gst_huge_page_allocator_new (GstHugePageFlags flags)
+{
+  GstHugePageAllocator *alloc;
+
+  alloc = g_object_new (GST_TYPE_HUGE_PAGE_ALLOCATOR, NULL);
+  alloc->flags = flags;
+
+  GST_DEBUG_OBJECT (alloc, "huge page size %" G_GSIZE_FORMAT ", flags 0x%x",
+      alloc->huge_page_size, flags);
+
+  return GST_ALLOCATOR_CAST (alloc);
+}
+
+/**
+ * gst_is_huge_page_memory:
+ * @mem: #GstMemory
+ *
+ * Check if @mem was allocated by a #GstHugePageAllocator.
+ *
+ * Returns: %TRUE when @mem is huge page memory.
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_is_huge_page_memory (GstMemory * mem)
+{
+  g_return_val_if_fail (mem != NULL, FALSE);
+
+  return GST_IS_HUGE_PAGE_ALLOCATOR (mem->allocator);
+}
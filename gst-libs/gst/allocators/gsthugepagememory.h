@@ -0,0 +1,104 @@
+/* GStreamer huge page backed memory
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_HUGE_PAGE_ALLOCATOR_H__
+#define __GST_HUGE_PAGE_ALLOCATOR_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstHugePageAllocator GstHugePageAllocator;
+typedef struct _GstHugePageAllocatorClass GstHugePageAllocatorClass;
+
+/**
+ * GST_ALLOCATOR_HUGE_PAGE:
+ *
+ * The memory type of #GstHugePageAllocator memory and the name under which
+ * the allocator should be registered with gst_allocator_register() so that
+ * video buffer pools configured with
+ * #GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES can find it.
+ *
+ * Since: 1.8
+ */
+#define GST_ALLOCATOR_HUGE_PAGE "hugepage"
+
+#define GST_TYPE_HUGE_PAGE_ALLOCATOR              (gst_huge_page_allocator_get_type())
+#define GST_IS_HUGE_PAGE_ALLOCATOR(obj)           (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_HUGE_PAGE_ALLOCATOR))
+#define GST_IS_HUGE_PAGE_ALLOCATOR_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE ((klass), GST_TYPE_HUGE_PAGE_ALLOCATOR))
+#define GST_HUGE_PAGE_ALLOCATOR_GET_CLASS(obj)    (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_HUGE_PAGE_ALLOCATOR, GstHugePageAllocatorClass))
+#define GST_HUGE_PAGE_ALLOCATOR(obj)              (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_HUGE_PAGE_ALLOCATOR, GstHugePageAllocator))
+#define GST_HUGE_PAGE_ALLOCATOR_CLASS(klass)      (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_HUGE_PAGE_ALLOCATOR, GstHugePageAllocatorClass))
+#define GST_HUGE_PAGE_ALLOCATOR_CAST(obj)         ((GstHugePageAllocator *)(obj))
+
+/**
+ * GstHugePageFlags:
+ * @GST_HUGE_PAGE_FLAG_NONE: back large allocations with transparent huge
+ *        pages when the kernel supports it.
+ * @GST_HUGE_PAGE_FLAG_EXPLICIT: try to allocate from the reserved hugetlb
+ *        pool first, falling back to transparent huge pages when the pool
+ *        is exhausted.
+ * @GST_HUGE_PAGE_FLAG_NUMA_LOCAL: prefer pages from the NUMA node of the
+ *        thread that allocates the memory.
+ *
+ * Flags to control the operation of the huge page allocator.
+ *
+ * Since: 1.8
+ */
+typedef enum {
+  GST_HUGE_PAGE_FLAG_NONE = 0,
+  GST_HUGE_PAGE_FLAG_EXPLICIT = (1 << 0),
+  GST_HUGE_PAGE_FLAG_NUMA_LOCAL = (1 << 1),
+} GstHugePageFlags;
+
+/**
+ * GstHugePageAllocator:
+ *
+ * Allocator for system memory backed by huge pages.
+ *
+ * Since: 1.8
+ */
+struct _GstHugePageAllocator
+{
+  GstAllocator parent;
+
+  /*< private >*/
+  GstHugePageFlags flags;
+  gsize huge_page_size;
+  gsize page_size;
+
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+struct _GstHugePageAllocatorClass
+{
+  GstAllocatorClass parent_class;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GType gst_huge_page_allocator_get_type (void);
+
+GstAllocator *  gst_huge_page_allocator_new     (GstHugePageFlags flags);
+
+gboolean        gst_is_huge_page_memory         (GstMemory *mem);
+
+G_END_DECLS
+
+#endif /* __GST_HUGE_PAGE_ALLOCATOR_H__ */
@@ -76,13 +76,20 @@ struct _GstAppSinkPrivate
 {
   GstCaps *caps;
   gboolean emit_signals;
-  guint num_buffers;
   guint max_buffers;
   gboolean drop;
 
+  /* The streaming thread pushes to the queue without taking the mutex as
+   * long as there is room, consumers pop from it with the mutex held. The
+   * mutex and cond are only needed to block, the waiter counts tell the
+   * other side whether a wakeup is needed at all. */
   GCond cond;
   GMutex mutex;
-  GQueue *queue;
+  GstAtomicQueue *queue;
+  gint num_buffers;             /* ATOMIC */
+  gint pull_waiters;            /* ATOMIC */
+  gint render_waiting;          /* ATOMIC */
+  gint check_caps;              /* ATOMIC */
   GstBuffer *preroll;
   GstCaps *preroll_caps;
   GstCaps *last_caps;
@@ -354,7 +361,7 @@ gst_app_sink_init (GstAppSink * appsink)
 
   g_mutex_init (&priv->mutex);
   g_cond_init (&priv->cond);
-  priv->queue = g_queue_new ();
+  priv->queue = gst_atomic_queue_new (32);
 
   priv->emit_signals = DEFAULT_PROP_EMIT_SIGNALS;
   priv->max_buffers = DEFAULT_PROP_MAX_BUFFERS;
@@ -382,7 +389,7 @@ gst_app_sink_dispose (GObject * obj)
   GST_OBJECT_UNLOCK (appsink);
 
   g_mutex_lock (&priv->mutex);
-  while ((queue_obj = g_queue_pop_head (priv->queue)))
+  while ((queue_obj = gst_atomic_queue_pop (priv->queue)))
     gst_mini_object_unref (queue_obj);
   gst_buffer_replace (&priv->preroll, NULL);
   gst_caps_replace (&priv->preroll_caps, NULL);
@@ -400,7 +407,7 @@ gst_app_sink_finalize (GObject * obj)
 
   g_mutex_clear (&priv->mutex);
   g_cond_clear (&priv->cond);
-  g_queue_free (priv->queue);
+  gst_atomic_queue_unref (priv->queue);
 
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -504,9 +511,11 @@ gst_app_sink_flush_unlocked (GstAppSink * appsink)
   GST_DEBUG_OBJECT (appsink, "flush stop appsink");
   priv->is_eos = FALSE;
   gst_buffer_replace (&priv->preroll, NULL);
-  while ((obj = g_queue_pop_head (priv->queue)))
+  while ((obj = gst_atomic_queue_pop (priv->queue)))
     gst_mini_object_unref (obj);
-  priv->num_buffers = 0;
+  g_atomic_int_set (&priv->num_buffers, 0);
+  /* the caps event might have been flushed */
+  g_atomic_int_set (&priv->check_caps, TRUE);
   g_cond_signal (&priv->cond);
 }
 
@@ -520,6 +529,7 @@ gst_app_sink_start (GstBaseSink * psink)
   GST_DEBUG_OBJECT (appsink, "starting");
   priv->flushing = FALSE;
   priv->started = TRUE;
+  g_atomic_int_set (&priv->check_caps, TRUE);
   gst_segment_init (&priv->preroll_segment, GST_FORMAT_TIME);
   gst_segment_init (&priv->last_segment, GST_FORMAT_TIME);
   g_mutex_unlock (&priv->mutex);
@@ -556,7 +566,7 @@ gst_app_sink_setcaps (GstBaseSink * sink, GstCaps * caps)
 
   g_mutex_lock (&priv->mutex);
   GST_DEBUG_OBJECT (appsink, "receiving CAPS");
-  g_queue_push_tail (priv->queue, gst_event_new_caps (caps));
+  gst_atomic_queue_push (priv->queue, gst_event_new_caps (caps));
   if (!priv->preroll)
     gst_caps_replace (&priv->preroll_caps, caps);
   g_mutex_unlock (&priv->mutex);
@@ -574,7 +584,7 @@ gst_app_sink_event (GstBaseSink * sink, GstEvent * event)
     case GST_EVENT_SEGMENT:
       g_mutex_lock (&priv->mutex);
       GST_DEBUG_OBJECT (appsink, "receiving SEGMENT");
-      g_queue_push_tail (priv->queue, gst_event_ref (event));
+      gst_atomic_queue_push (priv->queue, gst_event_ref (event));
       if (!priv->preroll)
         gst_event_copy_segment (event, &priv->preroll_segment);
       g_mutex_unlock (&priv->mutex);
@@ -593,8 +603,10 @@ gst_app_sink_event (GstBaseSink * sink, GstEvent * event)
        * Otherwise we might signal EOS before all buffers are
        * consumed, which is a bit confusing for the application
        */
-      while (priv->num_buffers > 0 && !priv->flushing)
+      g_atomic_int_set (&priv->render_waiting, TRUE);
+      while (g_atomic_int_get (&priv->num_buffers) > 0 && !priv->flushing)
         g_cond_wait (&priv->cond, &priv->mutex);
+      g_atomic_int_set (&priv->render_waiting, FALSE);
       if (priv->flushing)
         emit = FALSE;
       g_mutex_unlock (&priv->mutex);
@@ -673,12 +685,12 @@ dequeue_buffer (GstAppSink * appsink)
   do {
     GstMiniObject *obj;
 
-    obj = g_queue_pop_head (priv->queue);
+    obj = gst_atomic_queue_pop (priv->queue);
 
     if (GST_IS_BUFFER (obj)) {
       buffer = GST_BUFFER_CAST (obj);
       GST_DEBUG_OBJECT (appsink, "dequeued buffer %p", buffer);
-      priv->num_buffers--;
+      g_atomic_int_add (&priv->num_buffers, -1);
       break;
     } else if (GST_IS_EVENT (obj)) {
       GstEvent *event = GST_EVENT_CAST (obj);
@@ -715,25 +727,50 @@ gst_app_sink_render (GstBaseSink * psink, GstBuffer * buffer)
   GstAppSink *appsink = GST_APP_SINK_CAST (psink);
   GstAppSinkPrivate *priv = appsink->priv;
   gboolean emit;
+  guint max_buffers, num_buffers;
+
+  /* queue holding caps event might have been FLUSHed,
+   * but caps state still present in pad caps */
+  if (G_UNLIKELY (g_atomic_int_get (&priv->check_caps))) {
+    g_mutex_lock (&priv->mutex);
+    if (!priv->last_caps &&
+        gst_pad_has_current_caps (GST_BASE_SINK_PAD (psink))) {
+      priv->last_caps = gst_pad_get_current_caps (GST_BASE_SINK_PAD (psink));
+      GST_DEBUG_OBJECT (appsink, "activating pad caps %" GST_PTR_FORMAT,
+          priv->last_caps);
+    }
+    g_atomic_int_set (&priv->check_caps, FALSE);
+    g_mutex_unlock (&priv->mutex);
+  }
+
+  /* fast path, there is room in the queue: only take the lock when a
+   * consumer is blocked waiting for a sample */
+  max_buffers = priv->max_buffers;
+  num_buffers = g_atomic_int_get (&priv->num_buffers);
+  if (G_LIKELY (!g_atomic_int_get (&priv->flushing) && (max_buffers == 0
+              || num_buffers < max_buffers))) {
+    GST_LOG_OBJECT (appsink, "pushing render buffer %p on queue", buffer);
+    gst_atomic_queue_push (priv->queue, gst_buffer_ref (buffer));
+    g_atomic_int_inc (&priv->num_buffers);
+    if (g_atomic_int_get (&priv->pull_waiters) > 0) {
+      g_mutex_lock (&priv->mutex);
+      g_cond_signal (&priv->cond);
+      g_mutex_unlock (&priv->mutex);
+    }
+    emit = priv->emit_signals;
+    goto done;
+  }
 
 restart:
   g_mutex_lock (&priv->mutex);
   if (priv->flushing)
     goto flushing;
 
-  /* queue holding caps event might have been FLUSHed,
-   * but caps state still present in pad caps */
-  if (G_UNLIKELY (!priv->last_caps &&
-          gst_pad_has_current_caps (GST_BASE_SINK_PAD (psink)))) {
-    priv->last_caps = gst_pad_get_current_caps (GST_BASE_SINK_PAD (psink));
-    GST_DEBUG_OBJECT (appsink, "activating pad caps %" GST_PTR_FORMAT,
-        priv->last_caps);
-  }
-
   GST_DEBUG_OBJECT (appsink, "pushing render buffer %p on queue (%d)",
-      buffer, priv->num_buffers);
+      buffer, g_atomic_int_get (&priv->num_buffers));
 
-  while (priv->max_buffers > 0 && priv->num_buffers >= priv->max_buffers) {
+  while (priv->max_buffers > 0
+      && (guint) g_atomic_int_get (&priv->num_buffers) >= priv->max_buffers) {
     if (priv->drop) {
       GstBuffer *old;
 
@@ -744,7 +781,7 @@ restart:
       }
     } else {
       GST_DEBUG_OBJECT (appsink, "waiting for free space, length %d >= %d",
-          priv->num_buffers, priv->max_buffers);
+          g_atomic_int_get (&priv->num_buffers), priv->max_buffers);
 
       if (priv->unlock) {
         /* we are asked to unlock, call the wait_preroll method */
@@ -757,18 +794,21 @@ restart:
       }
 
       /* wait for a buffer to be removed or flush */
+      g_atomic_int_set (&priv->render_waiting, TRUE);
       g_cond_wait (&priv->cond, &priv->mutex);
+      g_atomic_int_set (&priv->render_waiting, FALSE);
       if (priv->flushing)
         goto flushing;
     }
   }
   /* we need to ref the buffer when pushing it in the queue */
-  g_queue_push_tail (priv->queue, gst_buffer_ref (buffer));
-  priv->num_buffers++;
+  gst_atomic_queue_push (priv->queue, gst_buffer_ref (buffer));
+  g_atomic_int_inc (&priv->num_buffers);
   g_cond_signal (&priv->cond);
   emit = priv->emit_signals;
   g_mutex_unlock (&priv->mutex);
 
+done:
   if (priv->callbacks.new_sample) {
     ret = priv->callbacks.new_sample (appsink, priv->user_data);
   } else {
@@ -923,7 +963,7 @@ gst_app_sink_is_eos (GstAppSink * appsink)
   if (!priv->started)
     goto not_started;
 
-  if (priv->is_eos && priv->num_buffers == 0) {
+  if (priv->is_eos && g_atomic_int_get (&priv->num_buffers) == 0) {
     GST_DEBUG_OBJECT (appsink, "we are EOS and the queue is empty");
     ret = TRUE;
   } else {
@@ -1194,13 +1234,58 @@ GstSample *
 gst_app_sink_pull_sample (GstAppSink * appsink)
 {
   GstSample *sample = NULL;
-  GstBuffer *buffer;
-  GstAppSinkPrivate *priv;
 
   g_return_val_if_fail (GST_IS_APP_SINK (appsink), NULL);
 
+  if (gst_app_sink_pull_samples (appsink, &sample, 1, GST_CLOCK_TIME_NONE) == 0)
+    return NULL;
+
+  return sample;
+}
+
+/**
+ * gst_app_sink_pull_samples:
+ * @appsink: a #GstAppSink
+ * @samples: (out caller-allocates) (array length=n_samples) (transfer full):
+ *     an array to store the pulled samples in
+ * @n_samples: the maximum number of samples to pull
+ * @timeout: the maximum amount of time to wait for a sample, or
+ *     #GST_CLOCK_TIME_NONE to wait until a sample is available
+ *
+ * Pulls up to @n_samples queued samples from @appsink in one go. This
+ * function blocks until at least one sample is available, EOS is reached,
+ * @timeout expires or the appsink element is set to the READY/NULL state.
+ * It then returns all samples that are queued, up to @n_samples, without
+ * waiting for more.
+ *
+ * This is more efficient than calling gst_app_sink_pull_sample() for each
+ * sample when many small buffers are rendered, as the queue is only locked
+ * and the streaming thread only woken up once per call.
+ *
+ * Each returned sample must be freed with gst_sample_unref().
+ *
+ * Returns: the number of samples stored in @samples, 0 when the appsink is
+ *     stopped, EOS or when @timeout expired.
+ *
+ * Since: 1.8
+ */
+guint
+gst_app_sink_pull_samples (GstAppSink * appsink, GstSample ** samples,
+    guint n_samples, GstClockTime timeout)
+{
+  GstAppSinkPrivate *priv;
+  GstBuffer *buffer;
+  gint64 end_time = 0;
+  guint n = 0;
+
+  g_return_val_if_fail (GST_IS_APP_SINK (appsink), 0);
+  g_return_val_if_fail (samples != NULL || n_samples == 0, 0);
+
   priv = appsink->priv;
 
+  if (GST_CLOCK_TIME_IS_VALID (timeout))
+    end_time = g_get_monotonic_time () + timeout / GST_USECOND;
+
   g_mutex_lock (&priv->mutex);
 
   while (TRUE) {
@@ -1208,38 +1293,67 @@ gst_app_sink_pull_sample (GstAppSink * appsink)
     if (!priv->started)
       goto not_started;
 
-    if (priv->num_buffers > 0)
+    if (g_atomic_int_get (&priv->num_buffers) > 0)
       break;
 
     if (priv->is_eos)
       goto eos;
 
-    /* nothing to return, wait */
+    /* nothing to return, wait. The streaming thread checks pull_waiters
+     * after queueing a buffer, so it can't be missed */
     GST_DEBUG_OBJECT (appsink, "waiting for a buffer");
-    g_cond_wait (&priv->cond, &priv->mutex);
+    g_atomic_int_inc (&priv->pull_waiters);
+    if (g_atomic_int_get (&priv->num_buffers) > 0) {
+      g_atomic_int_add (&priv->pull_waiters, -1);
+      break;
+    }
+    if (GST_CLOCK_TIME_IS_VALID (timeout)) {
+      if (!g_cond_wait_until (&priv->cond, &priv->mutex, end_time)) {
+        g_atomic_int_add (&priv->pull_waiters, -1);
+        if (g_atomic_int_get (&priv->num_buffers) > 0)
+          break;
+        goto timeout;
+      }
+    } else {
+      g_cond_wait (&priv->cond, &priv->mutex);
+    }
+    g_atomic_int_add (&priv->pull_waiters, -1);
   }
-  buffer = dequeue_buffer (appsink);
-  GST_DEBUG_OBJECT (appsink, "we have a buffer %p", buffer);
-  sample = gst_sample_new (buffer, priv->last_caps, &priv->last_segment, NULL);
-  gst_buffer_unref (buffer);
 
-  g_cond_signal (&priv->cond);
+  while (n < n_samples && g_atomic_int_get (&priv->num_buffers) > 0) {
+    buffer = dequeue_buffer (appsink);
+    GST_DEBUG_OBJECT (appsink, "we have a buffer %p", buffer);
+    samples[n++] =
+        gst_sample_new (buffer, priv->last_caps, &priv->last_segment, NULL);
+    gst_buffer_unref (buffer);
+  }
+
+  /* wake up the streaming thread if it waits for free space or for the
+   * queue to drain on EOS */
+  if (g_atomic_int_get (&priv->render_waiting))
+    g_cond_signal (&priv->cond);
   g_mutex_unlock (&priv->mutex);
 
-  return sample;
+  return n;
 
   /* special conditions */
 eos:
   {
-    GST_DEBUG_OBJECT (appsink, "we are EOS, return NULL");
+    GST_DEBUG_OBJECT (appsink, "we are EOS, return 0 samples");
     g_mutex_unlock (&priv->mutex);
-    return NULL;
+    return 0;
   }
 not_started:
   {
-    GST_DEBUG_OBJECT (appsink, "we are stopped, return NULL");
+    GST_DEBUG_OBJECT (appsink, "we are stopped, return 0 samples");
     g_mutex_unlock (&priv->mutex);
-    return NULL;
+    return 0;
+  }
+timeout:
+  {
+    GST_DEBUG_OBJECT (appsink, "timeout expired, return 0 samples");
+    g_mutex_unlock (&priv->mutex);
+    return 0;
   }
 }
 
@@ -117,6 +117,10 @@ gboolean        gst_app_sink_get_drop         (GstAppSink *appsink);
 
 GstSample *     gst_app_sink_pull_preroll     (GstAppSink *appsink);
 GstSample *     gst_app_sink_pull_sample      (GstAppSink *appsink);
+guint           gst_app_sink_pull_samples     (GstAppSink *appsink,
+                                               GstSample **samples,
+                                               guint n_samples,
+                                               GstClockTime timeout);
 
 void            gst_app_sink_set_callbacks    (GstAppSink * appsink,
                                                GstAppSinkCallbacks *callbacks,
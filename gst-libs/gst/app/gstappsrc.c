@@ -43,7 +43,8 @@
  * gst_app_src_push_buffer() method or by emitting the push-buffer action signal.
  * This will put the buffer onto a queue from which appsrc will read from in its
  * streaming thread. It is important to note that data transport will not happen
- * from the thread that performed the push-buffer call.
+ * from the thread that performed the push-buffer call. Many small buffers can
+ * be queued at once with gst_app_src_push_buffer_list().
  *
  * The "max-bytes" property controls how much data can be queued in appsrc
  * before appsrc considers the queue full. A filled internal queue will always
@@ -107,6 +108,11 @@ struct _GstAppSrcPrivate
   GMutex mutex;
   GQueue *queue;
 
+  /* buffer list taken from the queue, buffers from pending_idx on still need
+   * to be returned from create() */
+  GstBufferList *pending_list;
+  guint pending_idx;
+
   GstCaps *last_caps;
   GstCaps *current_caps;
 
@@ -148,6 +154,7 @@ enum
   SIGNAL_PUSH_BUFFER,
   SIGNAL_END_OF_STREAM,
   SIGNAL_PUSH_SAMPLE,
+  SIGNAL_PUSH_BUFFER_LIST,
 
   LAST_SIGNAL
 };
@@ -242,6 +249,8 @@ static GstFlowReturn gst_app_src_push_buffer_action (GstAppSrc * appsrc,
     GstBuffer * buffer);
 static GstFlowReturn gst_app_src_push_sample_action (GstAppSrc * appsrc,
     GstSample * sample);
+static GstFlowReturn gst_app_src_push_buffer_list_action (GstAppSrc * appsrc,
+    GstBufferList * buffer_list);
 
 static guint gst_app_src_signals[LAST_SIGNAL] = { 0 };
 
@@ -495,6 +504,27 @@ gst_app_src_class_init (GstAppSrcClass * klass)
           push_sample), NULL, NULL, __gst_app_marshal_ENUM__BOXED,
       GST_TYPE_FLOW_RETURN, 1, GST_TYPE_SAMPLE);
 
+  /**
+    * GstAppSrc::push-buffer-list:
+    * @appsrc: the appsrc
+    * @buffer_list: a buffer list to push
+    *
+    * Adds all buffers of @buffer_list to the queue of buffers that the
+    * appsrc element will push to its source pad, in one go. This function
+    * does not take ownership of the buffer list so the buffer list needs to
+    * be unreffed after calling this function.
+    *
+    * When the block property is TRUE, this function can block until free
+    * space becomes available in the queue.
+    *
+    * Since: 1.8
+    */
+  gst_app_src_signals[SIGNAL_PUSH_BUFFER_LIST] =
+      g_signal_new ("push-buffer-list", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION, G_STRUCT_OFFSET (GstAppSrcClass,
+          push_buffer_list), NULL, NULL, __gst_app_marshal_ENUM__BOXED,
+      GST_TYPE_FLOW_RETURN, 1, GST_TYPE_BUFFER_LIST);
+
 
    /**
     * GstAppSrc::end-of-stream:
@@ -531,6 +561,7 @@ gst_app_src_class_init (GstAppSrcClass * klass)
 
   klass->push_buffer = gst_app_src_push_buffer_action;
   klass->push_sample = gst_app_src_push_sample_action;
+  klass->push_buffer_list = gst_app_src_push_buffer_list_action;
   klass->end_of_stream = gst_app_src_end_of_stream;
 
   g_type_class_add_private (klass, sizeof (GstAppSrcPrivate));
@@ -583,9 +614,27 @@ gst_app_src_flush_queued (GstAppSrc * src, gboolean retain_last_caps)
     g_queue_push_tail (priv->queue, requeue_caps);
   }
 
+  if (priv->pending_list) {
+    gst_buffer_list_unref (priv->pending_list);
+    priv->pending_list = NULL;
+  }
+
   priv->queued_bytes = 0;
 }
 
+static guint64
+gst_app_src_buffer_list_get_size (GstBufferList * list)
+{
+  guint i, len;
+  guint64 size = 0;
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++)
+    size += gst_buffer_get_size (gst_buffer_list_get (list, i));
+
+  return size;
+}
+
 static void
 gst_app_src_dispose (GObject * obj)
 {
@@ -1114,12 +1163,51 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
   }
 
   while (TRUE) {
+    /* the rest of a buffer list was already accounted for when the list was
+     * taken from the queue */
+    if (priv->pending_list) {
+      *buf = gst_buffer_ref (gst_buffer_list_get (priv->pending_list,
+              priv->pending_idx));
+      GST_LOG_OBJECT (appsrc, "we have buffer %p from list, index %u", *buf,
+          priv->pending_idx);
+
+      if (++priv->pending_idx == gst_buffer_list_length (priv->pending_list)) {
+        gst_buffer_list_unref (priv->pending_list);
+        priv->pending_list = NULL;
+      }
+
+      if (priv->stream_type == GST_APP_STREAM_TYPE_RANDOM_ACCESS)
+        priv->offset += gst_buffer_get_size (*buf);
+
+      ret = GST_FLOW_OK;
+      break;
+    }
+
     /* return data as long as we have some */
     if (!g_queue_is_empty (priv->queue)) {
-      guint buf_size;
+      guint64 buf_size;
       GstMiniObject *obj = g_queue_pop_head (priv->queue);
 
-      if (!GST_IS_BUFFER (obj)) {
+      if (GST_IS_BUFFER_LIST (obj)) {
+        GstBufferList *list = GST_BUFFER_LIST_CAST (obj);
+
+        buf_size = gst_app_src_buffer_list_get_size (list);
+
+        GST_DEBUG_OBJECT (appsrc, "we have buffer list %p of size %"
+            G_GUINT64_FORMAT, list, buf_size);
+
+        /* return the first buffer now, the others from the next calls */
+        *buf = gst_buffer_ref (gst_buffer_list_get (list, 0));
+        if (gst_buffer_list_length (list) > 1) {
+          priv->pending_list = list;
+          priv->pending_idx = 1;
+        } else {
+          gst_buffer_list_unref (list);
+        }
+
+        if (priv->stream_type == GST_APP_STREAM_TYPE_RANDOM_ACCESS)
+          priv->offset += gst_buffer_get_size (*buf);
+      } else if (!GST_IS_BUFFER (obj)) {
         GstCaps *next_caps = GST_CAPS (obj);
         gboolean caps_changed = TRUE;
 
@@ -1146,19 +1234,20 @@ gst_app_src_create (GstBaseSrc * bsrc, guint64 offset, guint size,
 
         /* Continue checks caps and queue */
         continue;
-      }
+      } else {
+        *buf = GST_BUFFER (obj);
+        buf_size = gst_buffer_get_size (*buf);
 
-      *buf = GST_BUFFER (obj);
-      buf_size = gst_buffer_get_size (*buf);
+        GST_DEBUG_OBJECT (appsrc, "we have buffer %p of size %"
+            G_GUINT64_FORMAT, *buf, buf_size);
 
-      GST_DEBUG_OBJECT (appsrc, "we have buffer %p of size %u", *buf, buf_size);
+        /* only update the offset when in random_access mode */
+        if (priv->stream_type == GST_APP_STREAM_TYPE_RANDOM_ACCESS)
+          priv->offset += buf_size;
+      }
 
       priv->queued_bytes -= buf_size;
 
-      /* only update the offset when in random_access mode */
-      if (priv->stream_type == GST_APP_STREAM_TYPE_RANDOM_ACCESS)
-        priv->offset += buf_size;
-
       /* signal that we removed an item */
       g_cond_broadcast (&priv->cond);
 
@@ -1591,18 +1680,29 @@ gst_app_src_get_emit_signals (GstAppSrc * appsrc)
   return result;
 }
 
+/* queues either @buffer or @buflist, a buffer list is queued as one item and
+ * accounted for in one go */
 static GstFlowReturn
-gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
-    gboolean steal_ref)
+gst_app_src_push_internal (GstAppSrc * appsrc, GstBuffer * buffer,
+    GstBufferList * buflist, gboolean steal_ref)
 {
   gboolean first = TRUE;
   GstAppSrcPrivate *priv;
+  GstMiniObject *obj;
+  guint64 size;
 
   g_return_val_if_fail (GST_IS_APP_SRC (appsrc), GST_FLOW_ERROR);
-  g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
   priv = appsrc->priv;
 
+  if (buflist != NULL) {
+    obj = GST_MINI_OBJECT_CAST (buflist);
+    size = gst_app_src_buffer_list_get_size (buflist);
+  } else {
+    obj = GST_MINI_OBJECT_CAST (buffer);
+    size = gst_buffer_get_size (buffer);
+  }
+
   g_mutex_lock (&priv->mutex);
 
   while (TRUE) {
@@ -1651,11 +1751,11 @@ gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
       break;
   }
 
-  GST_DEBUG_OBJECT (appsrc, "queueing buffer %p", buffer);
+  GST_DEBUG_OBJECT (appsrc, "queueing %" GST_PTR_FORMAT, obj);
   if (!steal_ref)
-    gst_buffer_ref (buffer);
-  g_queue_push_tail (priv->queue, buffer);
-  priv->queued_bytes += gst_buffer_get_size (buffer);
+    gst_mini_object_ref (obj);
+  g_queue_push_tail (priv->queue, obj);
+  priv->queued_bytes += size;
   g_cond_broadcast (&priv->cond);
   g_mutex_unlock (&priv->mutex);
 
@@ -1664,22 +1764,32 @@ gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
   /* ERRORS */
 flushing:
   {
-    GST_DEBUG_OBJECT (appsrc, "refuse buffer %p, we are flushing", buffer);
+    GST_DEBUG_OBJECT (appsrc, "refuse %" GST_PTR_FORMAT ", we are flushing",
+        obj);
     if (steal_ref)
-      gst_buffer_unref (buffer);
+      gst_mini_object_unref (obj);
     g_mutex_unlock (&priv->mutex);
     return GST_FLOW_FLUSHING;
   }
 eos:
   {
-    GST_DEBUG_OBJECT (appsrc, "refuse buffer %p, we are EOS", buffer);
+    GST_DEBUG_OBJECT (appsrc, "refuse %" GST_PTR_FORMAT ", we are EOS", obj);
     if (steal_ref)
-      gst_buffer_unref (buffer);
+      gst_mini_object_unref (obj);
     g_mutex_unlock (&priv->mutex);
     return GST_FLOW_EOS;
   }
 }
 
+static GstFlowReturn
+gst_app_src_push_buffer_full (GstAppSrc * appsrc, GstBuffer * buffer,
+    gboolean steal_ref)
+{
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
+
+  return gst_app_src_push_internal (appsrc, buffer, NULL, steal_ref);
+}
+
 static GstFlowReturn
 gst_app_src_push_sample_internal (GstAppSrc * appsrc, GstSample * sample)
 {
@@ -1725,6 +1835,42 @@ gst_app_src_push_buffer (GstAppSrc * appsrc, GstBuffer * buffer)
   return gst_app_src_push_buffer_full (appsrc, buffer, TRUE);
 }
 
+/**
+ * gst_app_src_push_buffer_list:
+ * @appsrc: a #GstAppSrc
+ * @buffer_list: (transfer full): a #GstBufferList to push
+ *
+ * Adds all buffers of @buffer_list to the queue of buffers that the appsrc
+ * element will push to its source pad, in one go. This function takes
+ * ownership of @buffer_list.
+ *
+ * This is considerably cheaper than pushing the buffers one by one with
+ * gst_app_src_push_buffer() when many small buffers are pushed, as the
+ * queue is only locked, the streaming thread only woken up and the
+ * "max-bytes" limit only checked once per list.
+ *
+ * When the block property is TRUE, this function can block until free
+ * space becomes available in the queue.
+ *
+ * Returns: #GST_FLOW_OK when the buffer list was successfuly queued.
+ * #GST_FLOW_FLUSHING when @appsrc is not PAUSED or PLAYING.
+ * #GST_FLOW_EOS when EOS occured.
+ *
+ * Since: 1.8
+ */
+GstFlowReturn
+gst_app_src_push_buffer_list (GstAppSrc * appsrc, GstBufferList * buffer_list)
+{
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (buffer_list), GST_FLOW_ERROR);
+
+  if (gst_buffer_list_length (buffer_list) == 0) {
+    gst_buffer_list_unref (buffer_list);
+    return GST_FLOW_OK;
+  }
+
+  return gst_app_src_push_internal (appsrc, NULL, buffer_list, TRUE);
+}
+
 /**
  * gst_app_src_push_sample:
  * @appsrc: a #GstAppSrc
@@ -1768,6 +1914,20 @@ gst_app_src_push_sample_action (GstAppSrc * appsrc, GstSample * sample)
   return gst_app_src_push_sample_internal (appsrc, sample);
 }
 
+/* push a buffer list without stealing the ref of the list. This is used for
+ * the action signal. */
+static GstFlowReturn
+gst_app_src_push_buffer_list_action (GstAppSrc * appsrc,
+    GstBufferList * buffer_list)
+{
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (buffer_list), GST_FLOW_ERROR);
+
+  if (gst_buffer_list_length (buffer_list) == 0)
+    return GST_FLOW_OK;
+
+  return gst_app_src_push_internal (appsrc, NULL, buffer_list, FALSE);
+}
+
 /**
  * gst_app_src_end_of_stream:
  * @appsrc: a #GstAppSrc
@@ -110,9 +110,10 @@ struct _GstAppSrcClass
   GstFlowReturn (*push_buffer)     (GstAppSrc *appsrc, GstBuffer *buffer);
   GstFlowReturn (*end_of_stream)   (GstAppSrc *appsrc);
   GstFlowReturn (*push_sample)     (GstAppSrc *appsrc, GstSample *sample);
+  GstFlowReturn (*push_buffer_list) (GstAppSrc *appsrc, GstBufferList *buffer_list);
 
   /*< private >*/
-  gpointer     _gst_reserved[GST_PADDING-1];
+  gpointer     _gst_reserved[GST_PADDING-2];
 };
 
 GType gst_app_src_get_type(void);
@@ -142,6 +143,7 @@ void             gst_app_src_set_emit_signals        (GstAppSrc *appsrc, gboolea
 gboolean         gst_app_src_get_emit_signals        (GstAppSrc *appsrc);
 
 GstFlowReturn    gst_app_src_push_buffer             (GstAppSrc *appsrc, GstBuffer *buffer);
+GstFlowReturn    gst_app_src_push_buffer_list        (GstAppSrc *appsrc, GstBufferList *buffer_list);
 GstFlowReturn    gst_app_src_end_of_stream           (GstAppSrc *appsrc);
 GstFlowReturn    gst_app_src_push_sample             (GstAppSrc *appsrc, GstSample *sample);
 
@@ -145,6 +145,211 @@ check_valid_channel_positions (const GstAudioChannelPosition * position,
   return TRUE;
 }
 
+struct _GstAudioChannelReorder
+{
+  gint channels;
+  gint bps;
+  gboolean identity;
+  /* input channel that ends up in output channel i */
+  gint src[64];
+  void (*func) (const GstAudioChannelReorder * reorder, guint8 * data,
+      gsize frames);
+};
+
+/* kernels for the common sample widths, these move whole samples and keep a
+ * fixed-size frame copy so that the compiler can unroll and vectorize the
+ * inner loop */
+#define DEFINE_REORDER_FUNC(type, bits)                                 \
+static void                                                             \
+reorder_##bits (const GstAudioChannelReorder * reorder, guint8 * data,  \
+    gsize frames)                                                       \
+{                                                                       \
+  type *ptr = (type *) data;                                            \
+  type tmp[64];                                                         \
+  const gint *src = reorder->src;                                       \
+  gint channels = reorder->channels;                                    \
+  gsize i;                                                              \
+  gint j;                                                               \
+                                                                        \
+  for (i = 0; i < frames; i++) {                                        \
+    memcpy (tmp, ptr, channels * sizeof (type));                        \
+    for (j = 0; j < channels; j++)                                      \
+      ptr[j] = tmp[src[j]];                                             \
+    ptr += channels;                                                    \
+  }                                                                     \
+}
+
+DEFINE_REORDER_FUNC (guint8, 8);
+DEFINE_REORDER_FUNC (guint16, 16);
+DEFINE_REORDER_FUNC (guint32, 32);
+DEFINE_REORDER_FUNC (guint64, 64);
+
+#undef DEFINE_REORDER_FUNC
+
+/* any other width, like packed 24 bits */
+static void
+reorder_generic (const GstAudioChannelReorder * reorder, guint8 * data,
+    gsize frames)
+{
+  gint bps = reorder->bps;
+  gint bpf = bps * reorder->channels;
+  guint8 tmp[64 * 8];
+  gsize i;
+  gint j;
+
+  for (i = 0; i < frames; i++) {
+    memcpy (tmp, data, bpf);
+    for (j = 0; j < reorder->channels; j++)
+      memcpy (data + j * bps, tmp + reorder->src[j] * bps, bps);
+    data += bpf;
+  }
+}
+
+static gboolean
+gst_audio_channel_reorder_init (GstAudioChannelReorder * reorder,
+    const GstAudioFormatInfo * info, gint channels,
+    const GstAudioChannelPosition * from, const GstAudioChannelPosition * to)
+{
+  gint reorder_map[64] = { 0, };
+  gint i;
+
+  reorder->channels = channels;
+  reorder->bps = info->width / 8;
+  reorder->identity = memcmp (from, to, channels * sizeof (from[0])) == 0;
+  reorder->func = NULL;
+
+  if (reorder->identity)
+    return TRUE;
+
+  if (!gst_audio_get_channel_reorder_map (channels, from, to, reorder_map))
+    return FALSE;
+
+  /* invert the map so that every output sample is written exactly once */
+  for (i = 0; i < channels; i++)
+    reorder->src[reorder_map[i]] = i;
+
+  switch (info->width) {
+    case 8:
+      reorder->func = reorder_8;
+      break;
+    case 16:
+      reorder->func = reorder_16;
+      break;
+    case 32:
+      reorder->func = reorder_32;
+      break;
+    case 64:
+      reorder->func = reorder_64;
+      break;
+    default:
+      reorder->func = reorder_generic;
+      break;
+  }
+  return TRUE;
+}
+
+static void
+gst_audio_channel_reorder_apply (const GstAudioChannelReorder * reorder,
+    guint8 * data, gsize size)
+{
+  gsize frames;
+
+  if (reorder->identity || size == 0)
+    return;
+
+  frames = size / (reorder->bps * reorder->channels);
+
+  /* the typed kernels need naturally aligned samples */
+  if (G_UNLIKELY (((guintptr) data) % reorder->bps != 0))
+    reorder_generic (reorder, data, frames);
+  else
+    reorder->func (reorder, data, frames);
+}
+
+/**
+ * gst_audio_channel_reorder_new: (skip)
+ * @format: The %GstAudioFormat of the samples.
+ * @channels: The number of channels.
+ * @from: (array length=channels): The channel positions in the samples.
+ * @to: (array length=channels): The channel positions to convert to.
+ *
+ * Create a plan to reorder samples of @format from the channel positions
+ * @from to the channel positions @to. @from and @to must contain the same
+ * number of positions and the same positions, only in a different order.
+ *
+ * Creating the plan validates the positions and computes the reorder map
+ * once. Use it instead of gst_audio_reorder_channels() when the same
+ * reordering is applied to many buffers, typically once per negotiated caps.
+ *
+ * Returns: a new #GstAudioChannelReorder that should be freed with
+ * gst_audio_channel_reorder_free(), or %NULL if the reordering is not
+ * possible.
+ *
+ * Since: 1.8
+ */
+GstAudioChannelReorder *
+gst_audio_channel_reorder_new (GstAudioFormat format, gint channels,
+    const GstAudioChannelPosition * from, const GstAudioChannelPosition * to)
+{
+  const GstAudioFormatInfo *info;
+  GstAudioChannelReorder *reorder;
+
+  info = gst_audio_format_get_info (format);
+
+  g_return_val_if_fail (from != NULL, NULL);
+  g_return_val_if_fail (to != NULL, NULL);
+  g_return_val_if_fail (info != NULL && info->width > 0, NULL);
+  g_return_val_if_fail (info->width <= 8 * 64, NULL);
+  g_return_val_if_fail (channels > 0, NULL);
+  g_return_val_if_fail (channels <= 64, NULL);
+
+  reorder = g_slice_new (GstAudioChannelReorder);
+  if (!gst_audio_channel_reorder_init (reorder, info, channels, from, to)) {
+    g_slice_free (GstAudioChannelReorder, reorder);
+    return NULL;
+  }
+  return reorder;
+}
+
+/**
+ * gst_audio_channel_reorder_free:
+ * @reorder: a #GstAudioChannelReorder
+ *
+ * Free a reorder plan previously allocated with
+ * gst_audio_channel_reorder_new().
+ *
+ * Since: 1.8
+ */
+void
+gst_audio_channel_reorder_free (GstAudioChannelReorder * reorder)
+{
+  g_return_if_fail (reorder != NULL);
+
+  g_slice_free (GstAudioChannelReorder, reorder);
+}
+
+/**
+ * gst_audio_channel_reorder_samples:
+ * @reorder: a #GstAudioChannelReorder
+ * @data: (array length=size) (element-type guint8): The pointer to
+ *   the memory.
+ * @size: The size of the memory.
+ *
+ * Reorders the samples in @data in place according to @reorder.
+ *
+ * Since: 1.8
+ */
+void
+gst_audio_channel_reorder_samples (GstAudioChannelReorder * reorder,
+    gpointer data, gsize size)
+{
+  g_return_if_fail (reorder != NULL);
+  g_return_if_fail (data != NULL || size == 0);
+  g_return_if_fail (size % (reorder->bps * reorder->channels) == 0);
+
+  gst_audio_channel_reorder_apply (reorder, data, size);
+}
+
 /**
  * gst_audio_reorder_channels:
  * @data: (array length=size) (element-type guint8): The pointer to
@@ -159,6 +364,10 @@ check_valid_channel_positions (const GstAudioChannelPosition * position,
  * positions @to. @from and @to must contain the same number of
  * positions and the same positions, only in a different order.
  *
+ * When the same reordering is done repeatedly, a plan created with
+ * gst_audio_channel_reorder_new() avoids validating the positions and
+ * computing the reorder map on every call.
+ *
  * Returns: %TRUE if the reordering was possible.
  */
 gboolean
@@ -167,11 +376,7 @@ gst_audio_reorder_channels (gpointer data, gsize size, GstAudioFormat format,
     const GstAudioChannelPosition * to)
 {
   const GstAudioFormatInfo *info;
-  gint i, j, n;
-  gint reorder_map[64] = { 0, };
-  guint8 *ptr;
-  gint bpf, bps;
-  guint8 tmp[64 * 8];
+  GstAudioChannelReorder reorder;
 
   info = gst_audio_format_get_info (format);
 
@@ -188,25 +393,10 @@ gst_audio_reorder_channels (gpointer data, gsize size, GstAudioFormat format,
   if (size == 0)
     return TRUE;
 
-  if (memcmp (from, to, channels * sizeof (from[0])) == 0)
-    return TRUE;
-
-  if (!gst_audio_get_channel_reorder_map (channels, from, to, reorder_map))
+  if (!gst_audio_channel_reorder_init (&reorder, info, channels, from, to))
     return FALSE;
 
-  bps = info->width / 8;
-  bpf = bps * channels;
-  ptr = data;
-
-  n = size / bpf;
-  for (i = 0; i < n; i++) {
-
-    memcpy (tmp, ptr, bpf);
-    for (j = 0; j < channels; j++)
-      memcpy (ptr + reorder_map[j] * bps, tmp + j * bps, bps);
-
-    ptr += bpf;
-  }
+  gst_audio_channel_reorder_apply (&reorder, data, size);
 
   return TRUE;
 }
@@ -143,6 +143,26 @@ gboolean       gst_audio_reorder_channels        (gpointer data, gsize size,
                                                   const GstAudioChannelPosition * from,
                                                   const GstAudioChannelPosition * to);
 
+/**
+ * GstAudioChannelReorder:
+ *
+ * Opaque plan to reorder the channels of interleaved samples, created
+ * with gst_audio_channel_reorder_new().
+ *
+ * Since: 1.8
+ */
+typedef struct _GstAudioChannelReorder GstAudioChannelReorder;
+
+GstAudioChannelReorder * gst_audio_channel_reorder_new (GstAudioFormat format,
+                                                  gint channels,
+                                                  const GstAudioChannelPosition * from,
+                                                  const GstAudioChannelPosition * to);
+
+void           gst_audio_channel_reorder_free    (GstAudioChannelReorder * reorder);
+
+void           gst_audio_channel_reorder_samples (GstAudioChannelReorder * reorder,
+                                                  gpointer data, gsize size);
+
 gboolean       gst_audio_channel_positions_to_valid_order (GstAudioChannelPosition *position,
                                                            gint channels);
 
@@ -147,6 +147,40 @@ MAKE_ORC_PACK_UNPACK (s8)
 #define WRITE24_TO_BE(p,v) p[2] = v & 0xff; p[1] = (v >> 8) & 0xff; p[0] = (v >> 16) & 0xff
 #define READ24_FROM_LE(p) (p[0] | (p[1] << 8) | (p[2] << 16))
 #define READ24_FROM_BE(p) (p[2] | (p[1] << 8) | (p[0] << 16))
+/* read 4 packed 24-bit samples from 3 32-bit words */
+#define READ24_FROM_LEx4(p,v) G_STMT_START {                                 \
+  guint32 w0 = GST_READ_UINT32_LE (p);                                  \
+  guint32 w1 = GST_READ_UINT32_LE (p + 4);                              \
+  guint32 w2 = GST_READ_UINT32_LE (p + 8);                              \
+  v[0] = w0 & 0xffffff;                                                 \
+  v[1] = (w0 >> 24) | ((w1 & 0xffff) << 8);                             \
+  v[2] = (w1 >> 16) | ((w2 & 0xff) << 16);                              \
+  v[3] = w2 >> 8;                                                       \
+} G_STMT_END
+#define READ24_FROM_BEx4(p,v) G_STMT_START {                                 \
+  guint32 w0 = GST_READ_UINT32_BE (p);                                  \
+  guint32 w1 = GST_READ_UINT32_BE (p + 4);                              \
+  guint32 w2 = GST_READ_UINT32_BE (p + 8);                              \
+  v[0] = w0 >> 8;                                                       \
+  v[1] = ((w0 & 0xff) << 16) | (w1 >> 16);                              \
+  v[2] = ((w1 & 0xffff) << 8) | (w2 >> 24);                             \
+  v[3] = w2 & 0xffffff;                                                 \
+} G_STMT_END
+/* write 4 24-bit samples as 3 32-bit words */
+#define WRITE24_TO_LEx4(p,v) G_STMT_START {                                  \
+  GST_WRITE_UINT32_LE (p, v[0] | (v[1] << 24));                         \
+  GST_WRITE_UINT32_LE (p + 4, (v[1] >> 8) | (v[2] << 16));              \
+  GST_WRITE_UINT32_LE (p + 8, (v[2] >> 16) | (v[3] << 8));              \
+} G_STMT_END
+#define WRITE24_TO_BEx4(p,v) G_STMT_START {                                  \
+  GST_WRITE_UINT32_BE (p, (v[0] << 8) | (v[1] >> 16));                  \
+  GST_WRITE_UINT32_BE (p + 4, (v[1] << 16) | (v[2] >> 8));              \
+  GST_WRITE_UINT32_BE (p + 8, (v[2] << 24) | v[3]);                     \
+} G_STMT_END
+/* The packed 24-bit formats are not handled by ORC. The main loops work on
+ * blocks of 4 samples, which are exactly 3 32-bit words, so that we do
+ * word-sized loads and stores instead of 3 byte accesses per sample. The
+ * remaining samples are handled one by one. */
 #define MAKE_PACK_UNPACK(name, stride, sign, scale, READ_FUNC, WRITE_FUNC)     \
 static void unpack_ ##name (const GstAudioFormatInfo *info,             \
     GstAudioPackFlags flags, gpointer dest,                             \
@@ -154,6 +188,16 @@ static void unpack_ ##name (const GstAudioFormatInfo *info,             \
 {                                                                       \
   guint32 *d = dest;                                                    \
   guint8 *s = data;                                                     \
+  guint32 v[4];                                                         \
+  for (; length >= 4; length -= 4) {                                    \
+    READ_FUNC ##x4 (s, v);                                              \
+    d[0] = (((gint32) v[0]) << scale) ^ (sign);                         \
+    d[1] = (((gint32) v[1]) << scale) ^ (sign);                         \
+    d[2] = (((gint32) v[2]) << scale) ^ (sign);                         \
+    d[3] = (((gint32) v[3]) << scale) ^ (sign);                         \
+    d += 4;                                                             \
+    s += 4 * stride;                                                    \
+  }                                                                     \
   for (;length; length--) {                                             \
     *d++ = (((gint32) READ_FUNC (s)) << scale) ^ (sign);                \
     s += stride;                                                        \
@@ -166,6 +210,16 @@ static void pack_ ##name (const GstAudioFormatInfo *info,               \
   gint32 tmp;                                                           \
   guint32 *s = src;                                                     \
   guint8 *d = data;                                                     \
+  guint32 v[4];                                                         \
+  for (; length >= 4; length -= 4) {                                    \
+    v[0] = ((s[0] ^ (sign)) >> scale) & 0xffffff;                       \
+    v[1] = ((s[1] ^ (sign)) >> scale) & 0xffffff;                       \
+    v[2] = ((s[2] ^ (sign)) >> scale) & 0xffffff;                       \
+    v[3] = ((s[3] ^ (sign)) >> scale) & 0xffffff;                       \
+    WRITE_FUNC ##x4 (d, v);                                             \
+    s += 4;                                                             \
+    d += 4 * stride;                                                    \
+  }                                                                     \
   for (;length; length--) {                                             \
     tmp = (*s++ ^ (sign)) >> scale;                                     \
     WRITE_FUNC (d, tmp);                                                \
@@ -200,10 +254,29 @@ static void pack_ ##name (const GstAudioFormatInfo *info,               \
     MAKE_ORC_PACK_UNPACK (f32le)
 #define PACK_F32BE GST_AUDIO_FORMAT_F64, unpack_f32be, pack_f32be
     MAKE_ORC_PACK_UNPACK (f32be)
+/* native endian samples of the unpack format only need a copy */
+#define MAKE_COPY_PACK_UNPACK(fmt, width) \
+static void unpack_ ##fmt (const GstAudioFormatInfo *info, \
+    GstAudioPackFlags flags, gpointer dest,                \
+    const gpointer data, gint length) {                    \
+  if (dest != data)                                        \
+    memcpy (dest, data, length * ((width) / 8));           \
+}                                                          \
+static void pack_ ##fmt (const GstAudioFormatInfo *info,   \
+    GstAudioPackFlags flags, const gpointer src,           \
+    gpointer data, gint length) {                          \
+  if (data != src)                                         \
+    memcpy (data, src, length * ((width) / 8));            \
+}
 #define PACK_F64LE GST_AUDIO_FORMAT_F64, unpack_f64le, pack_f64le
-    MAKE_ORC_PACK_UNPACK (f64le)
 #define PACK_F64BE GST_AUDIO_FORMAT_F64, unpack_f64be, pack_f64be
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    MAKE_COPY_PACK_UNPACK (f64le, 64)
     MAKE_ORC_PACK_UNPACK (f64be)
+#else
+    MAKE_COPY_PACK_UNPACK (f64be, 64)
+    MAKE_ORC_PACK_UNPACK (f64le)
+#endif
 #define SINT (GST_AUDIO_FORMAT_FLAG_INTEGER | GST_AUDIO_FORMAT_FLAG_SIGNED)
 #define SINT_PACK (SINT | GST_AUDIO_FORMAT_FLAG_UNPACK)
 #define UINT (GST_AUDIO_FORMAT_FLAG_INTEGER)
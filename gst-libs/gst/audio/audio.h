@@ -69,6 +69,14 @@ G_BEGIN_DECLS
  * Since: 1.2
  */
 #define GST_META_TAG_AUDIO_CHANNELS_STR "channels"
+/**
+ * GST_META_TAG_AUDIO_RATE_STR:
+ *
+ * This metadata stays relevant as long as sample rate is unchanged.
+ *
+ * Since: 1.8
+ */
+#define GST_META_TAG_AUDIO_RATE_STR "rate"
 
 /*
  * this library defines and implements some helper functions for audio
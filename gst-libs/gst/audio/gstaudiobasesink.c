@@ -38,6 +38,15 @@
 GST_DEBUG_CATEGORY_STATIC (gst_audio_base_sink_debug);
 #define GST_CAT_DEFAULT gst_audio_base_sink_debug
 
+/* upper bounds of the render jitter histogram buckets, the last bucket
+ * collects everything above the last bound */
+static const GstClockTime jitter_bounds[] = {
+  50 * GST_USECOND, 100 * GST_USECOND, 250 * GST_USECOND, 500 * GST_USECOND,
+  1 * GST_MSECOND, 2 * GST_MSECOND, 5 * GST_MSECOND, 10 * GST_MSECOND
+};
+
+#define N_JITTER_BUCKETS (G_N_ELEMENTS (jitter_bounds) + 1)
+
 #define GST_AUDIO_BASE_SINK_GET_PRIVATE(obj)  \
    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_AUDIO_BASE_SINK, GstAudioBaseSinkPrivate))
 
@@ -74,6 +83,21 @@ struct _GstAudioBaseSinkPrivate
   GstAudioBaseSinkCustomSlavingCallback custom_slaving_callback;
   gpointer custom_slaving_cb_data;
   GDestroyNotify custom_slaving_cb_notify;
+
+  /* low-latency profile: small segments, no drift-based resyncs */
+  gboolean low_latency;
+
+  /* runtime statistics, protected by the object lock */
+  guint64 underruns;
+  gint64 underrun_seg;
+  guint64 renders;
+  GstClockTime delay;
+  GstClockTime min_delay;
+  GstClockTime max_delay;
+  gint64 last_delay_sample;
+  gint64 last_render_time;
+  GstClockTime last_render_duration;
+  guint64 jitter_hist[N_JITTER_BUCKETS];
 };
 
 /* BaseAudioSink signals and args */
@@ -104,6 +128,12 @@ enum
  * fix itself, or is a permanent offset */
 #define DEFAULT_DISCONT_WAIT        (1 * GST_SECOND)
 
+/* in the low-latency profile the buffer and latency times are capped to these
+ * values (in microseconds), giving a few sub-millisecond segments */
+#define DEFAULT_LOW_LATENCY           FALSE
+#define LOW_LATENCY_BUFFER_TIME       2000
+#define LOW_LATENCY_LATENCY_TIME      500
+
 enum
 {
   PROP_0,
@@ -116,6 +146,8 @@ enum
   PROP_ALIGNMENT_THRESHOLD,
   PROP_DRIFT_TOLERANCE,
   PROP_DISCONT_WAIT,
+  PROP_LOW_LATENCY,
+  PROP_STATS,
 
   PROP_LAST
 };
@@ -166,6 +198,9 @@ static gboolean gst_audio_base_sink_query (GstElement * element, GstQuery *
 
 static GstClock *gst_audio_base_sink_provide_clock (GstElement * elem);
 static inline void gst_audio_base_sink_reset_sync (GstAudioBaseSink * sink);
+static void gst_audio_base_sink_reset_stats (GstAudioBaseSink * sink);
+static GstStructure *gst_audio_base_sink_create_stats (GstAudioBaseSink *
+    sink);
 static GstClockTime gst_audio_base_sink_get_time (GstClock * clock,
     GstAudioBaseSink * sink);
 static void gst_audio_base_sink_callback (GstAudioRingBuffer * rbuf,
@@ -272,6 +307,81 @@ gst_audio_base_sink_class_init (GstAudioBaseSinkClass * klass)
           G_MAXUINT64 - 1, DEFAULT_DISCONT_WAIT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioBaseSink:low-latency:
+   *
+   * Use a low-latency profile. The buffer-time and latency-time are capped
+   * to a few sub-millisecond segments, the ringbuffer is put in lock-free
+   * mode and timestamp or clock drift no longer causes a resync in the
+   * middle of a stream. Only discontinuities flagged on the buffers make
+   * the sink resync. Takes effect the next time the caps are negotiated.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_LOW_LATENCY,
+      g_param_spec_boolean ("low-latency", "Low Latency",
+          "Use small segments and avoid resyncing on drift",
+          DEFAULT_LOW_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAudioBaseSink:stats:
+   *
+   * Various statistics about the playback. This property returns a
+   * #GstStructure named application/x-audio-base-sink-stats with the
+   * following fields:
+   *
+   * <itemizedlist>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;underruns&quot;</classname>:
+   *   number of ringbuffer segments that were played before they were
+   *   written.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;renders&quot;</classname>:
+   *   number of buffers rendered.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #guint64
+   *   <classname>&quot;delay&quot;</classname>,
+   *   <classname>&quot;min-delay&quot;</classname>,
+   *   <classname>&quot;max-delay&quot;</classname>:
+   *   last, minimum and maximum device delay in nanoseconds as reported by
+   *   gst_audio_ring_buffer_delay(). The delay is sampled while rendering,
+   *   at most every 100 milliseconds, and each time this property is read.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #GstValueArray of #guint64
+   *   <classname>&quot;jitter-bounds&quot;</classname>:
+   *   upper bounds in nanoseconds of the jitter histogram buckets.
+   *   </para>
+   * </listitem>
+   * <listitem>
+   *   <para>
+   *   #GstValueArray of #guint64
+   *   <classname>&quot;jitter-histogram&quot;</classname>:
+   *   number of render calls whose interval deviated from the duration of
+   *   the previous buffer by at most the matching bound. The extra last
+   *   bucket counts the larger deviations.
+   *   </para>
+   * </listitem>
+   * </itemizedlist>
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Various statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_audio_base_sink_change_state);
   gstelement_class->provide_clock =
@@ -314,6 +424,8 @@ gst_audio_base_sink_init (GstAudioBaseSink * audiobasesink)
   audiobasesink->priv->custom_slaving_callback = NULL;
   audiobasesink->priv->custom_slaving_cb_data = NULL;
   audiobasesink->priv->custom_slaving_cb_notify = NULL;
+  audiobasesink->priv->low_latency = DEFAULT_LOW_LATENCY;
+  gst_audio_base_sink_reset_stats (audiobasesink);
 
   audiobasesink->provided_clock = gst_audio_clock_new ("GstAudioSinkClock",
       (GstAudioClockGetTimeFunc) gst_audio_base_sink_get_time, audiobasesink,
@@ -879,6 +991,14 @@ gst_audio_base_sink_set_property (GObject * object, guint prop_id,
     case PROP_DISCONT_WAIT:
       gst_audio_base_sink_set_discont_wait (sink, g_value_get_uint64 (value));
       break;
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (sink);
+      sink->priv->low_latency = g_value_get_boolean (value);
+      if (sink->ringbuffer)
+        gst_audio_ring_buffer_set_lock_free (sink->ringbuffer,
+            sink->priv->low_latency);
+      GST_OBJECT_UNLOCK (sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -919,6 +1039,14 @@ gst_audio_base_sink_get_property (GObject * object, guint prop_id,
     case PROP_DISCONT_WAIT:
       g_value_set_uint64 (value, gst_audio_base_sink_get_discont_wait (sink));
       break;
+    case PROP_LOW_LATENCY:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_boolean (value, sink->priv->low_latency);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_audio_base_sink_create_stats (sink));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -965,6 +1093,13 @@ gst_audio_base_sink_setcaps (GstBaseSink * bsink, GstCaps * caps)
   spec->buffer_time = sink->buffer_time;
   spec->latency_time = sink->latency_time;
 
+  GST_OBJECT_LOCK (sink);
+  if (sink->priv->low_latency) {
+    spec->buffer_time = MIN (spec->buffer_time, LOW_LATENCY_BUFFER_TIME);
+    spec->latency_time = MIN (spec->latency_time, LOW_LATENCY_LATENCY_TIME);
+  }
+  GST_OBJECT_UNLOCK (sink);
+
   /* parse new caps */
   if (!gst_audio_ring_buffer_parse_caps (spec, caps))
     goto parse_error;
@@ -1063,6 +1198,177 @@ gst_audio_base_sink_reset_sync (GstAudioBaseSink * sink)
   sink->priv->discont_time = -1;
   sink->priv->avg_skew = -1;
   sink->priv->last_align = 0;
+  sink->priv->underrun_seg = 0;
+  sink->priv->last_render_time = -1;
+}
+
+static void
+gst_audio_base_sink_reset_stats (GstAudioBaseSink * sink)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+
+  priv->underruns = 0;
+  priv->underrun_seg = 0;
+  priv->renders = 0;
+  priv->delay = GST_CLOCK_TIME_NONE;
+  priv->min_delay = GST_CLOCK_TIME_NONE;
+  priv->max_delay = GST_CLOCK_TIME_NONE;
+  priv->last_delay_sample = -1;
+  priv->last_render_time = -1;
+  priv->last_render_duration = GST_CLOCK_TIME_NONE;
+  memset (priv->jitter_hist, 0, sizeof (priv->jitter_hist));
+}
+
+static void
+append_uint64 (GValue * array, guint64 val)
+{
+  GValue v = G_VALUE_INIT;
+
+  g_value_init (&v, G_TYPE_UINT64);
+  g_value_set_uint64 (&v, val);
+  gst_value_array_append_and_take_value (array, &v);
+}
+
+/* minimum interval between two delay queries while rendering, in
+ * microseconds */
+#define DELAY_SAMPLE_INTERVAL (100 * 1000)
+
+/* query the device delay. While rendering, this is rate limited so that
+ * the device isn't queried for every buffer */
+static void
+gst_audio_base_sink_sample_delay (GstAudioBaseSink * sink, gboolean force)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+  GstAudioRingBuffer *ringbuf;
+  GstClockTime delay;
+  gint64 now;
+  gint rate;
+
+  now = g_get_monotonic_time ();
+
+  GST_OBJECT_LOCK (sink);
+  if (!force && priv->last_delay_sample != -1
+      && now - priv->last_delay_sample < DELAY_SAMPLE_INTERVAL) {
+    GST_OBJECT_UNLOCK (sink);
+    return;
+  }
+  priv->last_delay_sample = now;
+  ringbuf = sink->ringbuffer ? gst_object_ref (sink->ringbuffer) : NULL;
+  GST_OBJECT_UNLOCK (sink);
+
+  if (ringbuf == NULL)
+    return;
+
+  rate = GST_AUDIO_INFO_RATE (&ringbuf->spec.info);
+  if (!gst_audio_ring_buffer_is_acquired (ringbuf) || rate <= 0) {
+    gst_object_unref (ringbuf);
+    return;
+  }
+
+  delay = gst_util_uint64_scale_int (gst_audio_ring_buffer_delay (ringbuf),
+      GST_SECOND, rate);
+  gst_object_unref (ringbuf);
+
+  GST_OBJECT_LOCK (sink);
+  priv->delay = delay;
+  if (!GST_CLOCK_TIME_IS_VALID (priv->min_delay) || delay < priv->min_delay)
+    priv->min_delay = delay;
+  if (!GST_CLOCK_TIME_IS_VALID (priv->max_delay) || delay > priv->max_delay)
+    priv->max_delay = delay;
+  GST_OBJECT_UNLOCK (sink);
+}
+
+static GstStructure *
+gst_audio_base_sink_create_stats (GstAudioBaseSink * sink)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+  GstStructure *s;
+  GValue bounds = G_VALUE_INIT;
+  GValue hist = G_VALUE_INIT;
+  guint i;
+
+  gst_audio_base_sink_sample_delay (sink, TRUE);
+
+  g_value_init (&bounds, GST_TYPE_ARRAY);
+  g_value_init (&hist, GST_TYPE_ARRAY);
+  for (i = 0; i < G_N_ELEMENTS (jitter_bounds); i++)
+    append_uint64 (&bounds, jitter_bounds[i]);
+
+  GST_OBJECT_LOCK (sink);
+  for (i = 0; i < N_JITTER_BUCKETS; i++)
+    append_uint64 (&hist, priv->jitter_hist[i]);
+
+  s = gst_structure_new ("application/x-audio-base-sink-stats",
+      "underruns", G_TYPE_UINT64, priv->underruns,
+      "renders", G_TYPE_UINT64, priv->renders,
+      "delay", G_TYPE_UINT64, priv->delay,
+      "min-delay", G_TYPE_UINT64, priv->min_delay,
+      "max-delay", G_TYPE_UINT64, priv->max_delay, NULL);
+  GST_OBJECT_UNLOCK (sink);
+
+  gst_structure_take_value (s, "jitter-bounds", &bounds);
+  gst_structure_take_value (s, "jitter-histogram", &hist);
+
+  return s;
+}
+
+/* account the interval between two render calls against the duration of the
+ * previous buffer */
+static void
+gst_audio_base_sink_update_jitter (GstAudioBaseSink * sink,
+    GstClockTime duration)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+  gint64 now;
+
+  now = g_get_monotonic_time ();
+
+  GST_OBJECT_LOCK (sink);
+  if (priv->last_render_time != -1
+      && GST_CLOCK_TIME_IS_VALID (priv->last_render_duration)) {
+    GstClockTime interval, jitter;
+    guint i;
+
+    interval = (now - priv->last_render_time) * GST_USECOND;
+    if (interval > priv->last_render_duration)
+      jitter = interval - priv->last_render_duration;
+    else
+      jitter = priv->last_render_duration - interval;
+
+    for (i = 0; i < G_N_ELEMENTS (jitter_bounds); i++)
+      if (jitter <= jitter_bounds[i])
+        break;
+    priv->jitter_hist[i]++;
+  }
+  priv->last_render_time = now;
+  priv->last_render_duration = duration;
+  priv->renders++;
+  GST_OBJECT_UNLOCK (sink);
+}
+
+/* count the segments the device played before we could write them */
+static void
+gst_audio_base_sink_update_underruns (GstAudioBaseSink * sink,
+    guint64 sample_offset)
+{
+  GstAudioBaseSinkPrivate *priv = sink->priv;
+  GstAudioRingBuffer *ringbuf = sink->ringbuffer;
+  gint64 segdone, seg;
+
+  GST_OBJECT_LOCK (sink);
+  if (g_atomic_int_get (&ringbuf->state) == GST_AUDIO_RING_BUFFER_STATE_STARTED
+      && ringbuf->samples_per_seg > 0) {
+    segdone = g_atomic_int_get (&ringbuf->segdone) - ringbuf->segbase;
+    seg = MAX ((gint64) (sample_offset / ringbuf->samples_per_seg),
+        priv->underrun_seg);
+    if (seg < segdone) {
+      GST_DEBUG_OBJECT (sink, "underrun of %" G_GINT64_FORMAT " segments",
+          segdone - seg);
+      priv->underruns += segdone - seg;
+      priv->underrun_seg = segdone;
+    }
+  }
+  GST_OBJECT_UNLOCK (sink);
 }
 
 static void
@@ -1327,7 +1633,8 @@ gst_audio_base_sink_custom_slaving (GstAudioBaseSink * sink,
 
     /* if we were aligning in the wrong direction or we aligned more than what we
      * will correct, resync */
-    if ((last_align < 0) || (last_align > driftsamples))
+    if (((last_align < 0) || (last_align > driftsamples))
+        && !sink->priv->low_latency)
       sink->next_sample = -1;
 
     GST_DEBUG_OBJECT (sink,
@@ -1345,7 +1652,8 @@ gst_audio_base_sink_custom_slaving (GstAudioBaseSink * sink,
 
     /* if we were aligning in the wrong direction or we aligned more than what we
      * will correct, resync */
-    if ((last_align > 0) || (-last_align > driftsamples))
+    if (((last_align > 0) || (-last_align > driftsamples))
+        && !sink->priv->low_latency)
       sink->next_sample = -1;
 
     GST_DEBUG_OBJECT (sink,
@@ -1492,7 +1800,8 @@ gst_audio_base_sink_skew_slaving (GstAudioBaseSink * sink,
 
     /* if we were aligning in the wrong direction or we aligned more than what
      * we will correct, resync */
-    if (last_align < 0 || last_align > driftsamples)
+    if ((last_align < 0 || last_align > driftsamples)
+        && !sink->priv->low_latency)
       sink->next_sample = -1;
 
     GST_DEBUG_OBJECT (sink,
@@ -1520,7 +1829,8 @@ gst_audio_base_sink_skew_slaving (GstAudioBaseSink * sink,
 
     /* if we were aligning in the wrong direction or we aligned more than what
      * we will correct, resync */
-    if (last_align > 0 || -last_align > driftsamples)
+    if ((last_align > 0 || -last_align > driftsamples)
+        && !sink->priv->low_latency)
       sink->next_sample = -1;
 
     GST_DEBUG_OBJECT (sink,
@@ -1764,7 +2074,11 @@ gst_audio_base_sink_get_alignment (GstAudioBaseSink * sink,
   if (sample_diff > headroom && align < 0)
     allow_align = FALSE;
 
-  if (G_UNLIKELY (sample_diff >= max_sample_diff)) {
+  if (G_UNLIKELY (sample_diff >= max_sample_diff && sink->priv->low_latency)) {
+    /* in the low-latency profile we keep on aligning mid-stream, only flagged
+     * discontinuities make us resync */
+    GST_DEBUG_OBJECT (sink, "low-latency, not resyncing on drift");
+  } else if (G_UNLIKELY (sample_diff >= max_sample_diff)) {
     /* wait before deciding to make a discontinuity */
     if (sink->priv->discont_wait > 0) {
       GstClockTime time = gst_util_uint64_scale_int (sample_offset,
@@ -1881,6 +2195,9 @@ gst_audio_base_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   samples = size / bpf;
   out_samples = samples;
 
+  gst_audio_base_sink_update_jitter (sink,
+      gst_util_uint64_scale_int (samples, GST_SECOND, rate));
+
   time = GST_BUFFER_TIMESTAMP (buf);
 
   /* Last ditch attempt to ensure that we only play silence if
@@ -2150,6 +2467,9 @@ no_align:
   GST_DEBUG_OBJECT (sink, "rendering at %" G_GUINT64_FORMAT " %d/%d",
       sample_offset, samples, out_samples);
 
+  gst_audio_base_sink_update_underruns (sink, sample_offset);
+  gst_audio_base_sink_sample_delay (sink, FALSE);
+
   /* we need to accumulate over different runs for when we get interrupted */
   accum = 0;
   align_next = TRUE;
@@ -2421,6 +2741,9 @@ gst_audio_base_sink_change_state (GstElement * element,
 
       GST_OBJECT_LOCK (sink);
       sink->ringbuffer = rb;
+      if (sink->priv->low_latency)
+        gst_audio_ring_buffer_set_lock_free (rb, TRUE);
+      gst_audio_base_sink_reset_stats (sink);
       GST_OBJECT_UNLOCK (sink);
 
       if (!gst_audio_ring_buffer_open_device (sink->ringbuffer)) {
@@ -2472,6 +2795,8 @@ gst_audio_base_sink_change_state (GstElement * element,
 
       GST_OBJECT_LOCK (sink);
       sink->priv->sync_latency = FALSE;
+      /* don't count the pause as render jitter */
+      sink->priv->last_render_time = -1;
       GST_OBJECT_UNLOCK (sink);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
@@ -116,7 +116,8 @@
  *
  * In non-live pipelines, baseclass can also (configurably) arrange for
  * output buffer aggregation which may help to redue large(r) numbers of
- * small(er) buffers being pushed and processed downstream.
+ * small(er) buffers being pushed and processed downstream.  The aggregated
+ * buffers reference the memory of the decoded frames rather than copying it.
  *
  * On the other hand, it should be noted that baseclass only provides limited
  * seeking support (upon explicit subclass request), as full-fledged support
@@ -209,6 +210,9 @@ typedef struct _GstAudioDecoderContext
 
   GstAllocator *allocator;
   GstAllocationParams params;
+  /* downstream pool to allocate output buffers from, if any */
+  GstBufferPool *pool;
+  guint pool_size;
 } GstAudioDecoderContext;
 
 struct _GstAudioDecoderPrivate
@@ -587,6 +591,10 @@ gst_audio_decoder_reset (GstAudioDecoder * dec, gboolean full)
 
     if (dec->priv->ctx.allocator)
       gst_object_unref (dec->priv->ctx.allocator);
+    if (dec->priv->ctx.pool) {
+      gst_buffer_pool_set_active (dec->priv->ctx.pool, FALSE);
+      gst_object_unref (dec->priv->ctx.pool);
+    }
 
     gst_caps_replace (&dec->priv->ctx.input_caps, NULL);
 
@@ -696,6 +704,8 @@ gst_audio_decoder_negotiate_default (GstAudioDecoder * dec)
   GstQuery *query = NULL;
   GstAllocator *allocator;
   GstAllocationParams params;
+  GstBufferPool *pool = NULL;
+  guint size = 0;
 
   g_return_val_if_fail (GST_IS_AUDIO_DECODER (dec), FALSE);
   g_return_val_if_fail (GST_AUDIO_INFO_IS_VALID (&dec->priv->ctx.info), FALSE);
@@ -742,6 +752,14 @@ gst_audio_decoder_negotiate_default (GstAudioDecoder * dec)
     GST_DEBUG_OBJECT (dec, "didn't get downstream ALLOCATION hints");
   }
 
+  /* the previous pool might be offered again, it can only be reconfigured
+   * when inactive */
+  if (dec->priv->ctx.pool) {
+    gst_buffer_pool_set_active (dec->priv->ctx.pool, FALSE);
+    gst_object_unref (dec->priv->ctx.pool);
+    dec->priv->ctx.pool = NULL;
+  }
+
   g_assert (klass->decide_allocation != NULL);
   res = klass->decide_allocation (dec, query);
 
@@ -765,6 +783,22 @@ gst_audio_decoder_negotiate_default (GstAudioDecoder * dec)
   dec->priv->ctx.allocator = allocator;
   dec->priv->ctx.params = params;
 
+  /* output directly into the downstream pool when one was configured */
+  if (gst_query_get_n_allocation_pools (query) > 0)
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, NULL, NULL);
+
+  if (pool && size > 0 && !gst_buffer_pool_set_active (pool, TRUE)) {
+    GST_WARNING_OBJECT (dec, "failed to activate downstream pool");
+    gst_object_unref (pool);
+    pool = NULL;
+  }
+  if (pool && size == 0) {
+    gst_object_unref (pool);
+    pool = NULL;
+  }
+  dec->priv->ctx.pool = pool;
+  dec->priv->ctx.pool_size = size;
+
 done:
 
   if (query)
@@ -1101,7 +1135,9 @@ again:
     if (av && assemble) {
       GST_LOG_OBJECT (dec, "assembling fragment");
       inbuf = buf;
-      buf = gst_adapter_take_buffer (priv->adapter_out, av);
+      /* aggregate by appending the memory of the decoded frames rather
+       * than copying them into one new chunk */
+      buf = gst_adapter_take_buffer_fast (priv->adapter_out, av);
       GST_BUFFER_TIMESTAMP (buf) = priv->out_ts;
       GST_BUFFER_DURATION (buf) = priv->out_dur;
       priv->out_ts = GST_CLOCK_TIME_NONE;
@@ -2561,6 +2597,8 @@ gst_audio_decoder_decide_allocation_default (GstAudioDecoder * dec,
   GstAllocator *allocator = NULL;
   GstAllocationParams params;
   gboolean update_allocator;
+  GstBufferPool *pool = NULL;
+  guint size, min, max;
 
   /* we got configuration from our peer or the decide_allocation method,
    * parse them */
@@ -2578,6 +2616,33 @@ gst_audio_decoder_decide_allocation_default (GstAudioDecoder * dec,
     gst_query_set_nth_allocation_param (query, 0, allocator, &params);
   else
     gst_query_add_allocation_param (query, allocator, &params);
+
+  /* use a pool offered by downstream so that decoded data can be written
+   * into downstream memory directly, we never create one ourselves */
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+
+    if (pool && size > 0) {
+      GstStructure *config;
+      GstCaps *caps;
+
+      gst_query_parse_allocation (query, &caps, NULL);
+
+      config = gst_buffer_pool_get_config (pool);
+      gst_buffer_pool_config_set_params (config, caps, size, min, max);
+      gst_buffer_pool_config_set_allocator (config, allocator, &params);
+      if (!gst_buffer_pool_set_config (pool, config)) {
+        GST_DEBUG_OBJECT (dec, "downstream pool rejected config, not using it");
+        gst_object_unref (pool);
+        pool = NULL;
+        size = min = max = 0;
+      }
+    }
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+    if (pool)
+      gst_object_unref (pool);
+  }
+
   if (allocator)
     gst_object_unref (allocator);
 
@@ -3608,7 +3673,10 @@ gst_audio_decoder_merge_tags (GstAudioDecoder * dec,
  * @size: size of the buffer
  *
  * Helper function that allocates a buffer to hold an audio frame
- * for @dec's current output format.
+ * for @dec's current output format. When downstream provided a buffer pool
+ * and @size fits into its buffers, the buffer is taken from that pool when
+ * one is available so that the subclass decodes directly into downstream
+ * memory. Such a buffer is resized to @size.
  *
  * Returns: (transfer full): allocated buffer
  */
@@ -3635,6 +3703,28 @@ gst_audio_decoder_allocate_output_buffer (GstAudioDecoder * dec, gsize size)
     }
   }
 
+  /* decode straight into downstream memory when the frame fits into the
+   * pool buffers. Only the size of the memory changes, which the pool
+   * resets to the full size when the buffer is released.
+   * Never wait for a free buffer, we hold the stream lock and aggregated
+   * output in adapter_out may keep pool buffers queued under it */
+  if (dec->priv->ctx.pool && size <= dec->priv->ctx.pool_size) {
+    GstBufferPoolAcquireParams params = { 0, };
+    GstFlowReturn ret;
+
+    params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+    ret = gst_buffer_pool_acquire_buffer (dec->priv->ctx.pool, &buffer,
+        &params);
+    if (ret == GST_FLOW_OK) {
+      if (size < dec->priv->ctx.pool_size)
+        gst_buffer_resize (buffer, 0, size);
+      GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
+      return buffer;
+    }
+    GST_DEBUG_OBJECT (dec, "no buffer from pool: %s", gst_flow_get_name (ret));
+    buffer = NULL;
+  }
+
   buffer =
       gst_buffer_new_allocate (dec->priv->ctx.allocator, size,
       &dec->priv->ctx.params);
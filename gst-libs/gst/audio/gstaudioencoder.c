@@ -183,6 +183,7 @@ enum
 #define DEFAULT_TOLERANCE    40000000
 #define DEFAULT_HARD_MIN     FALSE
 #define DEFAULT_DRAINABLE    TRUE
+#define DEFAULT_ZERO_COPY_INPUT FALSE
 
 typedef struct _GstAudioEncoderContext
 {
@@ -257,6 +258,7 @@ struct _GstAudioEncoderPrivate
   gboolean granule;
   gboolean hard_min;
   gboolean drainable;
+  gboolean zero_copy_input;
 
   /* upstream stream tags (global tags are passed through as-is) */
   GstTagList *upstream_tags;
@@ -461,6 +463,7 @@ gst_audio_encoder_init (GstAudioEncoder * enc, GstAudioEncoderClass * bclass)
   enc->priv->tolerance = DEFAULT_TOLERANCE;
   enc->priv->hard_min = DEFAULT_HARD_MIN;
   enc->priv->drainable = DEFAULT_DRAINABLE;
+  enc->priv->zero_copy_input = DEFAULT_ZERO_COPY_INPUT;
 
   /* init state */
   enc->priv->ctx.min_latency = 0;
@@ -1048,6 +1051,7 @@ gst_audio_encoder_push_buffers (GstAudioEncoder * enc, gboolean force)
   GstAudioEncoderContext *ctx;
   gint av, need;
   GstBuffer *buf;
+  gboolean zero_copy;
   GstFlowReturn ret = GST_FLOW_OK;
 
   klass = GST_AUDIO_ENCODER_GET_CLASS (enc);
@@ -1057,6 +1061,10 @@ gst_audio_encoder_push_buffers (GstAudioEncoder * enc, gboolean force)
   priv = enc->priv;
   ctx = &enc->priv->ctx;
 
+  GST_OBJECT_LOCK (enc);
+  zero_copy = priv->zero_copy_input;
+  GST_OBJECT_UNLOCK (enc);
+
   while (ret == GST_FLOW_OK) {
 
     buf = NULL;
@@ -1098,7 +1106,16 @@ gst_audio_encoder_push_buffers (GstAudioEncoder * enc, gboolean force)
     }
 
     priv->got_data = FALSE;
-    if (G_LIKELY (need)) {
+    if (G_LIKELY (need) && zero_copy) {
+      GstBuffer *head;
+
+      /* share the memory of the queued input buffers, which may leave
+       * the subclass with a buffer made up of several memory blocks */
+      head = gst_adapter_get_buffer_fast (priv->adapter, priv->offset + need);
+      buf = gst_buffer_copy_region (head, GST_BUFFER_COPY_MEMORY,
+          priv->offset, need);
+      gst_buffer_unref (head);
+    } else if (G_LIKELY (need)) {
       const guint8 *data;
 
       data = gst_adapter_map (priv->adapter, priv->offset + need);
@@ -1129,7 +1146,8 @@ gst_audio_encoder_push_buffers (GstAudioEncoder * enc, gboolean force)
 
     if (G_LIKELY (buf)) {
       gst_buffer_unref (buf);
-      gst_adapter_unmap (priv->adapter);
+      if (!zero_copy)
+        gst_adapter_unmap (priv->adapter);
     }
 
   finish:
@@ -2645,6 +2663,60 @@ gst_audio_encoder_get_drainable (GstAudioEncoder * enc)
   return result;
 }
 
+/**
+ * gst_audio_encoder_set_zero_copy_input:
+ * @enc: a #GstAudioEncoder
+ * @enabled: new state
+ *
+ * Configures how input data is handed to the subclass.  By default, the
+ * samples for a frame are merged into one contiguous block of memory, which
+ * requires a copy whenever they span several input buffers.  If enabled,
+ * the buffer passed to @handle_frame instead shares the memory of the input
+ * buffers and may consist of several #GstMemory blocks, so subclasses
+ * feeding a scatter-gather capable codec API can avoid the copy by walking
+ * the memory blocks with gst_buffer_n_memory() and gst_buffer_peek_memory().
+ *
+ * MT safe.
+ *
+ * Since: 1.8
+ */
+void
+gst_audio_encoder_set_zero_copy_input (GstAudioEncoder * enc, gboolean enabled)
+{
+  g_return_if_fail (GST_IS_AUDIO_ENCODER (enc));
+
+  GST_OBJECT_LOCK (enc);
+  enc->priv->zero_copy_input = enabled;
+  GST_OBJECT_UNLOCK (enc);
+}
+
+/**
+ * gst_audio_encoder_get_zero_copy_input:
+ * @enc: a #GstAudioEncoder
+ *
+ * Queries whether the subclass is handed input buffers sharing the memory
+ * of the input buffers.
+ *
+ * Returns: TRUE if zero-copy input is enabled.
+ *
+ * MT safe.
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_audio_encoder_get_zero_copy_input (GstAudioEncoder * enc)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GST_IS_AUDIO_ENCODER (enc), FALSE);
+
+  GST_OBJECT_LOCK (enc);
+  result = enc->priv->zero_copy_input;
+  GST_OBJECT_UNLOCK (enc);
+
+  return result;
+}
+
 /**
  * gst_audio_encoder_merge_tags:
  * @enc: a #GstAudioEncoder
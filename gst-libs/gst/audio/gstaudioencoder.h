@@ -327,6 +327,11 @@ void            gst_audio_encoder_set_drainable (GstAudioEncoder * enc,
 
 gboolean        gst_audio_encoder_get_drainable (GstAudioEncoder * enc);
 
+void            gst_audio_encoder_set_zero_copy_input (GstAudioEncoder * enc,
+                                                       gboolean enabled);
+
+gboolean        gst_audio_encoder_get_zero_copy_input (GstAudioEncoder * enc);
+
 void            gst_audio_encoder_get_allocator (GstAudioEncoder * enc,
                                                  GstAllocator ** allocator,
                                                  GstAllocationParams * params);
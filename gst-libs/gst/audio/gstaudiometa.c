@@ -19,11 +19,15 @@
 
 /**
  * SECTION:gstaudiometa
- * @short_description: Buffer metadata for audio downmix matrix handling
+ * @short_description: Buffer metadata for audio downmix matrix and
+ *     sample layout handling
  *
  * #GstAudioDownmixMeta defines an audio downmix matrix to be send along with
  * audio buffers. These functions in this module help to create and attach the
  * meta as well as extracting it.
+ *
+ * #GstAudioMeta describes the layout of the samples in an audio buffer, in
+ * particular the position of each channel plane of non-interleaved audio.
  */
 
 #include <string.h>
@@ -199,3 +203,154 @@ gst_audio_downmix_meta_get_info (void)
   }
   return audio_downmix_meta_info;
 }
+
+static gboolean
+gst_audio_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  GstAudioMeta *ameta = (GstAudioMeta *) meta;
+
+  gst_audio_info_init (&ameta->info);
+  ameta->samples = 0;
+  ameta->offsets = NULL;
+
+  return TRUE;
+}
+
+static void
+gst_audio_meta_free (GstMeta * meta, GstBuffer * buffer)
+{
+  GstAudioMeta *ameta = (GstAudioMeta *) meta;
+
+  if (ameta->offsets && ameta->offsets != ameta->priv_offsets_arr)
+    g_slice_free1 (ameta->info.channels * sizeof (gsize), ameta->offsets);
+}
+
+static gboolean
+gst_audio_meta_transform (GstBuffer * dest, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstAudioMeta *smeta, *dmeta;
+
+  smeta = (GstAudioMeta *) meta;
+
+  if (GST_META_TRANSFORM_IS_COPY (type)) {
+    GstMetaTransformCopy *copy = data;
+
+    /* the offsets are only valid for the complete buffer */
+    if (copy->region)
+      return FALSE;
+
+    dmeta = gst_buffer_add_audio_meta (dest, &smeta->info, smeta->samples,
+        smeta->offsets);
+    if (!dmeta)
+      return FALSE;
+  } else {
+    /* return FALSE, if transform type is not supported */
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_buffer_add_audio_meta:
+ * @buffer: a #GstBuffer
+ * @info: the audio properties of the buffer
+ * @samples: the number of valid samples in the buffer
+ * @offsets: (nullable) (array): the offsets (in bytes) where each channel
+ *   plane starts in the buffer or %NULL to calculate it
+ *
+ * Attaches #GstAudioMeta metadata to @buffer with the given parameters.
+ *
+ * @offsets is only used for non-interleaved audio and must contain one
+ * entry per channel. When it is %NULL, the planes are assumed to be packed
+ * back to back, each @samples samples long. For interleaved audio @offsets
+ * must be %NULL.
+ *
+ * Returns: (transfer none): the #GstAudioMeta on @buffer or %NULL when the
+ *   planes do not fit in @buffer.
+ *
+ * Since: 1.8
+ */
+GstAudioMeta *
+gst_buffer_add_audio_meta (GstBuffer * buffer, const GstAudioInfo * info,
+    gsize samples, const gsize * offsets)
+{
+  GstAudioMeta *meta;
+  gint i, channels, bps;
+  gsize plane_size, max_offset = 0;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (info != NULL, NULL);
+  g_return_val_if_fail (GST_AUDIO_INFO_IS_VALID (info), NULL);
+  g_return_val_if_fail (GST_AUDIO_INFO_LAYOUT (info) ==
+      GST_AUDIO_LAYOUT_NON_INTERLEAVED || offsets == NULL, NULL);
+
+  channels = GST_AUDIO_INFO_CHANNELS (info);
+  bps = GST_AUDIO_INFO_BPS (info);
+  plane_size = samples * bps;
+
+  if (GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    if (offsets) {
+      for (i = 0; i < channels; i++) {
+        /* the planes must start on a sample boundary */
+        g_return_val_if_fail (offsets[i] % bps == 0, NULL);
+        max_offset = MAX (max_offset, offsets[i]);
+      }
+    } else {
+      max_offset = plane_size * (channels - 1);
+    }
+    g_return_val_if_fail (max_offset + plane_size <=
+        gst_buffer_get_size (buffer), NULL);
+  } else {
+    g_return_val_if_fail (samples * GST_AUDIO_INFO_BPF (info) <=
+        gst_buffer_get_size (buffer), NULL);
+  }
+
+  meta = (GstAudioMeta *) gst_buffer_add_meta (buffer, GST_AUDIO_META_INFO,
+      NULL);
+
+  meta->info = *info;
+  meta->samples = samples;
+
+  if (GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    if (channels <= (gint) G_N_ELEMENTS (meta->priv_offsets_arr))
+      meta->offsets = meta->priv_offsets_arr;
+    else
+      meta->offsets = g_slice_alloc (channels * sizeof (gsize));
+
+    for (i = 0; i < channels; i++)
+      meta->offsets[i] = offsets ? offsets[i] : i * plane_size;
+  }
+
+  return meta;
+}
+
+GType
+gst_audio_meta_api_get_type (void)
+{
+  static volatile GType type;
+  static const gchar *tags[] = { GST_META_TAG_AUDIO_STR,
+    GST_META_TAG_AUDIO_CHANNELS_STR, GST_META_TAG_AUDIO_RATE_STR, NULL
+  };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstAudioMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+const GstMetaInfo *
+gst_audio_meta_get_info (void)
+{
+  static const GstMetaInfo *audio_meta_info = NULL;
+
+  if (g_once_init_enter (&audio_meta_info)) {
+    const GstMetaInfo *meta = gst_meta_register (GST_AUDIO_META_API_TYPE,
+        "GstAudioMeta", sizeof (GstAudioMeta), gst_audio_meta_init,
+        gst_audio_meta_free, gst_audio_meta_transform);
+    g_once_init_leave (&audio_meta_info, meta);
+  }
+  return audio_meta_info;
+}
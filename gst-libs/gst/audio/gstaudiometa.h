@@ -71,6 +71,49 @@ GstAudioDownmixMeta * gst_buffer_add_audio_downmix_meta (GstBuffer    *buffer,
                                                          gint                           to_channels,
                                                          const gfloat                 **matrix);
 
+#define GST_AUDIO_META_API_TYPE (gst_audio_meta_api_get_type())
+#define GST_AUDIO_META_INFO  (gst_audio_meta_get_info())
+
+typedef struct _GstAudioMeta GstAudioMeta;
+
+/**
+ * GstAudioMeta:
+ * @meta: parent #GstMeta
+ * @info: the audio properties of the buffer
+ * @samples: the number of valid samples in the buffer
+ * @offsets: the offsets (in bytes) where each channel plane starts in the
+ *   buffer or %NULL if the buffer has interleaved layout
+ *
+ * Buffer metadata describing how audio samples are laid out in the buffer.
+ *
+ * This is mostly useful for non-interleaved audio, where the channel planes
+ * do not need to be packed back to back and can start at arbitrary offsets
+ * in the buffer. Each plane contains @samples samples of one channel.
+ *
+ * Since: 1.8
+ */
+struct _GstAudioMeta {
+  GstMeta      meta;
+
+  GstAudioInfo info;
+  gsize        samples;
+  gsize       *offsets;
+
+  /*< private >*/
+  gsize        priv_offsets_arr[8];
+  gpointer     _gst_reserved[GST_PADDING];
+};
+
+GType gst_audio_meta_api_get_type (void);
+const GstMetaInfo * gst_audio_meta_get_info (void);
+
+#define gst_buffer_get_audio_meta(b) ((GstAudioMeta*)gst_buffer_get_meta((b), GST_AUDIO_META_API_TYPE))
+
+GstAudioMeta * gst_buffer_add_audio_meta (GstBuffer          *buffer,
+                                          const GstAudioInfo *info,
+                                          gsize               samples,
+                                          const gsize        *offsets);
+
 G_END_DECLS
 
 #endif /* __GST_AUDIO_META_H__ */
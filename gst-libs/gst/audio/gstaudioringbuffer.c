@@ -34,11 +34,27 @@
  * abstraction for DMA based ringbuffers as well as a pure software
  * implementations.
  * </para>
+ * <para>
+ * By default, a writer that has to wait for a free segment sleeps on the
+ * object lock and @cond. For low latency operation with small segments,
+ * gst_audio_ring_buffer_set_lock_free() makes the writer sleep on a futex
+ * instead, so that the reader never takes the object lock and only makes a
+ * system call when the writer is actually sleeping.
+ * </para>
  * </refsect2>
  */
 
 #include <string.h>
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined (SYS_futex) && defined (FUTEX_WAIT_PRIVATE)
+#define HAVE_FUTEX 1
+#endif
+#endif
+
 #include <gst/audio/audio.h>
 #include "gstaudioringbuffer.h"
 
@@ -49,6 +65,7 @@ static void gst_audio_ring_buffer_dispose (GObject * object);
 static void gst_audio_ring_buffer_finalize (GObject * object);
 
 static gboolean gst_audio_ring_buffer_pause_unlocked (GstAudioRingBuffer * buf);
+static void wake_lock_free (GstAudioRingBuffer * buf);
 static void default_clear_all (GstAudioRingBuffer * buf);
 static guint default_commit (GstAudioRingBuffer * buf, guint64 * sample,
     guint8 * data, gint in_samples, gint out_samples, gint * accum);
@@ -692,6 +709,7 @@ gst_audio_ring_buffer_release (GstAudioRingBuffer * buf)
   /* signal any waiters */
   GST_DEBUG_OBJECT (buf, "signal waiter");
   GST_AUDIO_RING_BUFFER_SIGNAL (buf);
+  wake_lock_free (buf);
 
   if (G_UNLIKELY (!res))
     goto release_failed;
@@ -860,6 +878,7 @@ gst_audio_ring_buffer_set_flushing (GstAudioRingBuffer * buf, gboolean flushing)
 
   if (flushing) {
     gst_audio_ring_buffer_pause_unlocked (buf);
+    wake_lock_free (buf);
   } else {
     gst_audio_ring_buffer_clear_all (buf);
   }
@@ -1000,6 +1019,7 @@ gst_audio_ring_buffer_pause_unlocked (GstAudioRingBuffer * buf)
   /* signal any waiters */
   GST_DEBUG_OBJECT (buf, "signal waiter");
   GST_AUDIO_RING_BUFFER_SIGNAL (buf);
+  wake_lock_free (buf);
 
   rclass = GST_AUDIO_RING_BUFFER_GET_CLASS (buf);
   if (G_LIKELY (rclass->pause))
@@ -1109,6 +1129,7 @@ gst_audio_ring_buffer_stop (GstAudioRingBuffer * buf)
   /* signal any waiters */
   GST_DEBUG_OBJECT (buf, "signal waiter");
   GST_AUDIO_RING_BUFFER_SIGNAL (buf);
+  wake_lock_free (buf);
 
   rclass = GST_AUDIO_RING_BUFFER_GET_CLASS (buf);
   if (G_LIKELY (rclass->stop))
@@ -1275,6 +1296,77 @@ gst_audio_ring_buffer_clear_all (GstAudioRingBuffer * buf)
 }
 
 
+static void
+wake_lock_free (GstAudioRingBuffer * buf)
+{
+#ifdef HAVE_FUTEX
+  if (!buf->abidata.ABI.lock_free)
+    return;
+
+  g_atomic_int_inc (&buf->abidata.ABI.wakeup_seq);
+  /* only enter the kernel when the writer is asleep */
+  if (g_atomic_int_get (&buf->waiting)) {
+    GST_LOG_OBJECT (buf, "wake waiter");
+    syscall (SYS_futex, &buf->abidata.ABI.wakeup_seq, FUTEX_WAKE_PRIVATE, 1,
+        NULL, NULL, 0);
+  }
+#endif
+}
+
+#ifdef HAVE_FUTEX
+/* Sleeps until wake_lock_free() is called. Because the sequence number is
+ * read before checking the state, any wakeup after that makes the futex
+ * wait return immediately. */
+static gboolean
+wait_segment_lock_free (GstAudioRingBuffer * buf, gboolean wait)
+{
+  gint seq, segments;
+
+  seq = g_atomic_int_get (&buf->abidata.ABI.wakeup_seq);
+  segments = g_atomic_int_get (&buf->segdone);
+
+  /* full barrier, the reader sees this before checking if it must wake us */
+  g_atomic_int_compare_and_exchange (&buf->waiting, 0, 1);
+
+  if (G_UNLIKELY (buf->flushing))
+    goto flushing;
+
+  if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
+          GST_AUDIO_RING_BUFFER_STATE_STARTED))
+    goto not_started;
+
+  if (G_LIKELY (wait) && g_atomic_int_get (&buf->segdone) == segments) {
+    GST_LOG_OBJECT (buf, "waiting..");
+    syscall (SYS_futex, &buf->abidata.ABI.wakeup_seq, FUTEX_WAIT_PRIVATE, seq,
+        NULL, NULL, 0);
+
+    if (G_UNLIKELY (buf->flushing))
+      goto flushing;
+
+    if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
+            GST_AUDIO_RING_BUFFER_STATE_STARTED))
+      goto not_started;
+  }
+  g_atomic_int_set (&buf->waiting, 0);
+
+  return TRUE;
+
+  /* ERROR */
+not_started:
+  {
+    g_atomic_int_set (&buf->waiting, 0);
+    GST_DEBUG_OBJECT (buf, "stopped processing");
+    return FALSE;
+  }
+flushing:
+  {
+    g_atomic_int_set (&buf->waiting, 0);
+    GST_DEBUG_OBJECT (buf, "flushing");
+    return FALSE;
+  }
+}
+#endif
+
 static gboolean
 wait_segment (GstAudioRingBuffer * buf)
 {
@@ -1297,6 +1389,10 @@ wait_segment (GstAudioRingBuffer * buf)
     if (G_LIKELY (g_atomic_int_get (&buf->segdone) != segments))
       wait = FALSE;
   }
+#ifdef HAVE_FUTEX
+  if (buf->abidata.ABI.lock_free)
+    return wait_segment_lock_free (buf, wait);
+#endif
 
   /* take lock first, then update our waiting flag */
   GST_OBJECT_LOCK (buf);
@@ -1887,6 +1983,11 @@ gst_audio_ring_buffer_advance (GstAudioRingBuffer * buf, guint advance)
   /* update counter */
   g_atomic_int_add (&buf->segdone, advance);
 
+  if (buf->abidata.ABI.lock_free) {
+    wake_lock_free (buf);
+    return;
+  }
+
   /* the lock is already taken when the waiting flag is set,
    * we grab the lock as well to make sure the waiter is actually
    * waiting for the signal */
@@ -2025,3 +2126,63 @@ not_acquired:
     goto done;
   }
 }
+
+/**
+ * gst_audio_ring_buffer_set_lock_free:
+ * @buf: the #GstAudioRingBuffer
+ * @lock_free: whether to use lock-free wakeups
+ *
+ * Configures how the writer waits for free segments. In lock-free mode, the
+ * thread calling gst_audio_ring_buffer_advance() never takes the object lock
+ * and only makes a system call when the writer is sleeping. This reduces the
+ * wakeup jitter for short segments.
+ *
+ * This must be called before the ringbuffer is started. Lock-free mode is not
+ * available on all platforms.
+ *
+ * Returns: %TRUE if the requested mode is now active.
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_audio_ring_buffer_set_lock_free (GstAudioRingBuffer * buf,
+    gboolean lock_free)
+{
+  g_return_val_if_fail (GST_IS_AUDIO_RING_BUFFER (buf), FALSE);
+
+#ifndef HAVE_FUTEX
+  if (lock_free) {
+    GST_DEBUG_OBJECT (buf, "lock-free mode not supported");
+    return FALSE;
+  }
+#endif
+
+  GST_OBJECT_LOCK (buf);
+  if (G_UNLIKELY (g_atomic_int_get (&buf->state) ==
+          GST_AUDIO_RING_BUFFER_STATE_STARTED)) {
+    GST_OBJECT_UNLOCK (buf);
+    GST_WARNING_OBJECT (buf, "can't change wakeup mode while started");
+    return buf->abidata.ABI.lock_free == lock_free;
+  }
+  GST_DEBUG_OBJECT (buf, "lock-free %d", lock_free);
+  buf->abidata.ABI.lock_free = lock_free;
+  GST_OBJECT_UNLOCK (buf);
+
+  return TRUE;
+}
+
+/**
+ * gst_audio_ring_buffer_get_lock_free:
+ * @buf: the #GstAudioRingBuffer
+ *
+ * Returns: %TRUE if @buf uses lock-free wakeups.
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_audio_ring_buffer_get_lock_free (GstAudioRingBuffer * buf)
+{
+  g_return_val_if_fail (GST_IS_AUDIO_RING_BUFFER (buf), FALSE);
+
+  return buf->abidata.ABI.lock_free;
+}
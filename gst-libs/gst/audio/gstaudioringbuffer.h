@@ -206,7 +206,14 @@ struct _GstAudioRingBuffer {
   gboolean                    active;
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  union {
+    struct {
+      /* ATOMIC, bumped on every event a lock-free waiter cares about */
+      gint                    wakeup_seq;
+      gboolean                lock_free;
+    } ABI;
+    gpointer _gst_reserved[GST_PADDING];
+  } abidata;
 };
 
 /**
@@ -333,6 +340,9 @@ void            gst_audio_ring_buffer_advance         (GstAudioRingBuffer *buf,
 
 void            gst_audio_ring_buffer_may_start       (GstAudioRingBuffer *buf, gboolean allowed);
 
+gboolean        gst_audio_ring_buffer_set_lock_free   (GstAudioRingBuffer *buf, gboolean lock_free);
+gboolean        gst_audio_ring_buffer_get_lock_free   (GstAudioRingBuffer *buf);
+
 G_END_DECLS
 
 #endif /* __GST_AUDIO_RING_BUFFER_H__ */
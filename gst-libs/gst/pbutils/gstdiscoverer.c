@@ -37,6 +37,18 @@
  * By default this will use the GLib default main context unless you have
  * set a custom context using g_main_context_push_thread_default().
  *
+ * In non-blocking mode several URIs can be discovered in parallel by
+ * setting the #GstDiscoverer:max-concurrent property.
+ *
+ * Successful results can be kept in a cache by setting the
+ * #GstDiscoverer:cache-size property, so that local files that did not change
+ * since their last discovery are answered without building a pipeline. The
+ * cache can be stored across runs with gst_discoverer_save_cache() and
+ * gst_discoverer_load_cache().
+ *
+ * When only container level information is needed, the
+ * #GstDiscoverer:header-only property avoids creating decoders altogether.
+ *
  * All the information is returned in a #GstDiscovererInfo structure.
  */
 
@@ -44,6 +56,7 @@
 #include "config.h"
 #endif
 
+#include <glib/gstdio.h>
 #include <gst/video/video.h>
 #include <gst/audio/audio.h>
 
@@ -73,6 +86,29 @@ typedef struct
   gchar *stream_id;
 } PrivateStream;
 
+/* Identifies the version of a local file that was discovered */
+typedef struct
+{
+  guint64 mtime;                /* in nanoseconds where available */
+  guint64 size;
+  guint64 inode;
+} DiscovererCacheStamp;
+
+/* Cached result of a successful discovery of a local file, valid as long as
+ * the file keeps the same stamp */
+typedef struct
+{
+  gchar *uri;
+  DiscovererCacheStamp stamp;
+  GstDiscovererInfo *info;
+  /* position in the most recently used list */
+  GList link;
+} DiscovererCacheEntry;
+
+#define DISCOVERER_CACHE_VERSION 2
+#define DISCOVERER_CACHE_ENTRY_TYPE "(stttv)"
+#define DISCOVERER_CACHE_TYPE "(ua" DISCOVERER_CACHE_ENTRY_TYPE ")"
+
 struct _GstDiscovererPrivate
 {
   gboolean async;
@@ -126,6 +162,29 @@ struct _GstDiscovererPrivate
   gulong source_chg_id;
   gulong element_added_id;
   gulong bus_cb_id;
+
+  /* parallel discovery in async mode: the pending uris are handed to
+   * worker discoverers instead of being processed by this one */
+  guint max_concurrent;
+  GList *workers;
+  GList *idle_workers;
+  guint busy_workers;
+
+  /* results cache, shared with the workers of a parallel discoverer through
+   * cache_owner. Protected by cache_lock */
+  GstDiscoverer *cache_owner;
+  GMutex cache_lock;
+  guint cache_size;
+  GHashTable *cache;
+  GQueue cache_lru;
+
+  /* TRUE if current_info was taken from the cache */
+  gboolean current_cached;
+
+  /* TRUE if streams are not decoded, only demuxed and parsed */
+  gboolean header_only;
+  gulong autoplug_continue_id;
+  gulong autoplug_select_id;
 };
 
 #define DISCO_LOCK(dc) g_mutex_lock (&dc->priv->lock);
@@ -158,11 +217,17 @@ enum
 };
 
 #define DEFAULT_PROP_TIMEOUT 15 * GST_SECOND
+#define DEFAULT_PROP_MAX_CONCURRENT 1
+#define DEFAULT_PROP_CACHE_SIZE 0
+#define DEFAULT_PROP_HEADER_ONLY FALSE
 
 enum
 {
   PROP_0,
-  PROP_TIMEOUT
+  PROP_TIMEOUT,
+  PROP_MAX_CONCURRENT,
+  PROP_CACHE_SIZE,
+  PROP_HEADER_ONLY
 };
 
 static guint gst_discoverer_signals[LAST_SIGNAL] = { 0 };
@@ -215,6 +280,59 @@ gst_discoverer_class_init (GstDiscovererClass * klass)
           GST_SECOND, 3600 * GST_SECOND, DEFAULT_PROP_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDiscoverer:max-concurrent:
+   *
+   * The maximum number of URIs that are discovered in parallel in
+   * asynchronous mode, each in its own pipeline.
+   *
+   * The #GstDiscoverer::discovered signal is still emitted once per URI, but
+   * not necessarily in the order in which the URIs were added. Changes only
+   * take effect on the next call to gst_discoverer_start(). The synchronous
+   * API always discovers one URI at a time.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_CONCURRENT,
+      g_param_spec_uint ("max-concurrent", "Max concurrent",
+          "Maximum number of URIs discovered in parallel in async mode",
+          1, 256, DEFAULT_PROP_MAX_CONCURRENT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDiscoverer:cache-size:
+   *
+   * The maximum number of results kept in the cache of the discoverer, or 0
+   * to disable the cache.
+   *
+   * Only successful discoveries of local files are cached, keyed by their
+   * URI, modification time, size and inode. When the cache is full the least
+   * recently used result is dropped.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_CACHE_SIZE,
+      g_param_spec_uint ("cache-size", "Cache size",
+          "Maximum number of discovery results kept in the cache (0 = disabled)",
+          0, G_MAXUINT, DEFAULT_PROP_CACHE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDiscoverer:header-only:
+   *
+   * If %TRUE, streams are only demuxed and parsed, and no decoder is ever
+   * created. The resulting stream information is based on the caps of the
+   * parsed streams, which is usually enough to get the codecs, tags,
+   * duration and basic audio/video properties at a fraction of the cost.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_HEADER_ONLY,
+      g_param_spec_boolean ("header-only", "Header only",
+          "Only demux and parse streams, never decode them",
+          DEFAULT_PROP_HEADER_ONLY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* signals */
   /**
    * GstDiscoverer::finished:
@@ -291,6 +409,54 @@ uridecodebin_element_added_cb (GstElement * uridecodebin,
   }
 }
 
+/* mirrors GstAutoplugSelectResult from the playback plugin */
+enum
+{
+  AUTOPLUG_SELECT_TRY,
+  AUTOPLUG_SELECT_EXPOSE
+};
+
+/* In header-only mode the parsed caps are final, there is nothing more we can
+ * learn without decoding */
+static gboolean
+uridecodebin_autoplug_continue_cb (GstElement * uridecodebin, GstPad * pad,
+    GstCaps * caps, GstDiscoverer * dc)
+{
+  GstStructure *st;
+  gboolean parsed = FALSE;
+
+  if (!dc->priv->header_only || gst_caps_get_size (caps) == 0)
+    return TRUE;
+
+  st = gst_caps_get_structure (caps, 0);
+  if (!gst_structure_get_boolean (st, "parsed", &parsed))
+    gst_structure_get_boolean (st, "framed", &parsed);
+
+  if (parsed)
+    GST_DEBUG_OBJECT (dc, "stopping at parsed caps %" GST_PTR_FORMAT, caps);
+
+  return !parsed;
+}
+
+/* Streams for which no parser is available would get a decoder next, expose
+ * them instead */
+static gint
+uridecodebin_autoplug_select_cb (GstElement * uridecodebin, GstPad * pad,
+    GstCaps * caps, GstElementFactory * factory, GstDiscoverer * dc)
+{
+  if (dc->priv->header_only
+      && gst_element_factory_list_is_type (factory,
+          GST_ELEMENT_FACTORY_TYPE_DECODER)
+      && !gst_element_factory_list_is_type (factory,
+          GST_ELEMENT_FACTORY_TYPE_PARSER | GST_ELEMENT_FACTORY_TYPE_DEMUXER)) {
+    GST_DEBUG_OBJECT (dc, "not plugging decoder %s for %" GST_PTR_FORMAT,
+        GST_OBJECT_NAME (factory), caps);
+    return AUTOPLUG_SELECT_EXPOSE;
+  }
+
+  return AUTOPLUG_SELECT_TRY;
+}
+
 static void
 gst_discoverer_init (GstDiscoverer * dc)
 {
@@ -301,10 +467,15 @@ gst_discoverer_init (GstDiscoverer * dc)
       GstDiscovererPrivate);
 
   dc->priv->timeout = DEFAULT_PROP_TIMEOUT;
+  dc->priv->max_concurrent = DEFAULT_PROP_MAX_CONCURRENT;
+  dc->priv->cache_size = DEFAULT_PROP_CACHE_SIZE;
   dc->priv->async = FALSE;
   dc->priv->async_done = FALSE;
 
   g_mutex_init (&dc->priv->lock);
+  g_mutex_init (&dc->priv->cache_lock);
+  dc->priv->cache = g_hash_table_new (g_str_hash, g_str_equal);
+  g_queue_init (&dc->priv->cache_lru);
 
   dc->priv->pending_subtitle_pads = 0;
 
@@ -329,6 +500,12 @@ gst_discoverer_init (GstDiscoverer * dc)
   dc->priv->source_chg_id =
       g_signal_connect_object (dc->priv->uridecodebin, "notify::source",
       G_CALLBACK (uridecodebin_source_changed_cb), dc, 0);
+  dc->priv->autoplug_continue_id =
+      g_signal_connect_object (dc->priv->uridecodebin, "autoplug-continue",
+      G_CALLBACK (uridecodebin_autoplug_continue_cb), dc, 0);
+  dc->priv->autoplug_select_id =
+      g_signal_connect_object (dc->priv->uridecodebin, "autoplug-select",
+      G_CALLBACK (uridecodebin_autoplug_select_cb), dc, 0);
 
   GST_LOG_OBJECT (dc, "Getting pipeline bus");
   dc->priv->bus = gst_pipeline_get_bus ((GstPipeline *) dc->priv->pipeline);
@@ -368,6 +545,149 @@ discoverer_reset (GstDiscoverer * dc)
     gst_element_set_state ((GstElement *) dc->priv->pipeline, GST_STATE_NULL);
 }
 
+/* Results cache */
+
+static gboolean
+discoverer_cache_stat (const gchar * uri, DiscovererCacheStamp * stamp)
+{
+  GStatBuf st;
+  gchar *filename;
+  gboolean ret = FALSE;
+
+  if (!gst_uri_has_protocol (uri, "file"))
+    return FALSE;
+
+  filename = g_filename_from_uri (uri, NULL, NULL);
+  if (filename && g_stat (filename, &st) == 0) {
+    /* a file rewritten within the same second must not match */
+    stamp->mtime = (guint64) st.st_mtime * GST_SECOND;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    stamp->mtime += st.st_mtim.tv_nsec;
+#endif
+    stamp->size = st.st_size;
+    stamp->inode = st.st_ino;
+    ret = TRUE;
+  }
+  g_free (filename);
+
+  return ret;
+}
+
+static gboolean
+discoverer_cache_stamp_equal (const DiscovererCacheStamp * a,
+    const DiscovererCacheStamp * b)
+{
+  return a->mtime == b->mtime && a->size == b->size && a->inode == b->inode;
+}
+
+static void
+discoverer_cache_entry_free (DiscovererCacheEntry * entry)
+{
+  gst_discoverer_info_unref (entry->info);
+  g_free (entry->uri);
+  g_slice_free (DiscovererCacheEntry, entry);
+}
+
+/* call with the cache_lock of the owner */
+static void
+discoverer_cache_trim (GstDiscoverer * owner, guint max_size)
+{
+  DiscovererCacheEntry *entry;
+
+  while (owner->priv->cache_lru.length > max_size) {
+    entry = owner->priv->cache_lru.tail->data;
+    g_queue_unlink (&owner->priv->cache_lru, &entry->link);
+    g_hash_table_remove (owner->priv->cache, entry->uri);
+    discoverer_cache_entry_free (entry);
+  }
+}
+
+/* call with the cache_lock of the owner, takes ownership of @info */
+static void
+discoverer_cache_insert (GstDiscoverer * owner, const gchar * uri,
+    const DiscovererCacheStamp * stamp, GstDiscovererInfo * info)
+{
+  DiscovererCacheEntry *entry;
+
+  entry = g_hash_table_lookup (owner->priv->cache, uri);
+  if (entry) {
+    g_queue_unlink (&owner->priv->cache_lru, &entry->link);
+    g_hash_table_remove (owner->priv->cache, entry->uri);
+    discoverer_cache_entry_free (entry);
+  }
+
+  entry = g_slice_new0 (DiscovererCacheEntry);
+  entry->uri = g_strdup (uri);
+  entry->stamp = *stamp;
+  entry->info = info;
+  entry->link.data = entry;
+
+  g_hash_table_insert (owner->priv->cache, entry->uri, entry);
+  g_queue_push_head_link (&owner->priv->cache_lru, &entry->link);
+  discoverer_cache_trim (owner, owner->priv->cache_size);
+}
+
+/* Returns a new reference to the cached result for @uri if the file did not
+ * change since it was discovered */
+static GstDiscovererInfo *
+discoverer_cache_lookup (GstDiscoverer * dc, const gchar * uri)
+{
+  GstDiscoverer *owner;
+  DiscovererCacheEntry *entry;
+  GstDiscovererInfo *info = NULL;
+  DiscovererCacheStamp stamp;
+
+  owner = dc->priv->cache_owner ? dc->priv->cache_owner : dc;
+
+  g_mutex_lock (&owner->priv->cache_lock);
+  if (owner->priv->cache_size == 0)
+    goto done;
+
+  entry = g_hash_table_lookup (owner->priv->cache, uri);
+  if (entry == NULL)
+    goto done;
+
+  if (!discoverer_cache_stat (uri, &stamp)
+      || !discoverer_cache_stamp_equal (&stamp, &entry->stamp)) {
+    GST_DEBUG_OBJECT (dc, "%s changed, dropping cached result", uri);
+    g_queue_unlink (&owner->priv->cache_lru, &entry->link);
+    g_hash_table_remove (owner->priv->cache, entry->uri);
+    discoverer_cache_entry_free (entry);
+    goto done;
+  }
+
+  GST_DEBUG_OBJECT (dc, "cache hit for %s", uri);
+  g_queue_unlink (&owner->priv->cache_lru, &entry->link);
+  g_queue_push_head_link (&owner->priv->cache_lru, &entry->link);
+  info = gst_discoverer_info_ref (entry->info);
+
+done:
+  g_mutex_unlock (&owner->priv->cache_lock);
+
+  return info;
+}
+
+static void
+discoverer_cache_store (GstDiscoverer * dc, GstDiscovererInfo * info)
+{
+  GstDiscoverer *owner;
+  DiscovererCacheStamp stamp;
+
+  /* header-only results would be incomplete for a full discovery */
+  if (info->result != GST_DISCOVERER_OK || info->stream_info == NULL
+      || dc->priv->header_only)
+    return;
+
+  owner = dc->priv->cache_owner ? dc->priv->cache_owner : dc;
+
+  g_mutex_lock (&owner->priv->cache_lock);
+  if (owner->priv->cache_size > 0
+      && discoverer_cache_stat (info->uri, &stamp))
+    discoverer_cache_insert (owner, info->uri, &stamp,
+        gst_discoverer_info_ref (info));
+  g_mutex_unlock (&owner->priv->cache_lock);
+}
+
 #define DISCONNECT_SIGNAL(o,i) G_STMT_START{           \
   if ((i) && g_signal_handler_is_connected ((o), (i))) \
     g_signal_handler_disconnect ((o), (i));            \
@@ -389,6 +709,8 @@ gst_discoverer_dispose (GObject * obj)
     DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->pad_remove_id);
     DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->source_chg_id);
     DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->element_added_id);
+    DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->autoplug_continue_id);
+    DISCONNECT_SIGNAL (dc->priv->uridecodebin, dc->priv->autoplug_select_id);
     DISCONNECT_SIGNAL (dc->priv->bus, dc->priv->bus_cb_id);
 
     /* pipeline was set to NULL in _reset */
@@ -415,6 +737,9 @@ gst_discoverer_finalize (GObject * obj)
 {
   GstDiscoverer *dc = (GstDiscoverer *) obj;
 
+  discoverer_cache_trim (dc, 0);
+  g_hash_table_unref (dc->priv->cache);
+  g_mutex_clear (&dc->priv->cache_lock);
   g_mutex_clear (&dc->priv->lock);
 
   G_OBJECT_CLASS (gst_discoverer_parent_class)->finalize (obj);
@@ -430,6 +755,22 @@ gst_discoverer_set_property (GObject * object, guint prop_id,
     case PROP_TIMEOUT:
       gst_discoverer_set_timeout (dc, g_value_get_uint64 (value));
       break;
+    case PROP_MAX_CONCURRENT:
+      DISCO_LOCK (dc);
+      dc->priv->max_concurrent = g_value_get_uint (value);
+      DISCO_UNLOCK (dc);
+      break;
+    case PROP_CACHE_SIZE:
+      g_mutex_lock (&dc->priv->cache_lock);
+      dc->priv->cache_size = g_value_get_uint (value);
+      discoverer_cache_trim (dc, dc->priv->cache_size);
+      g_mutex_unlock (&dc->priv->cache_lock);
+      break;
+    case PROP_HEADER_ONLY:
+      DISCO_LOCK (dc);
+      dc->priv->header_only = g_value_get_boolean (value);
+      DISCO_UNLOCK (dc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -448,6 +789,21 @@ gst_discoverer_get_property (GObject * object, guint prop_id,
       g_value_set_uint64 (value, dc->priv->timeout);
       DISCO_UNLOCK (dc);
       break;
+    case PROP_MAX_CONCURRENT:
+      DISCO_LOCK (dc);
+      g_value_set_uint (value, dc->priv->max_concurrent);
+      DISCO_UNLOCK (dc);
+      break;
+    case PROP_CACHE_SIZE:
+      g_mutex_lock (&dc->priv->cache_lock);
+      g_value_set_uint (value, dc->priv->cache_size);
+      g_mutex_unlock (&dc->priv->cache_lock);
+      break;
+    case PROP_HEADER_ONLY:
+      DISCO_LOCK (dc);
+      g_value_set_boolean (value, dc->priv->header_only);
+      DISCO_UNLOCK (dc);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1259,6 +1615,9 @@ discoverer_collect (GstDiscoverer * dc)
     }
   }
 
+  if (!dc->priv->current_cached)
+    discoverer_cache_store (dc, dc->priv->current_info);
+
   if (dc->priv->async) {
     GST_DEBUG ("Emitting 'discoverered'");
     g_signal_emit (dc, gst_discoverer_signals[SIGNAL_DISCOVERED], 0,
@@ -1294,8 +1653,12 @@ handle_current_async (GstDiscoverer * dc)
     get_async_cb,
   };
 
-  /* Attach a timeout to the main context */
-  source = g_timeout_source_new (dc->priv->timeout / GST_MSECOND);
+  /* Attach a timeout to the main context, cached results are delivered
+   * right away from the same callback */
+  if (dc->priv->current_cached)
+    source = g_idle_source_new ();
+  else
+    source = g_timeout_source_new (dc->priv->timeout / GST_MSECOND);
   g_source_set_callback_indirect (source, g_object_ref (dc), &cb_funcs);
   dc->priv->timeoutid = g_source_attach (source, dc->priv->ctx);
   g_source_unref (source);
@@ -1479,16 +1842,31 @@ static void
 _setup_locked (GstDiscoverer * dc)
 {
   GstStateChangeReturn ret;
+  GstDiscovererInfo *cached = NULL;
+  gchar *uri;
 
   GST_DEBUG ("Setting up");
 
   /* Pop URI off the pending URI list */
-  dc->priv->current_info =
-      (GstDiscovererInfo *) g_object_new (GST_TYPE_DISCOVERER_INFO, NULL);
-  dc->priv->current_info->uri = (gchar *) dc->priv->pending_uris->data;
+  uri = (gchar *) dc->priv->pending_uris->data;
   dc->priv->pending_uris =
       g_list_delete_link (dc->priv->pending_uris, dc->priv->pending_uris);
 
+  /* the synchronous API checks the cache before queueing the uri */
+  if (dc->priv->async)
+    cached = discoverer_cache_lookup (dc, uri);
+  if (cached) {
+    GST_DEBUG ("Using cached information for %s", uri);
+    g_free (uri);
+    dc->priv->current_info = cached;
+    dc->priv->current_cached = TRUE;
+    return;
+  }
+
+  dc->priv->current_info =
+      (GstDiscovererInfo *) g_object_new (GST_TYPE_DISCOVERER_INFO, NULL);
+  dc->priv->current_info->uri = uri;
+
   /* set uri on uridecodebin */
   g_object_set (dc->priv->uridecodebin, "uri", dc->priv->current_info->uri,
       NULL);
@@ -1542,6 +1920,7 @@ discoverer_cleanup (GstDiscoverer * dc)
   }
 
   dc->priv->current_info = NULL;
+  dc->priv->current_cached = FALSE;
 
   dc->priv->pending_subtitle_pads = 0;
   dc->priv->async_done = FALSE;
@@ -1585,8 +1964,10 @@ async_timeout_cb (GstDiscoverer * dc)
 {
   if (!g_source_is_destroyed (g_main_current_source ())) {
     dc->priv->timeoutid = 0;
-    GST_DEBUG ("Setting result to TIMEOUT");
-    dc->priv->current_info->result = GST_DISCOVERER_TIMEOUT;
+    if (!dc->priv->current_cached) {
+      GST_DEBUG ("Setting result to TIMEOUT");
+      dc->priv->current_info->result = GST_DISCOVERER_TIMEOUT;
+    }
     dc->priv->processing = FALSE;
     discoverer_collect (dc);
     discoverer_cleanup (dc);
@@ -1948,6 +2329,142 @@ out:
   return sinfo;
 }
 
+/* Parallel discovery */
+
+static void
+workers_dispatch (GstDiscoverer * dc)
+{
+  GstDiscoverer *worker;
+  gchar *uri;
+
+  DISCO_LOCK (dc);
+  while (dc->priv->pending_uris && dc->priv->idle_workers) {
+    worker = dc->priv->idle_workers->data;
+    dc->priv->idle_workers =
+        g_list_delete_link (dc->priv->idle_workers, dc->priv->idle_workers);
+    uri = dc->priv->pending_uris->data;
+    dc->priv->pending_uris =
+        g_list_delete_link (dc->priv->pending_uris, dc->priv->pending_uris);
+    dc->priv->busy_workers++;
+    DISCO_UNLOCK (dc);
+
+    GST_DEBUG_OBJECT (dc, "handing %s to %" GST_PTR_FORMAT, uri, worker);
+    gst_discoverer_discover_uri_async (worker, uri);
+    g_free (uri);
+
+    DISCO_LOCK (dc);
+  }
+  DISCO_UNLOCK (dc);
+}
+
+static void
+worker_discovered_cb (GstDiscoverer * worker, GstDiscovererInfo * info,
+    GError * err, GstDiscoverer * dc)
+{
+  g_signal_emit (dc, gst_discoverer_signals[SIGNAL_DISCOVERED], 0, info, err);
+}
+
+static void
+worker_starting_cb (GstDiscoverer * worker, GstDiscoverer * dc)
+{
+  g_signal_emit (dc, gst_discoverer_signals[SIGNAL_STARTING], 0);
+}
+
+static void
+worker_source_setup_cb (GstDiscoverer * worker, GstElement * source,
+    GstDiscoverer * dc)
+{
+  g_signal_emit (dc, gst_discoverer_signals[SIGNAL_SOURCE_SETUP], 0, source);
+}
+
+/* the worker processed its uri */
+static void
+worker_finished_cb (GstDiscoverer * worker, GstDiscoverer * dc)
+{
+  gboolean finished;
+
+  DISCO_LOCK (dc);
+  if (!dc->priv->running) {
+    DISCO_UNLOCK (dc);
+    return;
+  }
+  dc->priv->idle_workers = g_list_prepend (dc->priv->idle_workers, worker);
+  dc->priv->busy_workers--;
+  DISCO_UNLOCK (dc);
+
+  workers_dispatch (dc);
+
+  DISCO_LOCK (dc);
+  finished = (dc->priv->busy_workers == 0 && dc->priv->pending_uris == NULL);
+  DISCO_UNLOCK (dc);
+
+  if (finished)
+    g_signal_emit (dc, gst_discoverer_signals[SIGNAL_FINISHED], 0);
+}
+
+static void
+workers_start (GstDiscoverer * dc, guint n_workers)
+{
+  GstDiscoverer *worker;
+  GstClockTime timeout;
+  gboolean header_only;
+  GList *workers = NULL;
+  guint i;
+
+  DISCO_LOCK (dc);
+  timeout = dc->priv->timeout;
+  header_only = dc->priv->header_only;
+  DISCO_UNLOCK (dc);
+
+  for (i = 0; i < n_workers; i++) {
+    worker = gst_discoverer_new (timeout, NULL);
+    if (worker == NULL)
+      break;
+    worker->priv->cache_owner = dc;
+    worker->priv->header_only = header_only;
+
+    g_signal_connect_object (worker, "discovered",
+        G_CALLBACK (worker_discovered_cb), dc, 0);
+    g_signal_connect_object (worker, "starting",
+        G_CALLBACK (worker_starting_cb), dc, 0);
+    g_signal_connect_object (worker, "source-setup",
+        G_CALLBACK (worker_source_setup_cb), dc, 0);
+    g_signal_connect_object (worker, "finished",
+        G_CALLBACK (worker_finished_cb), dc, 0);
+    gst_discoverer_start (worker);
+
+    workers = g_list_prepend (workers, worker);
+  }
+
+  DISCO_LOCK (dc);
+  dc->priv->workers = workers;
+  dc->priv->idle_workers = g_list_copy (workers);
+  dc->priv->busy_workers = 0;
+  DISCO_UNLOCK (dc);
+
+  GST_DEBUG_OBJECT (dc, "started %u workers", g_list_length (workers));
+}
+
+static void
+workers_stop (GstDiscoverer * dc)
+{
+  GList *workers, *l;
+
+  DISCO_LOCK (dc);
+  workers = dc->priv->workers;
+  dc->priv->workers = NULL;
+  g_list_free (dc->priv->idle_workers);
+  dc->priv->idle_workers = NULL;
+  dc->priv->busy_workers = 0;
+  DISCO_UNLOCK (dc);
+
+  for (l = workers; l; l = l->next) {
+    g_signal_handlers_disconnect_by_data (l->data, dc);
+    gst_discoverer_stop (l->data);
+  }
+  g_list_free_full (workers, g_object_unref);
+}
+
 /**
  * gst_discoverer_start:
  * @discoverer: A #GstDiscoverer
@@ -1961,6 +2478,8 @@ gst_discoverer_start (GstDiscoverer * discoverer)
 {
   GSource *source;
   GMainContext *ctx = NULL;
+  guint max_concurrent;
+  gboolean finished;
 
   GST_DEBUG_OBJECT (discoverer, "Starting...");
 
@@ -1985,7 +2504,25 @@ gst_discoverer_start (GstDiscoverer * discoverer)
   g_source_unref (source);
   discoverer->priv->ctx = g_main_context_ref (ctx);
 
-  start_discovering (discoverer);
+  DISCO_LOCK (discoverer);
+  max_concurrent = discoverer->priv->max_concurrent;
+  DISCO_UNLOCK (discoverer);
+
+  if (max_concurrent > 1) {
+    workers_start (discoverer, max_concurrent);
+    workers_dispatch (discoverer);
+
+    /* without any URI no worker will ever report back */
+    DISCO_LOCK (discoverer);
+    finished = (discoverer->priv->busy_workers == 0
+        && discoverer->priv->pending_uris == NULL);
+    DISCO_UNLOCK (discoverer);
+
+    if (finished)
+      g_signal_emit (discoverer, gst_discoverer_signals[SIGNAL_FINISHED], 0);
+  } else {
+    start_discovering (discoverer);
+  }
   GST_DEBUG_OBJECT (discoverer, "Started");
 }
 
@@ -2021,6 +2558,8 @@ gst_discoverer_stop (GstDiscoverer * discoverer)
   discoverer->priv->running = FALSE;
   DISCO_UNLOCK (discoverer);
 
+  workers_stop (discoverer);
+
   /* Remove timeout handler */
   if (discoverer->priv->timeoutid) {
     g_source_remove (discoverer->priv->timeoutid);
@@ -2062,17 +2601,20 @@ gboolean
 gst_discoverer_discover_uri_async (GstDiscoverer * discoverer,
     const gchar * uri)
 {
-  gboolean can_run;
+  gboolean can_run, parallel;
 
   GST_DEBUG_OBJECT (discoverer, "uri : %s", uri);
 
   DISCO_LOCK (discoverer);
   can_run = (discoverer->priv->pending_uris == NULL);
+  parallel = (discoverer->priv->workers != NULL);
   discoverer->priv->pending_uris =
       g_list_append (discoverer->priv->pending_uris, g_strdup (uri));
   DISCO_UNLOCK (discoverer);
 
-  if (can_run)
+  if (parallel)
+    workers_dispatch (discoverer);
+  else if (can_run)
     start_discovering (discoverer);
 
   return TRUE;
@@ -2103,6 +2645,13 @@ gst_discoverer_discover_uri (GstDiscoverer * discoverer, const gchar * uri,
 
   GST_DEBUG_OBJECT (discoverer, "uri:%s", uri);
 
+  info = discoverer_cache_lookup (discoverer, uri);
+  if (info) {
+    if (err)
+      *err = NULL;
+    return info;
+  }
+
   DISCO_LOCK (discoverer);
   if (G_UNLIKELY (discoverer->priv->current_info)) {
     DISCO_UNLOCK (discoverer);
@@ -2235,3 +2784,227 @@ gst_discoverer_info_from_variant (GVariant * variant)
 
   return info;
 }
+
+/* Checks that a serialized stream info has the layout the parsing code
+ * expects, the cache file could have been modified */
+static gboolean
+discoverer_cache_stream_is_valid (GVariant * stream)
+{
+  GVariant *common, *specific, *inner, *child;
+  GVariantIter iter;
+  gboolean ret = TRUE;
+  guint8 type;
+
+  if (!g_variant_is_of_type (stream, G_VARIANT_TYPE ("(yvv)"))
+      && !g_variant_is_of_type (stream, G_VARIANT_TYPE ("(yvav)")))
+    return FALSE;
+
+  g_variant_get_child (stream, 0, "y", &type);
+  common = g_variant_get_child_value (stream, 1);
+  specific = g_variant_get_child_value (stream, 2);
+
+  inner = g_variant_get_variant (common);
+  if (!g_variant_is_of_type (inner, G_VARIANT_TYPE ("(msmsmsms)")))
+    ret = FALSE;
+  g_variant_unref (inner);
+
+  if (type == 'c') {
+    if (!g_variant_is_of_type (specific, G_VARIANT_TYPE ("av"))) {
+      ret = FALSE;
+    } else {
+      g_variant_iter_init (&iter, specific);
+      while (ret && (child = g_variant_iter_next_value (&iter))) {
+        inner = g_variant_get_variant (child);
+        ret = discoverer_cache_stream_is_valid (inner);
+        g_variant_unref (inner);
+        g_variant_unref (child);
+      }
+    }
+  } else if (!g_variant_is_of_type (specific, G_VARIANT_TYPE_VARIANT)) {
+    ret = FALSE;
+  } else {
+    inner = g_variant_get_variant (specific);
+    if (type == 'a')
+      ret &= g_variant_is_of_type (inner, G_VARIANT_TYPE ("(uuuuums)"));
+    else if (type == 'v')
+      ret &= g_variant_is_of_type (inner, G_VARIANT_TYPE ("(uuuuuuubuub)"));
+    else if (type == 's')
+      ret &= g_variant_is_of_type (inner, G_VARIANT_TYPE ("ms"));
+    else
+      ret = FALSE;
+    g_variant_unref (inner);
+  }
+
+  g_variant_unref (common);
+  g_variant_unref (specific);
+
+  return ret;
+}
+
+/* Checks a variant as created by gst_discoverer_info_to_variant() */
+static gboolean
+discoverer_cache_info_is_valid (GVariant * variant)
+{
+  GVariant *info_variant, *child, *inner;
+  gboolean ret = FALSE;
+
+  if (!g_variant_is_of_type (variant, G_VARIANT_TYPE_VARIANT))
+    return FALSE;
+
+  info_variant = g_variant_get_variant (variant);
+  if (!g_variant_is_of_type (info_variant, G_VARIANT_TYPE ("(vv)")))
+    goto done;
+
+  child = g_variant_get_child_value (info_variant, 0);
+  inner = g_variant_get_variant (child);
+  ret = g_variant_is_of_type (inner, G_VARIANT_TYPE ("(mstbms)"));
+  g_variant_unref (inner);
+  g_variant_unref (child);
+
+  if (ret) {
+    child = g_variant_get_child_value (info_variant, 1);
+    inner = g_variant_get_variant (child);
+    ret = discoverer_cache_stream_is_valid (inner);
+    g_variant_unref (inner);
+    g_variant_unref (child);
+  }
+
+done:
+  g_variant_unref (info_variant);
+
+  return ret;
+}
+
+/**
+ * gst_discoverer_save_cache:
+ * @discoverer: A #GstDiscoverer
+ * @filename: (type filename): the file to write the cache to
+ * @err: (allow-none): return location for a #GError, or %NULL
+ *
+ * Writes the results currently held in the cache of @discoverer to
+ * @filename, so that they can be restored in a later session with
+ * gst_discoverer_load_cache().
+ *
+ * Returns: %TRUE if the cache was written successfully.
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_discoverer_save_cache (GstDiscoverer * discoverer, const gchar * filename,
+    GError ** err)
+{
+  GVariantBuilder entries;
+  DiscovererCacheEntry *entry;
+  GVariant *variant;
+  GList *l;
+  gboolean ret;
+
+  g_return_val_if_fail (GST_IS_DISCOVERER (discoverer), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+
+  g_variant_builder_init (&entries,
+      G_VARIANT_TYPE ("a" DISCOVERER_CACHE_ENTRY_TYPE));
+
+  g_mutex_lock (&discoverer->priv->cache_lock);
+  /* most recently used first */
+  for (l = discoverer->priv->cache_lru.head; l; l = l->next) {
+    entry = l->data;
+    g_variant_builder_add (&entries, DISCOVERER_CACHE_ENTRY_TYPE, entry->uri,
+        entry->stamp.mtime, entry->stamp.size, entry->stamp.inode,
+        gst_discoverer_info_to_variant (entry->info,
+            GST_DISCOVERER_SERIALIZE_ALL));
+  }
+  g_mutex_unlock (&discoverer->priv->cache_lock);
+
+  variant = g_variant_new ("(u@a" DISCOVERER_CACHE_ENTRY_TYPE ")",
+      DISCOVERER_CACHE_VERSION, g_variant_builder_end (&entries));
+  g_variant_ref_sink (variant);
+
+  GST_DEBUG_OBJECT (discoverer, "saving cache to %s", filename);
+  ret = g_file_set_contents (filename, g_variant_get_data (variant),
+      g_variant_get_size (variant), err);
+  g_variant_unref (variant);
+
+  return ret;
+}
+
+/**
+ * gst_discoverer_load_cache:
+ * @discoverer: A #GstDiscoverer
+ * @filename: (type filename): a file written by gst_discoverer_save_cache()
+ * @err: (allow-none): return location for a #GError, or %NULL
+ *
+ * Adds the results stored in @filename to the cache of @discoverer. Entries
+ * for files that changed or disappeared since they were saved, as well as
+ * malformed entries, are skipped,
+ * and no more than #GstDiscoverer:cache-size entries are kept, so the
+ * property should be set before loading.
+ *
+ * Returns: %TRUE if the cache was loaded successfully.
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_discoverer_load_cache (GstDiscoverer * discoverer, const gchar * filename,
+    GError ** err)
+{
+  GVariant *variant, *entries, *info_variant;
+  GstDiscovererInfo *info;
+  DiscovererCacheStamp stamp, cur_stamp;
+  const gchar *uri;
+  gchar *contents;
+  gsize length, i, n_entries;
+  guint32 version;
+
+  g_return_val_if_fail (GST_IS_DISCOVERER (discoverer), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+
+  if (!g_file_get_contents (filename, &contents, &length, err))
+    return FALSE;
+
+  variant = g_variant_new_from_data (G_VARIANT_TYPE (DISCOVERER_CACHE_TYPE),
+      contents, length, FALSE, g_free, contents);
+  g_variant_ref_sink (variant);
+
+  g_variant_get_child (variant, 0, "u", &version);
+  if (version != DISCOVERER_CACHE_VERSION) {
+    GST_WARNING_OBJECT (discoverer, "%s has unsupported version %u", filename,
+        version);
+    g_set_error (err, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+        "Unsupported discoverer cache file '%s'", filename);
+    g_variant_unref (variant);
+    return FALSE;
+  }
+
+  entries = g_variant_get_child_value (variant, 1);
+  n_entries = g_variant_n_children (entries);
+
+  g_mutex_lock (&discoverer->priv->cache_lock);
+  /* insert the least recently used entries first so that the order is
+   * preserved and the oldest ones are dropped if the cache is too small */
+  for (i = n_entries; i > 0; i--) {
+    g_variant_get_child (entries, i - 1, "(&stttv)", &uri,
+        &stamp.mtime, &stamp.size, &stamp.inode, &info_variant);
+
+    if (!discoverer_cache_info_is_valid (info_variant)) {
+      GST_WARNING_OBJECT (discoverer, "skipping malformed entry for %s", uri);
+    } else if (discoverer->priv->cache_size > 0
+        && discoverer_cache_stat (uri, &cur_stamp)
+        && discoverer_cache_stamp_equal (&cur_stamp, &stamp)) {
+      info = gst_discoverer_info_from_variant (info_variant);
+      discoverer_cache_insert (discoverer, uri, &stamp, info);
+    } else {
+      GST_DEBUG_OBJECT (discoverer, "skipping stale entry for %s", uri);
+    }
+    g_variant_unref (info_variant);
+  }
+  g_mutex_unlock (&discoverer->priv->cache_lock);
+
+  GST_DEBUG_OBJECT (discoverer, "loaded %" G_GSIZE_FORMAT " entries from %s",
+      n_entries, filename);
+
+  g_variant_unref (entries);
+  g_variant_unref (variant);
+
+  return TRUE;
+}
@@ -301,6 +301,14 @@ gst_discoverer_discover_uri (GstDiscoverer * discoverer,
 			     const gchar * uri,
 			     GError ** err);
 
+/* Results cache */
+gboolean       gst_discoverer_load_cache (GstDiscoverer *discoverer,
+                                          const gchar *filename,
+                                          GError **err);
+gboolean       gst_discoverer_save_cache (GstDiscoverer *discoverer,
+                                          const gchar *filename,
+                                          GError **err);
+
 G_END_DECLS
 
 #endif /* _GST_DISCOVERER_H */
@@ -159,6 +159,14 @@
  *      Accept data in @handle_frame and provide decoded results to
  *      @gst_video_decoder_finish_frame, or call @gst_video_decoder_drop_frame.
  *   </para></listitem>
+ *   <listitem><para>
+ *      Decoders for formats where every frame can be decoded independently,
+ *      such as intra-only codecs, can instead implement @parallel_decode
+ *      and enable frame-parallel decoding with
+ *      @gst_video_decoder_set_max_parallel_frames. The base class then
+ *      allocates the output frames, decodes up to that many frames
+ *      concurrently on worker threads and finishes them in decoding order.
+ *   </para></listitem>
  * </itemizedlist>
  */
 
@@ -430,8 +438,24 @@ struct _GstVideoDecoderPrivate
 
   /* flags */
   gboolean use_default_pad_acceptcaps;
+
+  /* frame-parallel decoding */
+  guint max_parallel;           /* STREAM_LOCK */
+  GThreadPool *parallel_pool;
+  GMutex parallel_lock;
+  GCond parallel_cond;
+  /* ParallelJob in decoding order, protected with parallel_lock */
+  GQueue parallel_jobs;
 };
 
+typedef struct
+{
+  GstVideoDecoder *decoder;
+  GstVideoCodecFrame *frame;
+  GstFlowReturn ret;
+  gboolean done;
+} ParallelJob;
+
 static GstElementClass *parent_class = NULL;
 static void gst_video_decoder_class_init (GstVideoDecoderClass * klass);
 static void gst_video_decoder_init (GstVideoDecoder * dec,
@@ -472,6 +496,10 @@ static GstFlowReturn gst_video_decoder_flush_parse (GstVideoDecoder * dec,
 
 static void gst_video_decoder_clear_queues (GstVideoDecoder * dec);
 
+static GstFlowReturn gst_video_decoder_parallel_collect (GstVideoDecoder *
+    decoder, gboolean wait_all);
+static void gst_video_decoder_parallel_discard (GstVideoDecoder * decoder);
+
 static gboolean gst_video_decoder_sink_event_default (GstVideoDecoder * decoder,
     GstEvent * event);
 static gboolean gst_video_decoder_src_event_default (GstVideoDecoder * decoder,
@@ -599,6 +627,11 @@ gst_video_decoder_init (GstVideoDecoder * decoder, GstVideoDecoderClass * klass)
   decoder->priv->min_latency = 0;
   decoder->priv->max_latency = 0;
 
+  decoder->priv->max_parallel = 1;
+  g_mutex_init (&decoder->priv->parallel_lock);
+  g_cond_init (&decoder->priv->parallel_cond);
+  g_queue_init (&decoder->priv->parallel_jobs);
+
   gst_video_decoder_reset (decoder, TRUE, TRUE);
 }
 
@@ -868,6 +901,14 @@ gst_video_decoder_finalize (GObject * object)
 
   GST_DEBUG_OBJECT (object, "finalize");
 
+  if (decoder->priv->parallel_pool) {
+    gst_video_decoder_parallel_discard (decoder);
+    g_thread_pool_free (decoder->priv->parallel_pool, FALSE, TRUE);
+    decoder->priv->parallel_pool = NULL;
+  }
+  g_mutex_clear (&decoder->priv->parallel_lock);
+  g_cond_clear (&decoder->priv->parallel_cond);
+
   g_rec_mutex_clear (&decoder->stream_lock);
 
   if (decoder->priv->input_adapter) {
@@ -906,6 +947,11 @@ gst_video_decoder_flush (GstVideoDecoder * dec, gboolean hard)
 
   GST_LOG_OBJECT (dec, "flush hard %d", hard);
 
+  /* frames still being decoded are output on discont, the reset below
+   * throws them away when flushing */
+  if (!hard)
+    ret = gst_video_decoder_parallel_collect (dec, TRUE);
+
   /* Inform subclass */
   if (klass->reset) {
     GST_FIXME_OBJECT (dec, "GstVideoDecoder::reset() is deprecated");
@@ -1047,6 +1093,15 @@ gst_video_decoder_drain_out (GstVideoDecoder * dec, gboolean at_eos)
       ret = gst_video_decoder_parse_available (dec, TRUE, FALSE);
     }
 
+    /* output frames that are still being decoded, nothing can be finished
+     * or drained when that failed */
+    ret = gst_video_decoder_parallel_collect (dec, TRUE);
+    if (ret != GST_FLOW_OK) {
+      GST_DEBUG_OBJECT (dec, "collecting frames failed: %s",
+          gst_flow_get_name (ret));
+      goto done;
+    }
+
     if (at_eos) {
       if (decoder_class->finish)
         ret = decoder_class->finish (dec);
@@ -1062,6 +1117,7 @@ gst_video_decoder_drain_out (GstVideoDecoder * dec, gboolean at_eos)
     ret = gst_video_decoder_flush_parse (dec, TRUE);
   }
 
+done:
   GST_VIDEO_DECODER_STREAM_UNLOCK (dec);
 
   return ret;
@@ -2068,6 +2124,7 @@ gst_video_decoder_reset (GstVideoDecoder * decoder, gboolean full,
   GST_VIDEO_DECODER_STREAM_LOCK (decoder);
 
   if (full || flush_hard) {
+    gst_video_decoder_parallel_discard (decoder);
     gst_segment_init (&decoder->input_segment, GST_FORMAT_UNDEFINED);
     gst_segment_init (&decoder->output_segment, GST_FORMAT_UNDEFINED);
     gst_video_decoder_clear_queues (decoder);
@@ -2233,6 +2290,10 @@ gst_video_decoder_flush_decode (GstVideoDecoder * dec)
     walk = next;
   }
 
+  /* make sure all frames are in the output queue */
+  if (res == GST_FLOW_OK)
+    res = gst_video_decoder_parallel_collect (dec, TRUE);
+
   return res;
 }
 
@@ -3344,6 +3405,149 @@ gst_video_decoder_have_frame (GstVideoDecoder * decoder)
   return ret;
 }
 
+/* Called with the stream lock held, takes ownership of @frame */
+static GstFlowReturn
+gst_video_decoder_parallel_finish (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame, GstFlowReturn ret)
+{
+  if (ret == GST_FLOW_OK)
+    return gst_video_decoder_finish_frame (decoder, frame);
+
+  GST_DEBUG_OBJECT (decoder, "frame %u failed to decode: %s",
+      frame->system_frame_number, gst_flow_get_name (ret));
+
+  if (ret == GST_FLOW_ERROR)
+    GST_VIDEO_DECODER_ERROR (decoder, 1, STREAM, DECODE, (NULL),
+        ("Failed to decode frame %u", frame->system_frame_number), ret);
+
+  gst_video_decoder_drop_frame (decoder, frame);
+
+  return ret;
+}
+
+static void
+gst_video_decoder_parallel_func (ParallelJob * job, GstVideoDecoder * decoder)
+{
+  GstVideoDecoderClass *decoder_class = GST_VIDEO_DECODER_GET_CLASS (decoder);
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstFlowReturn ret;
+
+  ret = decoder_class->parallel_decode (decoder, job->frame);
+
+  g_mutex_lock (&priv->parallel_lock);
+  job->ret = ret;
+  job->done = TRUE;
+  g_cond_broadcast (&priv->parallel_cond);
+  g_mutex_unlock (&priv->parallel_lock);
+}
+
+/* Finishes the decoded frames at the head of the queue, waits for all of them
+ * when @wait_all is set and otherwise until there is room for another frame.
+ * Called with the stream lock held. */
+static GstFlowReturn
+gst_video_decoder_parallel_collect (GstVideoDecoder * decoder,
+    gboolean wait_all)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstFlowReturn ret = GST_FLOW_OK, res;
+  ParallelJob *job;
+
+  g_mutex_lock (&priv->parallel_lock);
+  while ((job = g_queue_peek_head (&priv->parallel_jobs))) {
+    if (!job->done) {
+      if (!wait_all && priv->parallel_jobs.length < priv->max_parallel)
+        break;
+      g_cond_wait (&priv->parallel_cond, &priv->parallel_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->parallel_jobs);
+    g_mutex_unlock (&priv->parallel_lock);
+
+    res = gst_video_decoder_parallel_finish (decoder, job->frame, job->ret);
+    if (ret == GST_FLOW_OK)
+      ret = res;
+    g_slice_free (ParallelJob, job);
+
+    g_mutex_lock (&priv->parallel_lock);
+  }
+  g_mutex_unlock (&priv->parallel_lock);
+
+  return ret;
+}
+
+/* Waits for the frames being decoded and throws them away. Called with the
+ * stream lock held. */
+static void
+gst_video_decoder_parallel_discard (GstVideoDecoder * decoder)
+{
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  ParallelJob *job;
+
+  g_mutex_lock (&priv->parallel_lock);
+  while ((job = g_queue_peek_head (&priv->parallel_jobs))) {
+    if (!job->done) {
+      g_cond_wait (&priv->parallel_cond, &priv->parallel_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->parallel_jobs);
+    GST_DEBUG_OBJECT (decoder, "discarding frame %u",
+        job->frame->system_frame_number);
+    gst_video_decoder_release_frame (decoder, job->frame);
+    g_slice_free (ParallelJob, job);
+  }
+  g_mutex_unlock (&priv->parallel_lock);
+}
+
+static GstFlowReturn
+gst_video_decoder_parallel_submit (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame)
+{
+  GstVideoDecoderClass *decoder_class = GST_VIDEO_DECODER_GET_CLASS (decoder);
+  GstVideoDecoderPrivate *priv = decoder->priv;
+  GstFlowReturn ret;
+  ParallelJob *job;
+
+  /* without output state, the subclass has to configure it from the
+   * streaming thread first */
+  if (priv->max_parallel <= 1 || priv->output_state == NULL) {
+    ret = gst_video_decoder_parallel_collect (decoder, TRUE);
+    if (ret != GST_FLOW_OK) {
+      gst_video_decoder_release_frame (decoder, frame);
+      return ret;
+    }
+    ret = decoder_class->parallel_decode (decoder, frame);
+    return gst_video_decoder_parallel_finish (decoder, frame, ret);
+  }
+
+  ret = gst_video_decoder_allocate_output_frame (decoder, frame);
+  if (ret != GST_FLOW_OK) {
+    gst_video_decoder_release_frame (decoder, frame);
+    return ret;
+  }
+
+  if (priv->parallel_pool == NULL) {
+    priv->parallel_pool =
+        g_thread_pool_new ((GFunc) gst_video_decoder_parallel_func, decoder,
+        priv->max_parallel, FALSE, NULL);
+  }
+
+  job = g_slice_new (ParallelJob);
+  job->decoder = decoder;
+  job->frame = frame;
+  job->ret = GST_FLOW_OK;
+  job->done = FALSE;
+
+  GST_LOG_OBJECT (decoder, "submitting frame %u", frame->system_frame_number);
+
+  g_mutex_lock (&priv->parallel_lock);
+  g_queue_push_tail (&priv->parallel_jobs, job);
+  g_mutex_unlock (&priv->parallel_lock);
+
+  g_thread_pool_push (priv->parallel_pool, job, NULL);
+
+  return gst_video_decoder_parallel_collect (decoder, FALSE);
+}
+
 /* Pass the frame in priv->current_frame through the
  * handle_frame() callback for decoding and passing to gvd_finish_frame(), 
  * or dropping by passing to gvd_drop_frame() */
@@ -3359,7 +3563,8 @@ gst_video_decoder_decode_frame (GstVideoDecoder * decoder,
 
   /* FIXME : This should only have to be checked once (either the subclass has an 
    * implementation, or it doesn't) */
-  g_return_val_if_fail (decoder_class->handle_frame != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (decoder_class->handle_frame != NULL
+      || decoder_class->parallel_decode != NULL, GST_FLOW_ERROR);
 
   frame->distance_from_sync = priv->distance_from_sync;
   priv->distance_from_sync++;
@@ -3402,7 +3607,11 @@ gst_video_decoder_decode_frame (GstVideoDecoder * decoder,
       frame->pts);
 
   /* do something with frame */
-  ret = decoder_class->handle_frame (decoder, frame);
+  if (decoder_class->parallel_decode && (priv->max_parallel > 1
+          || decoder_class->handle_frame == NULL))
+    ret = gst_video_decoder_parallel_submit (decoder, frame);
+  else
+    ret = decoder_class->handle_frame (decoder, frame);
   if (ret != GST_FLOW_OK)
     GST_DEBUG_OBJECT (decoder, "flow error %s", gst_flow_get_name (ret));
 
@@ -3621,6 +3830,11 @@ gst_video_decoder_decide_allocation_default (GstVideoDecoder * decoder,
   config = gst_buffer_pool_get_config (pool);
   gst_buffer_pool_config_set_params (config, outcaps, size, min, max);
   gst_buffer_pool_config_set_allocator (config, allocator, &params);
+  /* use huge pages when the application registered an allocator for them */
+  if (gst_buffer_pool_has_option (pool,
+          GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES))
+    gst_buffer_pool_config_add_option (config,
+        GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES);
 
   if (!gst_buffer_pool_set_config (pool, config)) {
     config = gst_buffer_pool_get_config (pool);
@@ -4135,6 +4349,65 @@ gst_video_decoder_set_needs_format (GstVideoDecoder * dec, gboolean enabled)
   dec->priv->needs_format = enabled;
 }
 
+/**
+ * gst_video_decoder_set_max_parallel_frames:
+ * @dec: a #GstVideoDecoder
+ * @num: maximum number of frames to decode concurrently, or 0 to use
+ *     the number of processors
+ *
+ * Configures frame-parallel decoding for sub-classes that implement
+ * @parallel_decode. Up to @num frames are then decoded at the same time
+ * on worker threads, and their output is pushed in decoding order. Only
+ * enable this when frames don't depend on each other.
+ *
+ * Since: 1.8
+ */
+void
+gst_video_decoder_set_max_parallel_frames (GstVideoDecoder * dec, guint num)
+{
+  GstVideoDecoderPrivate *priv;
+
+  g_return_if_fail (GST_IS_VIDEO_DECODER (dec));
+
+  priv = dec->priv;
+
+  if (num == 0)
+    num = g_get_num_processors ();
+
+  GST_DEBUG_OBJECT (dec, "max parallel frames %u", num);
+
+  GST_VIDEO_DECODER_STREAM_LOCK (dec);
+  /* output what was decoded with the old setting first */
+  if (num < priv->max_parallel)
+    gst_video_decoder_parallel_collect (dec, TRUE);
+  priv->max_parallel = num;
+  if (priv->parallel_pool && num > 1)
+    g_thread_pool_set_max_threads (priv->parallel_pool, num, NULL);
+  GST_VIDEO_DECODER_STREAM_UNLOCK (dec);
+}
+
+/**
+ * gst_video_decoder_get_max_parallel_frames:
+ * @dec: a #GstVideoDecoder
+ *
+ * Returns: the maximum number of frames decoded concurrently.
+ *
+ * Since: 1.8
+ */
+guint
+gst_video_decoder_get_max_parallel_frames (GstVideoDecoder * dec)
+{
+  guint result;
+
+  g_return_val_if_fail (GST_IS_VIDEO_DECODER (dec), 1);
+
+  GST_VIDEO_DECODER_STREAM_LOCK (dec);
+  result = dec->priv->max_parallel;
+  GST_VIDEO_DECODER_STREAM_UNLOCK (dec);
+
+  return result;
+}
+
 /**
  * gst_video_decoder_get_needs_format:
  * @dec: a #GstVideoDecoder
@@ -270,11 +270,22 @@ struct _GstVideoDecoder
  *                  tags and meta with only the "video" tag. subclasses can
  *                  implement this method and return %TRUE if the metadata is to be
  *                  copied. Since 1.6
+ * @parallel_decode: Optional.
+ *                  Decodes a single, independent @frame into its already
+ *                  allocated output buffer. When frame-parallel decoding is
+ *                  enabled with gst_video_decoder_set_max_parallel_frames(),
+ *                  this is called from worker threads without the stream
+ *                  lock held and must not call any base class methods. The
+ *                  base class outputs the frames in decoding order when the
+ *                  function returns #GST_FLOW_OK and drops them otherwise.
+ *                  Until an output state is configured, it is called from
+ *                  the streaming thread with an unallocated output buffer,
+ *                  like @handle_frame. Since 1.8
  *
  * Subclasses can override any of the available virtual methods or not, as
- * needed. At minimum @handle_frame needs to be overridden, and @set_format
- * and likely as well.  If non-packetized input is supported or expected,
- * @parse needs to be overridden as well.
+ * needed. At minimum @handle_frame (or @parallel_decode) needs to be
+ * overridden, and @set_format and likely as well.  If non-packetized input
+ * is supported or expected, @parse needs to be overridden as well.
  */
 struct _GstVideoDecoderClass
 {
@@ -335,8 +346,11 @@ struct _GstVideoDecoderClass
                                    GstVideoCodecFrame *frame,
                                    GstMeta * meta);
 
+  GstFlowReturn (*parallel_decode) (GstVideoDecoder *decoder,
+                                    GstVideoCodecFrame *frame);
+
   /*< private >*/
-  void         *padding[GST_PADDING_LARGE-6];
+  void         *padding[GST_PADDING_LARGE-7];
 };
 
 GType    gst_video_decoder_get_type (void);
@@ -362,6 +376,11 @@ void     gst_video_decoder_set_needs_format (GstVideoDecoder * dec,
 
 gboolean gst_video_decoder_get_needs_format (GstVideoDecoder * dec);
 
+void     gst_video_decoder_set_max_parallel_frames (GstVideoDecoder * dec,
+                                                    guint             num);
+
+guint    gst_video_decoder_get_max_parallel_frames (GstVideoDecoder * dec);
+
 void     gst_video_decoder_set_latency (GstVideoDecoder *decoder,
 					GstClockTime min_latency,
 					GstClockTime max_latency);
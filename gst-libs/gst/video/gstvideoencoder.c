@@ -59,6 +59,12 @@
  *       this to subclass' @handle_frame.
  *     </para></listitem>
  *     <listitem><para>
+ *       If the subclass implements @preprocess_frame and configured a
+ *       lookahead with @gst_video_encoder_set_lookahead, the base class
+ *       first preprocesses up to that many frames concurrently on worker
+ *       threads and then passes them to @handle_frame in order.
+ *     </para></listitem>
+ *     <listitem><para>
  *       If codec processing results in encoded data, subclass should call
  *       @gst_video_encoder_finish_frame to have encoded data pushed
  *       downstream.
@@ -175,8 +181,23 @@ struct _GstVideoEncoderPrivate
   /* adjustment needed on pts, dts, segment start and stop to accomodate
    * min_pts */
   GstClockTime time_adjustment;
+
+  /* parallel preprocessing */
+  guint lookahead;              /* STREAM_LOCK */
+  GThreadPool *preprocess_pool;
+  GMutex preprocess_lock;
+  GCond preprocess_cond;
+  /* PreprocessJob in presentation order, protected with preprocess_lock */
+  GQueue preprocess_jobs;
 };
 
+typedef struct
+{
+  GstVideoCodecFrame *frame;
+  GstFlowReturn ret;
+  gboolean done;
+} PreprocessJob;
+
 typedef struct _ForcedKeyUnitEvent ForcedKeyUnitEvent;
 struct _ForcedKeyUnitEvent
 {
@@ -337,6 +358,180 @@ _flush_events (GstPad * pad, GList * events)
   return NULL;
 }
 
+static void
+gst_video_encoder_preprocess_func (PreprocessJob * job,
+    GstVideoEncoder * encoder)
+{
+  GstVideoEncoderClass *klass = GST_VIDEO_ENCODER_GET_CLASS (encoder);
+  GstVideoEncoderPrivate *priv = encoder->priv;
+  GstFlowReturn ret;
+
+  ret = klass->preprocess_frame (encoder, job->frame);
+
+  g_mutex_lock (&priv->preprocess_lock);
+  job->ret = ret;
+  job->done = TRUE;
+  g_cond_broadcast (&priv->preprocess_cond);
+  g_mutex_unlock (&priv->preprocess_lock);
+}
+
+/* Called with the stream lock held, takes ownership of @frame */
+static GstFlowReturn
+gst_video_encoder_handle_preprocessed (GstVideoEncoder * encoder,
+    GstVideoCodecFrame * frame, GstFlowReturn ret)
+{
+  GstVideoEncoderClass *klass = GST_VIDEO_ENCODER_GET_CLASS (encoder);
+
+  if (ret != GST_FLOW_OK) {
+    GST_DEBUG_OBJECT (encoder, "preprocessing frame %u failed: %s",
+        frame->system_frame_number, gst_flow_get_name (ret));
+    /* drop the frame */
+    gst_video_encoder_finish_frame (encoder, frame);
+    return ret;
+  }
+
+  GST_LOG_OBJECT (encoder, "passing frame pfn %d to subclass",
+      frame->presentation_frame_number);
+
+  return klass->handle_frame (encoder, frame);
+}
+
+/* Passes the preprocessed frames at the head of the queue to the subclass,
+ * waits for all of them when @wait_all is set and otherwise until there is
+ * room for another frame. After an error, the remaining frames are dropped.
+ * Called with the stream lock held. */
+static GstFlowReturn
+gst_video_encoder_preprocess_collect (GstVideoEncoder * encoder,
+    gboolean wait_all)
+{
+  GstVideoEncoderPrivate *priv = encoder->priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+  PreprocessJob *job;
+
+  g_mutex_lock (&priv->preprocess_lock);
+  while ((job = g_queue_peek_head (&priv->preprocess_jobs))) {
+    if (!job->done) {
+      if (ret == GST_FLOW_OK && !wait_all
+          && priv->preprocess_jobs.length < priv->lookahead)
+        break;
+      g_cond_wait (&priv->preprocess_cond, &priv->preprocess_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->preprocess_jobs);
+    g_mutex_unlock (&priv->preprocess_lock);
+
+    if (ret == GST_FLOW_OK) {
+      ret = gst_video_encoder_handle_preprocessed (encoder, job->frame,
+          job->ret);
+    } else {
+      GST_DEBUG_OBJECT (encoder, "dropping preprocessed frame %u",
+          job->frame->system_frame_number);
+      gst_video_encoder_finish_frame (encoder, job->frame);
+    }
+    g_slice_free (PreprocessJob, job);
+
+    g_mutex_lock (&priv->preprocess_lock);
+  }
+  g_mutex_unlock (&priv->preprocess_lock);
+
+  return ret;
+}
+
+/* Waits for the frames being preprocessed and throws them away. Called with
+ * the stream lock held. */
+static void
+gst_video_encoder_preprocess_discard (GstVideoEncoder * encoder)
+{
+  GstVideoEncoderPrivate *priv = encoder->priv;
+  PreprocessJob *job;
+
+  g_mutex_lock (&priv->preprocess_lock);
+  while ((job = g_queue_peek_head (&priv->preprocess_jobs))) {
+    if (!job->done) {
+      g_cond_wait (&priv->preprocess_cond, &priv->preprocess_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->preprocess_jobs);
+    gst_video_codec_frame_unref (job->frame);
+    g_slice_free (PreprocessJob, job);
+  }
+  g_mutex_unlock (&priv->preprocess_lock);
+}
+
+/* Returns the oldest frame that is not queued for or being preprocessed by
+ * the workers. Those are the most recent frames, in the same order as the
+ * frames list, so the first frame of the queue marks the end of the frames
+ * that were handed to the subclass. Called with the stream lock held. */
+static GstVideoCodecFrame *
+gst_video_encoder_oldest_handled_frame (GstVideoEncoder * encoder)
+{
+  GstVideoEncoderPrivate *priv = encoder->priv;
+  GstVideoCodecFrame *first_job_frame = NULL;
+  PreprocessJob *job;
+
+  if (priv->frames == NULL)
+    return NULL;
+
+  g_mutex_lock (&priv->preprocess_lock);
+  if ((job = g_queue_peek_head (&priv->preprocess_jobs)))
+    first_job_frame = job->frame;
+  g_mutex_unlock (&priv->preprocess_lock);
+
+  if (priv->frames->data == first_job_frame)
+    return NULL;
+
+  return priv->frames->data;
+}
+
+static GstFlowReturn
+gst_video_encoder_submit_frame (GstVideoEncoder * encoder,
+    GstVideoCodecFrame * frame)
+{
+  GstVideoEncoderClass *klass = GST_VIDEO_ENCODER_GET_CLASS (encoder);
+  GstVideoEncoderPrivate *priv = encoder->priv;
+  PreprocessJob *job;
+
+  if (klass->preprocess_frame == NULL) {
+    GST_LOG_OBJECT (encoder, "passing frame pfn %d to subclass",
+        frame->presentation_frame_number);
+    return klass->handle_frame (encoder, frame);
+  }
+
+  if (priv->lookahead <= 1) {
+    GstFlowReturn ret;
+
+    ret = gst_video_encoder_preprocess_collect (encoder, TRUE);
+    if (ret != GST_FLOW_OK) {
+      gst_video_encoder_finish_frame (encoder, frame);
+      return ret;
+    }
+    ret = klass->preprocess_frame (encoder, frame);
+    return gst_video_encoder_handle_preprocessed (encoder, frame, ret);
+  }
+
+  if (priv->preprocess_pool == NULL) {
+    priv->preprocess_pool =
+        g_thread_pool_new ((GFunc) gst_video_encoder_preprocess_func, encoder,
+        priv->lookahead, FALSE, NULL);
+  }
+
+  job = g_slice_new (PreprocessJob);
+  job->frame = frame;
+  job->ret = GST_FLOW_OK;
+  job->done = FALSE;
+
+  GST_LOG_OBJECT (encoder, "preprocessing frame pfn %d",
+      frame->presentation_frame_number);
+
+  g_mutex_lock (&priv->preprocess_lock);
+  g_queue_push_tail (&priv->preprocess_jobs, job);
+  g_mutex_unlock (&priv->preprocess_lock);
+
+  g_thread_pool_push (priv->preprocess_pool, job, NULL);
+
+  return gst_video_encoder_preprocess_collect (encoder, FALSE);
+}
+
 static gboolean
 gst_video_encoder_reset (GstVideoEncoder * encoder, gboolean hard)
 {
@@ -345,6 +540,8 @@ gst_video_encoder_reset (GstVideoEncoder * encoder, gboolean hard)
 
   GST_VIDEO_ENCODER_STREAM_LOCK (encoder);
 
+  gst_video_encoder_preprocess_discard (encoder);
+
   priv->presentation_frame_number = 0;
   priv->distance_from_sync = 0;
 
@@ -424,6 +621,9 @@ gst_video_encoder_flush (GstVideoEncoder * encoder)
   gboolean ret = TRUE;
 
   GST_VIDEO_ENCODER_STREAM_LOCK (encoder);
+  /* the workers must be done with the frames before the subclass flushes
+   * the state they use */
+  gst_video_encoder_preprocess_discard (encoder);
   if (klass->flush)
     ret = klass->flush (encoder);
 
@@ -480,6 +680,11 @@ gst_video_encoder_init (GstVideoEncoder * encoder, GstVideoEncoderClass * klass)
   priv->min_pts = GST_CLOCK_TIME_NONE;
   priv->time_adjustment = GST_CLOCK_TIME_NONE;
 
+  priv->lookahead = 1;
+  g_mutex_init (&priv->preprocess_lock);
+  g_cond_init (&priv->preprocess_cond);
+  g_queue_init (&priv->preprocess_jobs);
+
   gst_video_encoder_reset (encoder, TRUE);
 }
 
@@ -653,6 +858,12 @@ gst_video_encoder_setcaps (GstVideoEncoder * encoder, GstCaps * caps)
     goto caps_not_changed;
   }
 
+  /* frames were preprocessed for the previous format */
+  if (gst_video_encoder_preprocess_collect (encoder, TRUE) != GST_FLOW_OK) {
+    gst_video_codec_state_unref (state);
+    goto collect_fail;
+  }
+
   if (encoder_class->reset) {
     GST_FIXME_OBJECT (encoder, "GstVideoEncoder::reset() is deprecated");
     encoder_class->reset (encoder, TRUE);
@@ -689,6 +900,12 @@ parse_fail:
     GST_VIDEO_ENCODER_STREAM_UNLOCK (encoder);
     return FALSE;
   }
+collect_fail:
+  {
+    GST_WARNING_OBJECT (encoder, "Failed to encode pending frames");
+    GST_VIDEO_ENCODER_STREAM_UNLOCK (encoder);
+    return FALSE;
+  }
 }
 
 /**
@@ -879,6 +1096,15 @@ gst_video_encoder_finalize (GObject * object)
   GST_DEBUG_OBJECT (object, "finalize");
 
   encoder = GST_VIDEO_ENCODER (object);
+
+  if (encoder->priv->preprocess_pool) {
+    gst_video_encoder_preprocess_discard (encoder);
+    g_thread_pool_free (encoder->priv->preprocess_pool, FALSE, TRUE);
+    encoder->priv->preprocess_pool = NULL;
+  }
+  g_mutex_clear (&encoder->priv->preprocess_lock);
+  g_cond_clear (&encoder->priv->preprocess_cond);
+
   g_rec_mutex_clear (&encoder->stream_lock);
 
   if (encoder->priv->allocator) {
@@ -999,11 +1225,11 @@ gst_video_encoder_sink_event_default (GstVideoEncoder * encoder,
 
       GST_VIDEO_ENCODER_STREAM_LOCK (encoder);
 
-      if (encoder_class->finish) {
+      /* no draining after the pending frames failed */
+      flow_ret = gst_video_encoder_preprocess_collect (encoder, TRUE);
+
+      if (flow_ret == GST_FLOW_OK && encoder_class->finish)
         flow_ret = encoder_class->finish (encoder);
-      } else {
-        flow_ret = GST_FLOW_OK;
-      }
 
       if (encoder->priv->current_frame_events) {
         GList *l;
@@ -1474,10 +1700,7 @@ gst_video_encoder_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   /* new data, more finish needed */
   priv->drained = FALSE;
 
-  GST_LOG_OBJECT (encoder, "passing frame pfn %d to subclass",
-      frame->presentation_frame_number);
-
-  ret = klass->handle_frame (encoder, frame);
+  ret = gst_video_encoder_submit_frame (encoder, frame);
 
 done:
   GST_VIDEO_ENCODER_STREAM_UNLOCK (encoder);
@@ -2334,7 +2557,8 @@ gst_video_encoder_get_latency (GstVideoEncoder * encoder,
  * gst_video_encoder_get_oldest_frame:
  * @encoder: a #GstVideoEncoder
  *
- * Get the oldest unfinished pending #GstVideoCodecFrame
+ * Get the oldest unfinished pending #GstVideoCodecFrame. Frames that are
+ * still being preprocessed ahead are skipped.
  *
  * Returns: (transfer full): oldest unfinished pending #GstVideoCodecFrame
  */
@@ -2344,8 +2568,10 @@ gst_video_encoder_get_oldest_frame (GstVideoEncoder * encoder)
   GstVideoCodecFrame *frame = NULL;
 
   GST_VIDEO_ENCODER_STREAM_LOCK (encoder);
-  if (encoder->priv->frames)
-    frame = gst_video_codec_frame_ref (encoder->priv->frames->data);
+  /* frames still owned by the preprocessing workers are skipped */
+  frame = gst_video_encoder_oldest_handled_frame (encoder);
+  if (frame)
+    gst_video_codec_frame_ref (frame);
   GST_VIDEO_ENCODER_STREAM_UNLOCK (encoder);
 
   return (GstVideoCodecFrame *) frame;
@@ -2492,3 +2718,63 @@ gst_video_encoder_set_min_pts (GstVideoEncoder * encoder, GstClockTime min_pts)
   encoder->priv->min_pts = min_pts;
   encoder->priv->time_adjustment = GST_CLOCK_TIME_NONE;
 }
+
+/**
+ * gst_video_encoder_set_lookahead:
+ * @encoder: a #GstVideoEncoder
+ * @depth: number of frames to preprocess ahead, or 0 to use the number of
+ *     processors
+ *
+ * Lets sub-classes that implement @preprocess_frame have up to @depth frames
+ * preprocessed concurrently on worker threads, ahead of the frame that is
+ * being encoded in @handle_frame. Frames are still passed to @handle_frame
+ * one at a time and in order. A @depth of 1 preprocesses each frame right
+ * before passing it to @handle_frame.
+ *
+ * Since: 1.8
+ */
+void
+gst_video_encoder_set_lookahead (GstVideoEncoder * encoder, guint depth)
+{
+  GstVideoEncoderPrivate *priv;
+
+  g_return_if_fail (GST_IS_VIDEO_ENCODER (encoder));
+
+  priv = encoder->priv;
+
+  if (depth == 0)
+    depth = g_get_num_processors ();
+
+  GST_DEBUG_OBJECT (encoder, "lookahead %u", depth);
+
+  GST_VIDEO_ENCODER_STREAM_LOCK (encoder);
+  if (depth < priv->lookahead
+      && gst_video_encoder_preprocess_collect (encoder, TRUE) != GST_FLOW_OK)
+    GST_WARNING_OBJECT (encoder, "Failed to encode pending frames");
+  priv->lookahead = depth;
+  if (priv->preprocess_pool && depth > 1)
+    g_thread_pool_set_max_threads (priv->preprocess_pool, depth, NULL);
+  GST_VIDEO_ENCODER_STREAM_UNLOCK (encoder);
+}
+
+/**
+ * gst_video_encoder_get_lookahead:
+ * @encoder: a #GstVideoEncoder
+ *
+ * Returns: the number of frames that are preprocessed ahead.
+ *
+ * Since: 1.8
+ */
+guint
+gst_video_encoder_get_lookahead (GstVideoEncoder * encoder)
+{
+  guint result;
+
+  g_return_val_if_fail (GST_IS_VIDEO_ENCODER (encoder), 1);
+
+  GST_VIDEO_ENCODER_STREAM_LOCK (encoder);
+  result = encoder->priv->lookahead;
+  GST_VIDEO_ENCODER_STREAM_UNLOCK (encoder);
+
+  return result;
+}
@@ -229,6 +229,16 @@ struct _GstVideoEncoder
  *                  tags and meta with only the "video" tag. subclasses can
  *                  implement this method and return %TRUE if the metadata is to be
  *                  copied. Since 1.6
+ * @preprocess_frame: Optional.
+ *                  Performs the per-frame work that doesn't depend on other
+ *                  frames, such as colorspace conversion or motion analysis,
+ *                  and stores the results on @frame, e.g. with
+ *                  gst_video_codec_frame_set_user_data(). When a lookahead is
+ *                  configured with gst_video_encoder_set_lookahead(), this is
+ *                  called from worker threads without the stream lock held
+ *                  and must not call any base class methods. Frames are
+ *                  passed to @handle_frame in order once they are
+ *                  preprocessed. Since 1.8
  *
  * Subclasses can override any of the available virtual methods or not, as
  * needed. At minimum @handle_frame needs to be overridden, and @set_format
@@ -290,8 +300,11 @@ struct _GstVideoEncoderClass
                                    GstVideoCodecFrame *frame,
                                    GstMeta * meta);
 
+  GstFlowReturn (*preprocess_frame) (GstVideoEncoder *encoder,
+                                     GstVideoCodecFrame *frame);
+
   /*< private >*/
-  gpointer       _gst_reserved[GST_PADDING_LARGE-4];
+  gpointer       _gst_reserved[GST_PADDING_LARGE-5];
 };
 
 GType                gst_video_encoder_get_type (void);
@@ -344,6 +357,11 @@ void                 gst_video_encoder_get_allocator (GstVideoEncoder *encoder,
 
 void                 gst_video_encoder_set_min_pts(GstVideoEncoder *encoder, GstClockTime min_pts);
 
+void                 gst_video_encoder_set_lookahead (GstVideoEncoder *encoder,
+                                                      guint depth);
+
+guint                gst_video_encoder_get_lookahead (GstVideoEncoder *encoder);
+
 G_END_DECLS
 
 #endif
@@ -34,6 +34,13 @@ GST_DEBUG_CATEGORY_STATIC (gst_video_pool_debug);
  * Allows configuration of video-specific requirements such as
  * stride alignments or pixel padding, and can also be configured
  * to automatically add #GstVideoMeta to the buffers.
+ *
+ * The pool keeps statistics about its usage that can be retrieved with
+ * gst_video_buffer_pool_get_stats(). When the
+ * #GST_BUFFER_POOL_OPTION_VIDEO_ADAPTIVE_SIZE option is enabled, the pool
+ * grows on demand up to the configured maximum number of buffers and
+ * releases buffers that were not needed for some time, but never goes
+ * below the configured minimum.
  */
 
 /**
@@ -90,6 +97,57 @@ gst_buffer_pool_config_get_video_alignment (GstStructure * config,
       "stride-align3", G_TYPE_UINT, &align->stride_align[3], NULL);
 }
 
+/**
+ * gst_buffer_pool_config_set_video_adaptive_size:
+ * @config: a #GstStructure
+ * @idle_timeout: a #GstClockTime
+ *
+ * Configure the time after which unused buffers are released when the
+ * #GST_BUFFER_POOL_OPTION_VIDEO_ADAPTIVE_SIZE option is enabled on the
+ * bufferpool configuration @config.
+ *
+ * Since: 1.8
+ */
+void
+gst_buffer_pool_config_set_video_adaptive_size (GstStructure * config,
+    GstClockTime idle_timeout)
+{
+  g_return_if_fail (config != NULL);
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (idle_timeout));
+
+  gst_structure_set (config, "idle-timeout", G_TYPE_UINT64, idle_timeout,
+      NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_video_adaptive_size:
+ * @config: a #GstStructure
+ * @idle_timeout: (out): the idle timeout
+ *
+ * Get the idle timeout for adaptive sizing from the bufferpool
+ * configuration @config in @idle_timeout.
+ *
+ * Returns: #TRUE if @config could be parsed correctly.
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_buffer_pool_config_get_video_adaptive_size (GstStructure * config,
+    GstClockTime * idle_timeout)
+{
+  g_return_val_if_fail (config != NULL, FALSE);
+  g_return_val_if_fail (idle_timeout != NULL, FALSE);
+
+  return gst_structure_get (config, "idle-timeout", G_TYPE_UINT64,
+      idle_timeout, NULL);
+}
+
+#define DEFAULT_IDLE_TIMEOUT (1 * GST_SECOND)
+
+/* same as GST_ALLOCATOR_HUGE_PAGE from the allocators library, which we
+ * can't depend on */
+#define HUGE_PAGE_ALLOCATOR_NAME "hugepage"
+
 /* bufferpool */
 struct _GstVideoBufferPoolPrivate
 {
@@ -100,6 +158,27 @@ struct _GstVideoBufferPoolPrivate
   gboolean need_alignment;
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* adaptive sizing */
+  gboolean adaptive;
+  GstClockTime idle_timeout;
+  guint min_buffers;
+  gint64 window_start;
+  guint window_peak;
+  guint prev_window_peak;
+
+  /* statistics, protected with stats_lock */
+  GMutex stats_lock;
+  gboolean starting;
+  guint64 acquired;
+  guint64 allocated;
+  guint64 allocated_on_demand;
+  guint64 freed;
+  guint64 trimmed;
+  guint outstanding;
+  guint peak_outstanding;
+  GstClockTime acquire_time;
+  GstClockTime max_acquire_time;
 };
 
 static void gst_video_buffer_pool_finalize (GObject * object);
@@ -114,7 +193,9 @@ static const gchar **
 video_buffer_pool_get_options (GstBufferPool * pool)
 {
   static const gchar *options[] = { GST_BUFFER_POOL_OPTION_VIDEO_META,
-    GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT, NULL
+    GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT,
+    GST_BUFFER_POOL_OPTION_VIDEO_ADAPTIVE_SIZE,
+    GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES, NULL
   };
   return options;
 }
@@ -163,6 +244,23 @@ video_buffer_pool_set_config (GstBufferPool * pool, GstStructure * config)
   if ((priv->allocator = allocator))
     gst_object_ref (allocator);
 
+  /* only replace the system memory allocator, downstream might have asked
+   * for special memory */
+  if (gst_buffer_pool_config_has_option (config,
+          GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES) && (allocator == NULL
+          || !g_strcmp0 (allocator->mem_type, GST_ALLOCATOR_SYSMEM))) {
+    GstAllocator *hugepage;
+
+    if ((hugepage = gst_allocator_find (HUGE_PAGE_ALLOCATOR_NAME))) {
+      GST_DEBUG_OBJECT (pool, "using huge page allocator %" GST_PTR_FORMAT,
+          hugepage);
+      if (priv->allocator)
+        gst_object_unref (priv->allocator);
+      priv->allocator = hugepage;
+      gst_buffer_pool_config_set_allocator (config, hugepage, &priv->params);
+    }
+  }
+
   /* enable metadata based on config of the pool */
   priv->add_videometa =
       gst_buffer_pool_config_has_option (config,
@@ -194,12 +292,26 @@ video_buffer_pool_set_config (GstBufferPool * pool, GstStructure * config)
           "than the max specified video stride alignment %u, fixing",
           (guint) priv->params.align, max_align);
       priv->params.align = max_align;
-      gst_buffer_pool_config_set_allocator (config, allocator, &priv->params);
+      gst_buffer_pool_config_set_allocator (config, priv->allocator,
+          &priv->params);
     }
   }
   priv->info = info;
   info.size = MAX (size, info.size);
 
+  priv->min_buffers = min_buffers;
+  priv->adaptive = gst_buffer_pool_config_has_option (config,
+      GST_BUFFER_POOL_OPTION_VIDEO_ADAPTIVE_SIZE);
+  if (priv->adaptive) {
+    if (!gst_buffer_pool_config_get_video_adaptive_size (config,
+            &priv->idle_timeout))
+      priv->idle_timeout = DEFAULT_IDLE_TIMEOUT;
+
+    GST_DEBUG_OBJECT (pool, "adaptive size %u-%u, idle timeout %"
+        GST_TIME_FORMAT, min_buffers, max_buffers,
+        GST_TIME_ARGS (priv->idle_timeout));
+  }
+
   gst_buffer_pool_config_set_params (config, caps, info.size, min_buffers,
       max_buffers);
 
@@ -248,6 +360,12 @@ video_buffer_pool_alloc (GstBufferPool * pool, GstBuffer ** buffer,
   if (*buffer == NULL)
     goto no_memory;
 
+  g_mutex_lock (&priv->stats_lock);
+  priv->allocated++;
+  if (!priv->starting)
+    priv->allocated_on_demand++;
+  g_mutex_unlock (&priv->stats_lock);
+
   if (priv->add_videometa) {
     GST_DEBUG_OBJECT (pool, "adding GstVideoMeta");
 
@@ -267,6 +385,173 @@ no_memory:
   }
 }
 
+static gboolean
+video_buffer_pool_start (GstBufferPool * pool)
+{
+  GstVideoBufferPool *vpool = GST_VIDEO_BUFFER_POOL_CAST (pool);
+  GstVideoBufferPoolPrivate *priv = vpool->priv;
+  gboolean res;
+
+  /* buffers allocated while starting are preallocated, not on demand */
+  g_mutex_lock (&priv->stats_lock);
+  priv->starting = TRUE;
+  priv->window_start = g_get_monotonic_time ();
+  priv->window_peak = 0;
+  priv->prev_window_peak = 0;
+  g_mutex_unlock (&priv->stats_lock);
+
+  res = GST_BUFFER_POOL_CLASS (parent_class)->start (pool);
+
+  g_mutex_lock (&priv->stats_lock);
+  priv->starting = FALSE;
+  g_mutex_unlock (&priv->stats_lock);
+
+  return res;
+}
+
+static GstFlowReturn
+video_buffer_pool_acquire (GstBufferPool * pool, GstBuffer ** buffer,
+    GstBufferPoolAcquireParams * params)
+{
+  GstVideoBufferPool *vpool = GST_VIDEO_BUFFER_POOL_CAST (pool);
+  GstVideoBufferPoolPrivate *priv = vpool->priv;
+  GstClockTime start, elapsed;
+  GstFlowReturn ret;
+
+  start = gst_util_get_timestamp ();
+  ret = GST_BUFFER_POOL_CLASS (parent_class)->acquire_buffer (pool, buffer,
+      params);
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (ret == GST_FLOW_OK) {
+    g_mutex_lock (&priv->stats_lock);
+    priv->acquired++;
+    priv->outstanding++;
+    priv->peak_outstanding = MAX (priv->peak_outstanding, priv->outstanding);
+    priv->window_peak = MAX (priv->window_peak, priv->outstanding);
+    priv->acquire_time += elapsed;
+    priv->max_acquire_time = MAX (priv->max_acquire_time, elapsed);
+    g_mutex_unlock (&priv->stats_lock);
+  }
+  return ret;
+}
+
+static void
+video_buffer_pool_release (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstVideoBufferPool *vpool = GST_VIDEO_BUFFER_POOL_CAST (pool);
+  GstVideoBufferPoolPrivate *priv = vpool->priv;
+  gboolean trim = FALSE;
+
+  g_mutex_lock (&priv->stats_lock);
+  if (priv->outstanding > 0)
+    priv->outstanding--;
+
+  if (priv->adaptive) {
+    gint64 now;
+    guint64 live, keep;
+
+    /* track the peak usage over the last two idle periods */
+    now = g_get_monotonic_time ();
+    if (now - priv->window_start >= priv->idle_timeout / GST_USECOND) {
+      priv->window_start = now;
+      priv->prev_window_peak = priv->window_peak;
+      priv->window_peak = priv->outstanding;
+    }
+
+    /* release buffers that were not needed recently, one at a time so that
+     * the pool shrinks gradually */
+    live = priv->allocated - priv->freed;
+    keep = MAX (priv->min_buffers,
+        MAX (priv->window_peak, priv->prev_window_peak));
+    if (live > keep) {
+      priv->trimmed++;
+      trim = TRUE;
+    }
+  }
+  g_mutex_unlock (&priv->stats_lock);
+
+  /* tagged memory makes the base class discard the buffer */
+  if (trim) {
+    GST_LOG_OBJECT (pool, "trimming idle buffer %p", buffer);
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+  }
+
+  GST_BUFFER_POOL_CLASS (parent_class)->release_buffer (pool, buffer);
+}
+
+static void
+video_buffer_pool_free (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstVideoBufferPool *vpool = GST_VIDEO_BUFFER_POOL_CAST (pool);
+  GstVideoBufferPoolPrivate *priv = vpool->priv;
+
+  g_mutex_lock (&priv->stats_lock);
+  priv->freed++;
+  g_mutex_unlock (&priv->stats_lock);
+
+  GST_BUFFER_POOL_CLASS (parent_class)->free_buffer (pool, buffer);
+}
+
+/**
+ * gst_video_buffer_pool_get_stats:
+ * @pool: a #GstVideoBufferPool
+ *
+ * Get the usage statistics of @pool. The returned structure contains the
+ * following fields:
+ *
+ * "acquired" G_TYPE_UINT64: the number of acquired buffers.
+ * "allocated" G_TYPE_UINT64: the number of allocated buffers, including the
+ *   ones preallocated when activating the pool.
+ * "reused" G_TYPE_UINT64: the number of acquired buffers that could be
+ *   taken from the pool without allocating.
+ * "freed" G_TYPE_UINT64: the number of freed buffers.
+ * "trimmed" G_TYPE_UINT64: the number of idle buffers released by adaptive
+ *   sizing.
+ * "outstanding" G_TYPE_UINT: the number of buffers currently acquired.
+ * "peak-outstanding" G_TYPE_UINT: the maximum number of buffers that were
+ *   acquired at the same time.
+ * "average-acquire-time" G_TYPE_UINT64: the average time spent in
+ *   gst_buffer_pool_acquire_buffer().
+ * "max-acquire-time" G_TYPE_UINT64: the maximum time spent in
+ *   gst_buffer_pool_acquire_buffer().
+ *
+ * Returns: (transfer full): a new #GstStructure with the statistics of
+ * @pool. gst_structure_free() after usage.
+ *
+ * Since: 1.8
+ */
+GstStructure *
+gst_video_buffer_pool_get_stats (GstVideoBufferPool * pool)
+{
+  GstVideoBufferPoolPrivate *priv;
+  GstStructure *stats;
+  guint64 reused;
+
+  g_return_val_if_fail (GST_IS_VIDEO_BUFFER_POOL (pool), NULL);
+
+  priv = pool->priv;
+
+  g_mutex_lock (&priv->stats_lock);
+  reused = priv->acquired > priv->allocated_on_demand ?
+      priv->acquired - priv->allocated_on_demand : 0;
+
+  stats = gst_structure_new ("GstVideoBufferPoolStats",
+      "acquired", G_TYPE_UINT64, priv->acquired,
+      "allocated", G_TYPE_UINT64, priv->allocated,
+      "reused", G_TYPE_UINT64, reused,
+      "freed", G_TYPE_UINT64, priv->freed,
+      "trimmed", G_TYPE_UINT64, priv->trimmed,
+      "outstanding", G_TYPE_UINT, priv->outstanding,
+      "peak-outstanding", G_TYPE_UINT, priv->peak_outstanding,
+      "average-acquire-time", G_TYPE_UINT64, priv->acquired ?
+      priv->acquire_time / priv->acquired : (GstClockTime) 0,
+      "max-acquire-time", G_TYPE_UINT64, priv->max_acquire_time, NULL);
+  g_mutex_unlock (&priv->stats_lock);
+
+  return stats;
+}
+
 /**
  * gst_video_buffer_pool_new:
  *
@@ -300,6 +585,10 @@ gst_video_buffer_pool_class_init (GstVideoBufferPoolClass * klass)
   gstbufferpool_class->get_options = video_buffer_pool_get_options;
   gstbufferpool_class->set_config = video_buffer_pool_set_config;
   gstbufferpool_class->alloc_buffer = video_buffer_pool_alloc;
+  gstbufferpool_class->start = video_buffer_pool_start;
+  gstbufferpool_class->acquire_buffer = video_buffer_pool_acquire;
+  gstbufferpool_class->release_buffer = video_buffer_pool_release;
+  gstbufferpool_class->free_buffer = video_buffer_pool_free;
 
   GST_DEBUG_CATEGORY_INIT (gst_video_pool_debug, "videopool", 0,
       "videopool object");
@@ -309,6 +598,7 @@ static void
 gst_video_buffer_pool_init (GstVideoBufferPool * pool)
 {
   pool->priv = GST_VIDEO_BUFFER_POOL_GET_PRIVATE (pool);
+  g_mutex_init (&pool->priv->stats_lock);
 }
 
 static void
@@ -325,5 +615,7 @@ gst_video_buffer_pool_finalize (GObject * object)
   if (priv->allocator)
     gst_object_unref (priv->allocator);
 
+  g_mutex_clear (&priv->stats_lock);
+
   G_OBJECT_CLASS (gst_video_buffer_pool_parent_class)->finalize (object);
 }
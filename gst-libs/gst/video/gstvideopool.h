@@ -45,10 +45,37 @@ G_BEGIN_DECLS
  */
 #define GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT "GstBufferPoolOptionVideoAlignment"
 
+/**
+ * GST_BUFFER_POOL_OPTION_VIDEO_ADAPTIVE_SIZE:
+ *
+ * A bufferpool option to let the pool release buffers that were not used
+ * for some time, down to the configured minimum number of buffers. The idle
+ * time can be configured with gst_buffer_pool_config_set_video_adaptive_size().
+ *
+ * Since: 1.8
+ */
+#define GST_BUFFER_POOL_OPTION_VIDEO_ADAPTIVE_SIZE "GstBufferPoolOptionVideoAdaptiveSize"
+
+/**
+ * GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES:
+ *
+ * A bufferpool option to allocate memory from the allocator registered under
+ * the "hugepage" name (see #GstHugePageAllocator in the allocators library)
+ * instead of the default system memory allocator. The option has no effect
+ * when no such allocator is registered or when the configuration already
+ * contains a non-default allocator.
+ *
+ * Since: 1.8
+ */
+#define GST_BUFFER_POOL_OPTION_VIDEO_HUGE_PAGES "GstBufferPoolOptionVideoHugePages"
+
 /* setting a bufferpool config */
 void             gst_buffer_pool_config_set_video_alignment  (GstStructure *config, GstVideoAlignment *align);
 gboolean         gst_buffer_pool_config_get_video_alignment  (GstStructure *config, GstVideoAlignment *align);
 
+void             gst_buffer_pool_config_set_video_adaptive_size (GstStructure *config, GstClockTime idle_timeout);
+gboolean         gst_buffer_pool_config_get_video_adaptive_size (GstStructure *config, GstClockTime *idle_timeout);
+
 /* video bufferpool */
 typedef struct _GstVideoBufferPool GstVideoBufferPool;
 typedef struct _GstVideoBufferPoolClass GstVideoBufferPoolClass;
@@ -75,6 +102,8 @@ GType             gst_video_buffer_pool_get_type      (void);
 
 GstBufferPool *   gst_video_buffer_pool_new           (void);
 
+GstStructure *    gst_video_buffer_pool_get_stats     (GstVideoBufferPool *pool);
+
 G_END_DECLS
 
 #endif /* __GST_VIDEO_POOL_H__ */
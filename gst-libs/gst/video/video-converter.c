@@ -300,6 +300,7 @@ struct _GstVideoConverter
   GstVideoScaler *fh_scaler[4];
   GstVideoScaler *fv_scaler[4];
   FastConvertFunc fconvert[4];
+  gint ftmp_stride;
 };
 
 typedef gpointer (*GstLineCacheAllocLineFunc) (GstLineCache * cache, gint idx,
@@ -4055,6 +4056,331 @@ is_merge_yuv (GstVideoInfo * info)
   }
 }
 
+/* Fused scale + convert fastpaths.
+ *
+ * These convert between the common YUV 4:2:0 and 4:2:2 layouts while
+ * scaling, without going through the generic unpack/scale/pack line cache
+ * chain. Each output line is produced by vertically and horizontally
+ * scaling the source line(s) of a plane into temporary lines and then
+ * packing the result directly into the destination with the same kernels
+ * that the unscaled fastpaths use. */
+#define FUSED_TMP_LINE(c,i) ((guint8 *)(c)->tmpline + (i) * (c)->ftmp_stride)
+
+/* scale line @out_line of the plane in @src with @src_stride. @tmp is used
+ * for the vertically scaled line when horizontal scaling is needed too.
+ * Returns a pointer to the scaled line, this is @dest or, when no scaling
+ * is needed, the line in @src */
+static guint8 *
+fused_scale_line (GstVideoScaler * h_scaler, GstVideoScaler * v_scaler,
+    GstVideoFormat format, guint8 * src, gint src_stride, guint8 * tmp,
+    guint8 * dest, gint out_line, gint in_width, gint out_width)
+{
+  guint8 *line;
+
+  if (v_scaler) {
+    guint i, in_line, n_taps;
+    gpointer *lines;
+
+    gst_video_scaler_get_coeff (v_scaler, out_line, &in_line, &n_taps);
+    lines = g_alloca (n_taps * sizeof (gpointer));
+    for (i = 0; i < n_taps; i++)
+      lines[i] = src + (in_line + i) * src_stride;
+
+    line = h_scaler ? tmp : dest;
+    gst_video_scaler_vertical (v_scaler, format, lines, line, out_line,
+        in_width);
+  } else {
+    line = src + out_line * src_stride;
+  }
+  if (h_scaler) {
+    gst_video_scaler_horizontal (h_scaler, format, line, dest, 0, out_width);
+    line = dest;
+  }
+  return line;
+}
+
+static void
+fused_weave_uv (guint8 * d, const guint8 * s1, const guint8 * s2, gint width)
+{
+  gint i;
+
+  for (i = 0; i < width; i++) {
+    d[2 * i] = s1[i];
+    d[2 * i + 1] = s2[i];
+  }
+}
+
+static void
+fused_split_uv (guint8 * d1, guint8 * d2, const guint8 * s, gint width)
+{
+  gint i;
+
+  for (i = 0; i < width; i++) {
+    d1[i] = s[2 * i];
+    d2[i] = s[2 * i + 1];
+  }
+}
+
+static void
+convert_scale_I420_NV12 (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  gint i, in_cw, out_cw, out_ch;
+  guint8 *u, *v, *tmp, *tu, *tv;
+  gboolean swap_uv;
+
+  in_cw = GST_VIDEO_FRAME_COMP_WIDTH (src, GST_VIDEO_COMP_U);
+  out_cw = GST_VIDEO_FRAME_COMP_WIDTH (dest, GST_VIDEO_COMP_U);
+  out_ch = GST_VIDEO_FRAME_COMP_HEIGHT (dest, GST_VIDEO_COMP_U);
+  swap_uv = GST_VIDEO_FRAME_COMP_POFFSET (dest, GST_VIDEO_COMP_U) != 0;
+
+  tmp = FUSED_TMP_LINE (convert, 0);
+  tu = FUSED_TMP_LINE (convert, 1);
+  tv = FUSED_TMP_LINE (convert, 2);
+
+  gst_video_scaler_2d (convert->fh_scaler[0], convert->fv_scaler[0],
+      GST_VIDEO_FORMAT_GRAY8, FRAME_GET_Y_LINE (src, 0),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_Y_LINE (dest, 0),
+      FRAME_GET_Y_STRIDE (dest), 0, 0, convert->out_width,
+      convert->out_height);
+
+  for (i = 0; i < out_ch; i++) {
+    u = fused_scale_line (convert->fh_scaler[1], convert->fv_scaler[1],
+        GST_VIDEO_FORMAT_GRAY8, FRAME_GET_U_LINE (src, 0),
+        FRAME_GET_U_STRIDE (src), tmp, tu, i, in_cw, out_cw);
+    v = fused_scale_line (convert->fh_scaler[1], convert->fv_scaler[1],
+        GST_VIDEO_FORMAT_GRAY8, FRAME_GET_V_LINE (src, 0),
+        FRAME_GET_V_STRIDE (src), tmp, tv, i, in_cw, out_cw);
+
+    fused_weave_uv (FRAME_GET_PLANE_LINE (dest, 1, i), swap_uv ? v : u,
+        swap_uv ? u : v, out_cw);
+  }
+}
+
+static void
+convert_scale_NV12_I420 (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  gint i, in_cw, out_cw, out_ch;
+  guint8 *uv, *tmp, *tuv;
+  gboolean swap_uv;
+
+  in_cw = GST_VIDEO_FRAME_COMP_WIDTH (src, GST_VIDEO_COMP_U);
+  out_cw = GST_VIDEO_FRAME_COMP_WIDTH (dest, GST_VIDEO_COMP_U);
+  out_ch = GST_VIDEO_FRAME_COMP_HEIGHT (dest, GST_VIDEO_COMP_U);
+  swap_uv = GST_VIDEO_FRAME_COMP_POFFSET (src, GST_VIDEO_COMP_U) != 0;
+
+  tmp = FUSED_TMP_LINE (convert, 0);
+  tuv = FUSED_TMP_LINE (convert, 1);
+
+  gst_video_scaler_2d (convert->fh_scaler[0], convert->fv_scaler[0],
+      GST_VIDEO_FORMAT_GRAY8, FRAME_GET_Y_LINE (src, 0),
+      FRAME_GET_Y_STRIDE (src), FRAME_GET_Y_LINE (dest, 0),
+      FRAME_GET_Y_STRIDE (dest), 0, 0, convert->out_width,
+      convert->out_height);
+
+  for (i = 0; i < out_ch; i++) {
+    uv = fused_scale_line (convert->fh_scaler[1], convert->fv_scaler[1],
+        GST_VIDEO_FORMAT_NV12, FRAME_GET_PLANE_LINE (src, 1, 0),
+        FRAME_GET_PLANE_STRIDE (src, 1), tmp, tuv, i, in_cw, out_cw);
+
+    if (swap_uv)
+      fused_split_uv (FRAME_GET_V_LINE (dest, i), FRAME_GET_U_LINE (dest, i),
+          uv, out_cw);
+    else
+      fused_split_uv (FRAME_GET_U_LINE (dest, i), FRAME_GET_V_LINE (dest, i),
+          uv, out_cw);
+  }
+}
+
+static void
+convert_scale_YUY2_I420 (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  gint i;
+  gint in_width = convert->in_width;
+  gint out_width = convert->out_width;
+  gint out_height = convert->out_height;
+  GstVideoFormat format = GST_VIDEO_FRAME_FORMAT (src);
+  guint8 *s1, *s2, *d2, *tmp;
+
+  tmp = FUSED_TMP_LINE (convert, 0);
+
+  for (i = 0; i < out_height; i += 2) {
+    s1 = fused_scale_line (convert->fh_scaler[0], convert->fv_scaler[0],
+        format, FRAME_GET_LINE (src, 0), FRAME_GET_STRIDE (src), tmp,
+        FUSED_TMP_LINE (convert, 1), i, in_width, out_width);
+
+    if (i + 1 < out_height) {
+      s2 = fused_scale_line (convert->fh_scaler[0], convert->fv_scaler[0],
+          format, FRAME_GET_LINE (src, 0), FRAME_GET_STRIDE (src), tmp,
+          FUSED_TMP_LINE (convert, 2), i + 1, in_width, out_width);
+      d2 = FRAME_GET_Y_LINE (dest, i + 1);
+    } else {
+      /* odd height, average the last line with itself and write the
+       * second luma line to a scratch line */
+      s2 = s1;
+      d2 = FUSED_TMP_LINE (convert, 3);
+    }
+
+    if (format == GST_VIDEO_FORMAT_UYVY)
+      video_orc_convert_UYVY_I420 (FRAME_GET_Y_LINE (dest, i), d2,
+          FRAME_GET_U_LINE (dest, i >> 1), FRAME_GET_V_LINE (dest, i >> 1),
+          s1, s2, (out_width + 1) / 2);
+    else
+      video_orc_convert_YUY2_I420 (FRAME_GET_Y_LINE (dest, i), d2,
+          FRAME_GET_U_LINE (dest, i >> 1), FRAME_GET_V_LINE (dest, i >> 1),
+          s1, s2, (out_width + 1) / 2);
+  }
+}
+
+static void
+convert_scale_I420_YUY2 (GstVideoConverter * convert,
+    const GstVideoFrame * src, GstVideoFrame * dest)
+{
+  gint i, in_cw, out_cw;
+  gint in_width = convert->in_width;
+  gint out_width = convert->out_width;
+  gint out_height = convert->out_height;
+  GstVideoFormat format = GST_VIDEO_FRAME_FORMAT (dest);
+  guint8 *y1, *y2, *u, *v, *d2, *tmp;
+
+  in_cw = GST_VIDEO_FRAME_COMP_WIDTH (src, GST_VIDEO_COMP_U);
+  out_cw = GST_VIDEO_FRAME_COMP_WIDTH (dest, GST_VIDEO_COMP_U);
+
+  tmp = FUSED_TMP_LINE (convert, 0);
+
+  for (i = 0; i < out_height; i += 2) {
+    y1 = fused_scale_line (convert->fh_scaler[0], convert->fv_scaler[0],
+        GST_VIDEO_FORMAT_GRAY8, FRAME_GET_Y_LINE (src, 0),
+        FRAME_GET_Y_STRIDE (src), tmp, FUSED_TMP_LINE (convert, 1), i,
+        in_width, out_width);
+
+    if (i + 1 < out_height) {
+      y2 = fused_scale_line (convert->fh_scaler[0], convert->fv_scaler[0],
+          GST_VIDEO_FORMAT_GRAY8, FRAME_GET_Y_LINE (src, 0),
+          FRAME_GET_Y_STRIDE (src), tmp, FUSED_TMP_LINE (convert, 2), i + 1,
+          in_width, out_width);
+      d2 = FRAME_GET_LINE (dest, i + 1);
+    } else {
+      /* odd height, write the second line to a scratch line */
+      y2 = y1;
+      d2 = FUSED_TMP_LINE (convert, 2);
+    }
+
+    u = fused_scale_line (convert->fh_scaler[1], convert->fv_scaler[1],
+        GST_VIDEO_FORMAT_GRAY8, FRAME_GET_U_LINE (src, 0),
+        FRAME_GET_U_STRIDE (src), tmp, FUSED_TMP_LINE (convert, 3), i >> 1,
+        in_cw, out_cw);
+    v = fused_scale_line (convert->fh_scaler[1], convert->fv_scaler[1],
+        GST_VIDEO_FORMAT_GRAY8, FRAME_GET_V_LINE (src, 0),
+        FRAME_GET_V_STRIDE (src), tmp, FUSED_TMP_LINE (convert, 4), i >> 1,
+        in_cw, out_cw);
+
+    if (format == GST_VIDEO_FORMAT_UYVY)
+      video_orc_convert_I420_UYVY (FRAME_GET_LINE (dest, i), d2, y1, y2, u, v,
+          (out_width + 1) / 2);
+    else
+      video_orc_convert_I420_YUY2 (FRAME_GET_LINE (dest, i), d2, y1, y2, u, v,
+          (out_width + 1) / 2);
+  }
+}
+
+static gboolean
+is_fused_scale (GstVideoConverter * convert)
+{
+  return convert->convert == convert_scale_I420_NV12 ||
+      convert->convert == convert_scale_NV12_I420 ||
+      convert->convert == convert_scale_YUY2_I420 ||
+      convert->convert == convert_scale_I420_YUY2;
+}
+
+static GstVideoScaler *
+fused_scaler_new (GstVideoConverter * convert, gint method, guint taps,
+    gint in_size, gint out_size)
+{
+  if (in_size == out_size || in_size == 0 || out_size == 0)
+    return NULL;
+
+  return gst_video_scaler_new (method, GST_VIDEO_SCALER_FLAG_NONE, taps,
+      in_size, out_size, convert->config);
+}
+
+static gboolean
+setup_scale_fused (GstVideoConverter * convert)
+{
+  gint method, cr_method, in_width, in_height, out_width, out_height;
+  gint in_cw, in_ch, out_cw, out_ch;
+  guint taps;
+  GstVideoInfo *in_info, *out_info;
+  GstVideoFormat in_format;
+
+  in_info = &convert->in_info;
+  out_info = &convert->out_info;
+  in_format = GST_VIDEO_INFO_FORMAT (in_info);
+
+  method = GET_OPT_RESAMPLER_METHOD (convert);
+  if (method == GST_VIDEO_RESAMPLER_METHOD_NEAREST)
+    cr_method = method;
+  else
+    cr_method = GET_OPT_CHROMA_RESAMPLER_METHOD (convert);
+  taps = GET_OPT_RESAMPLER_TAPS (convert);
+
+  in_width = convert->in_width;
+  in_height = convert->in_height;
+  out_width = convert->out_width;
+  out_height = convert->out_height;
+
+  if (is_merge_yuv (in_info)) {
+    /* packed 4:2:2, luma and chroma are scaled together */
+    if (in_width != out_width) {
+      GstVideoScaler *y_scaler, *uv_scaler;
+
+      y_scaler = gst_video_scaler_new (method, GST_VIDEO_SCALER_FLAG_NONE,
+          taps, in_width, out_width, convert->config);
+      uv_scaler = gst_video_scaler_new (method, GST_VIDEO_SCALER_FLAG_NONE,
+          gst_video_scaler_get_max_taps (y_scaler),
+          GST_VIDEO_INFO_COMP_WIDTH (in_info, GST_VIDEO_COMP_U),
+          GST_VIDEO_INFO_COMP_WIDTH (out_info, GST_VIDEO_COMP_U),
+          convert->config);
+
+      convert->fh_scaler[0] =
+          gst_video_scaler_combine_packed_YUV (y_scaler, uv_scaler,
+          in_format, in_format);
+
+      gst_video_scaler_free (y_scaler);
+      gst_video_scaler_free (uv_scaler);
+    }
+    convert->fv_scaler[0] =
+        fused_scaler_new (convert, method, taps, in_height, out_height);
+  } else {
+    in_cw = GST_VIDEO_INFO_COMP_WIDTH (in_info, GST_VIDEO_COMP_U);
+    in_ch = GST_VIDEO_INFO_COMP_HEIGHT (in_info, GST_VIDEO_COMP_U);
+    out_cw = GST_VIDEO_INFO_COMP_WIDTH (out_info, GST_VIDEO_COMP_U);
+    /* packed 4:2:2 output shares one chroma line between two luma lines */
+    out_ch = (out_height + 1) >> 1;
+
+    convert->fh_scaler[0] =
+        fused_scaler_new (convert, method, taps, in_width, out_width);
+    convert->fv_scaler[0] =
+        fused_scaler_new (convert, method, taps, in_height, out_height);
+    convert->fh_scaler[1] =
+        fused_scaler_new (convert, cr_method, taps, in_cw, out_cw);
+    convert->fv_scaler[1] =
+        fused_scaler_new (convert, cr_method, taps, in_ch, out_ch);
+  }
+
+  GST_DEBUG ("fused scale %dx%d -> %dx%d", in_width, in_height, out_width,
+      out_height);
+
+  /* room for 5 lines of the largest packed 4:2:2 line */
+  convert->ftmp_stride = GST_ROUND_UP_16 ((MAX (in_width, out_width) + 8) * 4);
+  g_free (convert->tmpline);
+  convert->tmpline = g_malloc0 (convert->ftmp_stride * 5);
+
+  return TRUE;
+}
+
 static gboolean
 setup_scale (GstVideoConverter * convert)
 {
@@ -4088,6 +4414,9 @@ setup_scale (GstVideoConverter * convert)
     return TRUE;
   }
 
+  if (is_fused_scale (convert))
+    return setup_scale_fused (convert);
+
   switch (in_format) {
     case GST_VIDEO_FORMAT_RGB15:
     case GST_VIDEO_FORMAT_RGB16:
@@ -4703,6 +5032,42 @@ static const VideoTransform transforms[] = {
       TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
   {GST_VIDEO_FORMAT_GRAY16_BE, GST_VIDEO_FORMAT_GRAY16_BE, TRUE, FALSE, FALSE,
       TRUE, TRUE, FALSE, FALSE, FALSE, 0, 0, convert_scale_planes},
+  /* fused scale + convert */
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_NV12, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_NV12},
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_NV21, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_NV12},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_NV12, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_NV12},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_NV21, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_NV12},
+
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_I420, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_NV12_I420},
+  {GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_YV12, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_NV12_I420},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_I420, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_NV12_I420},
+  {GST_VIDEO_FORMAT_NV21, GST_VIDEO_FORMAT_YV12, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_NV12_I420},
+
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_I420, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_YUY2_I420},
+  {GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_YV12, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_YUY2_I420},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_I420, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_YUY2_I420},
+  {GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_YV12, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_YUY2_I420},
+
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_YUY2, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_YUY2},
+  {GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_UYVY, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_YUY2},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_YUY2, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_YUY2},
+  {GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_UYVY, FALSE, FALSE, FALSE, FALSE,
+      FALSE, FALSE, FALSE, FALSE, 0, 0, convert_scale_I420_YUY2},
 };
 
 static gboolean
@@ -555,6 +555,135 @@ static const AudioConvertPack pack_funcs[] = {
   (AudioConvertPack) MAKE_PACK_FUNC_NAME (s32_be_float),
 };
 
+/* copy between channel planes and interleaved samples, @offsets gives the
+ * start of each plane in @planes or is NULL for planes packed back to back */
+#define MAKE_INTERLEAVE_FUNCS(type)                                     \
+static void                                                             \
+interleave_##type (const guint8 * planes, const gsize * offsets,        \
+    gpointer dst, gint channels, gint samples)                          \
+{                                                                       \
+  gint c, i;                                                            \
+  for (c = 0; c < channels; c++) {                                      \
+    const type *s = (const type *) (planes + (offsets ? offsets[c] :    \
+            c * samples * sizeof (type)));                              \
+    type *d = (type *) dst + c;                                         \
+    for (i = 0; i < samples; i++, d += channels)                        \
+      *d = s[i];                                                        \
+  }                                                                     \
+}                                                                       \
+static void                                                             \
+deinterleave_##type (gconstpointer src, guint8 * planes,                \
+    const gsize * offsets, gint channels, gint samples)                 \
+{                                                                       \
+  gint c, i;                                                            \
+  for (c = 0; c < channels; c++) {                                      \
+    const type *s = (const type *) src + c;                             \
+    type *d = (type *) (planes + (offsets ? offsets[c] :                \
+            c * samples * sizeof (type)));                              \
+    for (i = 0; i < samples; i++, s += channels)                        \
+      d[i] = *s;                                                        \
+  }                                                                     \
+}
+
+MAKE_INTERLEAVE_FUNCS (guint8)
+MAKE_INTERLEAVE_FUNCS (guint16)
+MAKE_INTERLEAVE_FUNCS (guint32)
+MAKE_INTERLEAVE_FUNCS (guint64)
+
+/* for the 24 bit formats */
+static void
+interleave_generic (const guint8 * planes, const gsize * offsets,
+    gpointer dst, gint channels, gint samples, gint bps)
+{
+  gint c, i;
+
+  for (c = 0; c < channels; c++) {
+    const guint8 *s = planes + (offsets ? offsets[c] : c * samples * bps);
+    guint8 *d = (guint8 *) dst + c * bps;
+
+    for (i = 0; i < samples; i++, s += bps, d += channels * bps)
+      memcpy (d, s, bps);
+  }
+}
+
+static void
+deinterleave_generic (gconstpointer src, guint8 * planes,
+    const gsize * offsets, gint channels, gint samples, gint bps)
+{
+  gint c, i;
+
+  for (c = 0; c < channels; c++) {
+    const guint8 *s = (const guint8 *) src + c * bps;
+    guint8 *d = planes + (offsets ? offsets[c] : c * samples * bps);
+
+    for (i = 0; i < samples; i++, s += channels * bps, d += bps)
+      memcpy (d, s, bps);
+  }
+}
+
+static void
+audio_convert_interleave (GstAudioInfo * info, gconstpointer planes,
+    const gsize * offsets, gpointer dst, gint samples)
+{
+  gint channels = GST_AUDIO_INFO_CHANNELS (info);
+
+  switch (GST_AUDIO_INFO_BPS (info)) {
+    case 1:
+      interleave_guint8 (planes, offsets, dst, channels, samples);
+      break;
+    case 2:
+      interleave_guint16 (planes, offsets, dst, channels, samples);
+      break;
+    case 4:
+      interleave_guint32 (planes, offsets, dst, channels, samples);
+      break;
+    case 8:
+      interleave_guint64 (planes, offsets, dst, channels, samples);
+      break;
+    default:
+      interleave_generic (planes, offsets, dst, channels, samples,
+          GST_AUDIO_INFO_BPS (info));
+      break;
+  }
+}
+
+static void
+audio_convert_deinterleave (GstAudioInfo * info, gconstpointer src,
+    gpointer planes, const gsize * offsets, gint samples)
+{
+  gint channels = GST_AUDIO_INFO_CHANNELS (info);
+
+  switch (GST_AUDIO_INFO_BPS (info)) {
+    case 1:
+      deinterleave_guint8 (src, planes, offsets, channels, samples);
+      break;
+    case 2:
+      deinterleave_guint16 (src, planes, offsets, channels, samples);
+      break;
+    case 4:
+      deinterleave_guint32 (src, planes, offsets, channels, samples);
+      break;
+    case 8:
+      deinterleave_guint64 (src, planes, offsets, channels, samples);
+      break;
+    default:
+      deinterleave_generic (src, planes, offsets, channels, samples,
+          GST_AUDIO_INFO_BPS (info));
+      break;
+  }
+}
+
+/* make sure the scratch buffer *buf can hold size bytes */
+static gpointer
+audio_convert_ensure_buffer (gpointer * buf, gint * bufsize, gint size)
+{
+  if (size > *bufsize) {
+    *buf = g_realloc (*buf, size);
+    *bufsize = size;
+  }
+  return *buf;
+}
+
 #define DOUBLE_INTERMEDIATE_FORMAT(ctx)                   \
     ((!GST_AUDIO_FORMAT_INFO_IS_INTEGER (ctx->in.finfo) &&    \
       !GST_AUDIO_FORMAT_INFO_IS_INTEGER (ctx->out.finfo)) ||  \
@@ -677,6 +806,14 @@ audio_convert_prepare_context (AudioConvertCtx * ctx, GstAudioInfo * in,
 
   GST_INFO ("scale in %d, out %d", ctx->in_scale, ctx->out_scale);
 
+  /* when only the layout changes we just (de)interleave the samples */
+  ctx->layout_only = in->finfo == out->finfo && ctx->mix_passthrough &&
+      GST_AUDIO_INFO_LAYOUT (in) != GST_AUDIO_INFO_LAYOUT (out);
+
+  GST_INFO ("layout in %d, out %d, layout only %d",
+      GST_AUDIO_INFO_LAYOUT (in), GST_AUDIO_INFO_LAYOUT (out),
+      ctx->layout_only);
+
   gst_audio_quantize_setup (ctx);
 
   return TRUE;
@@ -702,6 +839,13 @@ audio_convert_clean_context (AudioConvertCtx * ctx)
   g_free (ctx->tmpbuf);
   ctx->tmpbuf = NULL;
   ctx->tmpbufsize = 0;
+  g_free (ctx->in_ilbuf);
+  ctx->in_ilbuf = NULL;
+  ctx->in_ilbufsize = 0;
+  g_free (ctx->out_ilbuf);
+  ctx->out_ilbuf = NULL;
+  ctx->out_ilbufsize = 0;
+  ctx->layout_only = FALSE;
 
   return TRUE;
 }
@@ -720,12 +864,16 @@ audio_convert_get_sizes (AudioConvertCtx * ctx, gint samples, gint * srcsize,
   return TRUE;
 }
 
+/* @in_offsets and @out_offsets give the start of the channel planes of
+ * non-interleaved @src and @dst, when NULL the planes are packed back to
+ * back. */
 gboolean
 audio_convert_convert (AudioConvertCtx * ctx, gpointer src,
-    gpointer dst, gint samples, gboolean src_writable)
+    gpointer dst, gint samples, gboolean src_writable,
+    const gsize * in_offsets, const gsize * out_offsets)
 {
   guint insize, outsize, size;
-  gpointer outbuf, tmpbuf;
+  gpointer outbuf, tmpbuf, planes = NULL;
   guint intemp = 0, outtemp = 0, biggest;
   gint in_width, out_width;
 
@@ -740,6 +888,28 @@ audio_convert_convert (AudioConvertCtx * ctx, gpointer src,
   insize = ctx->in.bpf * samples;
   outsize = ctx->out.bpf * samples;
 
+  if (ctx->layout_only) {
+    if (GST_AUDIO_INFO_LAYOUT (&ctx->in) == GST_AUDIO_LAYOUT_NON_INTERLEAVED)
+      audio_convert_interleave (&ctx->in, src, in_offsets, dst, samples);
+    else
+      audio_convert_deinterleave (&ctx->out, src, dst, out_offsets, samples);
+    return TRUE;
+  }
+
+  /* the conversion functions work on interleaved samples */
+  if (GST_AUDIO_INFO_LAYOUT (&ctx->in) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    outbuf = audio_convert_ensure_buffer (&ctx->in_ilbuf, &ctx->in_ilbufsize,
+        insize);
+    audio_convert_interleave (&ctx->in, src, in_offsets, outbuf, samples);
+    src = outbuf;
+    src_writable = TRUE;
+  }
+  if (GST_AUDIO_INFO_LAYOUT (&ctx->out) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    planes = dst;
+    dst = audio_convert_ensure_buffer (&ctx->out_ilbuf, &ctx->out_ilbufsize,
+        outsize);
+  }
+
   in_width = GST_AUDIO_FORMAT_INFO_WIDTH (ctx->in.finfo);
   out_width = GST_AUDIO_FORMAT_INFO_WIDTH (ctx->out.finfo);
 
@@ -807,5 +977,8 @@ audio_convert_convert (AudioConvertCtx * ctx, gpointer src,
     ctx->pack (src, dst, ctx->out_scale, samples * ctx->out.channels);
   }
 
+  if (planes)
+    audio_convert_deinterleave (&ctx->out, dst, planes, out_offsets, samples);
+
   return TRUE;
 }
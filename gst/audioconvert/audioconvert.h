@@ -122,6 +122,14 @@ struct _AudioConvertCtx
   gpointer tmpbuf;
   gint tmpbufsize;
 
+  /* interleaved copies of non-interleaved input and output */
+  gpointer in_ilbuf;
+  gint in_ilbufsize;
+  gpointer out_ilbuf;
+  gint out_ilbufsize;
+  /* only the sample layout differs between input and output */
+  gboolean layout_only;
+
   gint in_scale;
   gint out_scale;
 
@@ -146,6 +154,7 @@ gboolean audio_convert_get_sizes (AudioConvertCtx * ctx, gint samples,
 gboolean audio_convert_clean_context (AudioConvertCtx * ctx);
 
 gboolean audio_convert_convert (AudioConvertCtx * ctx, gpointer src,
-    gpointer dst, gint samples, gboolean src_writable);
+    gpointer dst, gint samples, gboolean src_writable,
+    const gsize * in_offsets, const gsize * out_offsets);
 
 #endif /* __AUDIO_CONVERT_H__ */
@@ -28,6 +28,9 @@
  * It supports integer to float conversion, width/depth conversion,
  * signedness and endianness conversion and channel transformations
  * (ie. upmixing and downmixing), as well as dithering and noise-shaping.
+ * It also converts between interleaved and non-interleaved sample layouts.
+ * For non-interleaved audio the position of the channel planes is taken from
+ * the #GstAudioMeta on the input buffers, when present.
  *
  * <refsect2>
  * <title>Example launch line</title>
@@ -118,7 +121,7 @@ G_DEFINE_TYPE_WITH_CODE (GstAudioConvert, gst_audio_convert,
 
 #define STATIC_CAPS \
 GST_STATIC_CAPS (GST_AUDIO_CAPS_MAKE (GST_AUDIO_FORMATS_ALL) \
-    ", layout = (string) interleaved")
+    ", layout = (string) { interleaved, non-interleaved }")
 
 static GstStaticPadTemplate gst_audio_convert_src_template =
 GST_STATIC_PAD_TEMPLATE ("src",
@@ -293,7 +296,7 @@ gst_audio_convert_caps_remove_format_info (GstCaps * caps, gboolean channels)
       continue;
 
     st = gst_structure_copy (st);
-    gst_structure_remove_field (st, "format");
+    gst_structure_remove_fields (st, "format", "layout", NULL);
 
     /* Only remove the channels and channel-mask for non-NONE layouts */
     if (gst_structure_get (st, "channel-mask", GST_TYPE_BITMASK, &channel_mask,
@@ -693,6 +696,21 @@ gst_audio_convert_fixate_channels (GstBaseTransform * base, GstStructure * ins,
   }
 }
 
+/* prefer to keep the layout of the input so that we don't shuffle the
+ * samples around needlessly */
+static void
+gst_audio_convert_fixate_layout (GstBaseTransform * base, GstStructure * ins,
+    GstStructure * outs)
+{
+  const gchar *in_layout;
+
+  in_layout = gst_structure_get_string (ins, "layout");
+  if (!in_layout)
+    return;
+
+  gst_structure_fixate_field_string (outs, "layout", in_layout);
+}
+
 /* try to keep as many of the structure members the same by fixating the
  * possible ranges; this way we convert the least amount of things as possible
  */
@@ -737,6 +755,7 @@ gst_audio_convert_fixate_caps (GstBaseTransform * base,
 
   gst_audio_convert_fixate_channels (base, ins, outs);
   gst_audio_convert_fixate_format (base, ins, outs);
+  gst_audio_convert_fixate_layout (base, ins, outs);
 
   /* fixate remaining */
   result = gst_caps_fixate (result);
@@ -795,11 +814,19 @@ gst_audio_convert_transform (GstBaseTransform * base, GstBuffer * inbuf,
   GstMapInfo srcmap, dstmap;
   gint insize, outsize;
   gboolean inbuf_writable;
+  GstAudioMeta *meta;
+  const gsize *in_offsets = NULL;
 
   gint samples;
 
   /* get amount of samples to convert. */
-  samples = gst_buffer_get_size (inbuf) / this->ctx.in.bpf;
+  meta = gst_buffer_get_audio_meta (inbuf);
+  if (meta) {
+    samples = meta->samples;
+    in_offsets = meta->offsets;
+  } else {
+    samples = gst_buffer_get_size (inbuf) / this->ctx.in.bpf;
+  }
 
   /* get in/output sizes, to see if the buffers we got are of correct
    * sizes */
@@ -824,10 +851,15 @@ gst_audio_convert_transform (GstBaseTransform * base, GstBuffer * inbuf,
   if (dstmap.size < outsize)
     goto wrong_size;
 
+  /* tell downstream where the planes are */
+  if (GST_AUDIO_INFO_LAYOUT (&this->ctx.out) ==
+      GST_AUDIO_LAYOUT_NON_INTERLEAVED && !gst_buffer_get_audio_meta (outbuf))
+    gst_buffer_add_audio_meta (outbuf, &this->ctx.out, samples, NULL);
+
   /* and convert the samples */
   if (!GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP)) {
     if (!audio_convert_convert (&this->ctx, srcmap.data, dstmap.data,
-            samples, inbuf_writable))
+            samples, inbuf_writable, in_offsets, NULL))
       goto convert_error;
   } else {
     /* Create silence buffer */
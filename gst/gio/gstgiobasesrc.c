@@ -27,6 +27,11 @@
 
 #include <gst/base/gsttypefindhelper.h>
 
+#ifdef HAVE_MMAP
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (gst_gio_base_src_debug);
 #define GST_CAT_DEFAULT gst_gio_base_src_debug
 
@@ -35,10 +40,28 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+/* how far ahead of the read position the kernel is asked to fault in
+ * pages of a mapped file, and how close to the end of the previous
+ * window we get before issuing the next hint */
+#define READAHEAD_SIZE (1024 * 1024)
+#define READAHEAD_THRESHOLD (256 * 1024)
+
+#define DEFAULT_USE_MMAP FALSE
+
+enum
+{
+  PROP_0,
+  PROP_USE_MMAP
+};
+
 #define gst_gio_base_src_parent_class parent_class
 G_DEFINE_TYPE (GstGioBaseSrc, gst_gio_base_src, GST_TYPE_BASE_SRC);
 
 static void gst_gio_base_src_finalize (GObject * object);
+static void gst_gio_base_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_gio_base_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static gboolean gst_gio_base_src_start (GstBaseSrc * base_src);
 static gboolean gst_gio_base_src_stop (GstBaseSrc * base_src);
@@ -63,6 +86,23 @@ gst_gio_base_src_class_init (GstGioBaseSrcClass * klass)
       "GIO base source");
 
   gobject_class->finalize = gst_gio_base_src_finalize;
+  gobject_class->set_property = gst_gio_base_src_set_property;
+  gobject_class->get_property = gst_gio_base_src_get_property;
+
+  /**
+   * GstGioBaseSrc:use-mmap:
+   *
+   * Memory map local files and push buffers that wrap the mapping instead
+   * of copying the data out of the input stream. Locations that can't be
+   * mapped, e.g. remote ones, are read through the stream as usual. The
+   * file must not be truncated while it is being read in this mode.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Memory map local files instead of reading them", DEFAULT_USE_MMAP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&src_factory));
@@ -83,6 +123,7 @@ static void
 gst_gio_base_src_init (GstGioBaseSrc * src)
 {
   src->cancel = g_cancellable_new ();
+  src->use_mmap = DEFAULT_USE_MMAP;
 }
 
 static void
@@ -105,14 +146,134 @@ gst_gio_base_src_finalize (GObject * object)
     src->cache = NULL;
   }
 
+  if (src->mapped) {
+    g_mapped_file_unref (src->mapped);
+    src->mapped = NULL;
+  }
+
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
 }
 
+static void
+gst_gio_base_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstGioBaseSrc *src = GST_GIO_BASE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_USE_MMAP:
+      GST_OBJECT_LOCK (src);
+      src->use_mmap = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_gio_base_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstGioBaseSrc *src = GST_GIO_BASE_SRC (object);
+
+  switch (prop_id) {
+    case PROP_USE_MMAP:
+      GST_OBJECT_LOCK (src);
+      g_value_set_boolean (value, src->use_mmap);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_gio_base_src_advise (GstGioBaseSrc * src, guint64 offset, guint64 len,
+    gboolean sequential)
+{
+#ifdef HAVE_MMAP
+  gchar *contents = g_mapped_file_get_contents (src->mapped);
+  gsize page_size = 4096;
+  guint64 start;
+
+#ifdef _SC_PAGESIZE
+  page_size = sysconf (_SC_PAGESIZE);
+#endif
+
+  /* madvise() wants a page aligned start address */
+  start = offset - (((guintptr) contents + offset) % page_size);
+  len += offset - start;
+
+#ifdef MADV_SEQUENTIAL
+  if (sequential && madvise (contents, g_mapped_file_get_length (src->mapped),
+          MADV_SEQUENTIAL) != 0)
+    GST_DEBUG_OBJECT (src, "madvise(MADV_SEQUENTIAL) failed");
+#endif
+#ifdef MADV_WILLNEED
+  if (len > 0 && madvise (contents + start, len, MADV_WILLNEED) != 0)
+    GST_DEBUG_OBJECT (src, "madvise(MADV_WILLNEED) failed");
+#endif
+#endif
+}
+
+/* maps the file of the subclass if it has a local path, the stream stays
+ * open to keep the usual query behaviour */
+static void
+gst_gio_base_src_try_mmap (GstGioBaseSrc * src)
+{
+  GstGioBaseSrcClass *gbsrc_class = GST_GIO_BASE_SRC_GET_CLASS (src);
+  GFile *file;
+  gchar *path;
+  GError *err = NULL;
+  gsize length;
+
+  if (gbsrc_class->get_file == NULL)
+    return;
+
+  file = gbsrc_class->get_file (src);
+  if (file == NULL)
+    return;
+
+  path = g_file_get_path (file);
+  g_object_unref (file);
+  if (path == NULL) {
+    GST_DEBUG_OBJECT (src, "not a local file, can't use mmap");
+    return;
+  }
+
+  src->mapped = g_mapped_file_new (path, FALSE, &err);
+  if (src->mapped == NULL) {
+    GST_DEBUG_OBJECT (src, "failed to map %s: %s", path, err->message);
+    g_clear_error (&err);
+    g_free (path);
+    return;
+  }
+
+  length = g_mapped_file_get_length (src->mapped);
+  if (length == 0) {
+    /* empty files have no mapping to hand out */
+    g_mapped_file_unref (src->mapped);
+    src->mapped = NULL;
+    g_free (path);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (src, "mapped %s, %" G_GSIZE_FORMAT " bytes", path, length);
+  g_free (path);
+
+  src->readahead_end = MIN (length, READAHEAD_SIZE);
+  gst_gio_base_src_advise (src, 0, src->readahead_end, TRUE);
+}
+
 static gboolean
 gst_gio_base_src_start (GstBaseSrc * base_src)
 {
   GstGioBaseSrc *src = GST_GIO_BASE_SRC (base_src);
   GstGioBaseSrcClass *gbsrc_class = GST_GIO_BASE_SRC_GET_CLASS (src);
+  gboolean use_mmap;
 
   src->position = 0;
 
@@ -131,6 +292,13 @@ gst_gio_base_src_start (GstBaseSrc * base_src)
   if (G_IS_SEEKABLE (src->stream))
     src->position = g_seekable_tell (G_SEEKABLE (src->stream));
 
+  GST_OBJECT_LOCK (src);
+  use_mmap = src->use_mmap;
+  GST_OBJECT_UNLOCK (src);
+
+  if (use_mmap)
+    gst_gio_base_src_try_mmap (src);
+
   GST_DEBUG_OBJECT (src, "started source");
 
   return TRUE;
@@ -144,6 +312,11 @@ gst_gio_base_src_stop (GstBaseSrc * base_src)
   gboolean success;
   GError *err = NULL;
 
+  if (src->mapped) {
+    g_mapped_file_unref (src->mapped);
+    src->mapped = NULL;
+  }
+
   if (klass->close_on_stop && G_IS_INPUT_STREAM (src->stream)) {
     GST_DEBUG_OBJECT (src, "closing stream");
 
@@ -177,6 +350,12 @@ gst_gio_base_src_get_size (GstBaseSrc * base_src, guint64 * size)
 {
   GstGioBaseSrc *src = GST_GIO_BASE_SRC (base_src);
 
+  if (src->mapped) {
+    *size = g_mapped_file_get_length (src->mapped);
+    GST_DEBUG_OBJECT (src, "mapped size: %" G_GUINT64_FORMAT, *size);
+    return TRUE;
+  }
+
   if (G_IS_FILE_INPUT_STREAM (src->stream)) {
     GFileInfo *info;
     GError *err = NULL;
@@ -260,7 +439,7 @@ gst_gio_base_src_is_seekable (GstBaseSrc * base_src)
   GstGioBaseSrc *src = GST_GIO_BASE_SRC (base_src);
   gboolean seekable;
 
-  seekable = GST_GIO_STREAM_IS_SEEKABLE (src->stream);
+  seekable = src->mapped != NULL || GST_GIO_STREAM_IS_SEEKABLE (src->stream);
 
   GST_DEBUG_OBJECT (src, "can seek: %d", seekable);
 
@@ -292,6 +471,53 @@ gst_gio_base_src_unlock_stop (GstBaseSrc * base_src)
   return TRUE;
 }
 
+static GstFlowReturn
+gst_gio_base_src_create_mapped (GstGioBaseSrc * src, guint64 offset,
+    guint size, GstBuffer ** buf_return)
+{
+  gsize length = g_mapped_file_get_length (src->mapped);
+  GstBuffer *buf;
+  GstMemory *mem;
+
+  if (offset >= length)
+    return GST_FLOW_EOS;
+
+  size = MIN (size, length - offset);
+
+  /* seeked backwards, restart the readahead window from here */
+  if (offset + READAHEAD_SIZE < src->readahead_end)
+    src->readahead_end = offset;
+
+  /* keep the kernel faulting in pages ahead of us so that downstream
+   * doesn't stall on page faults when touching the data */
+  if (offset + size + READAHEAD_THRESHOLD >= src->readahead_end
+      && src->readahead_end < length) {
+    guint64 start = MAX (offset, src->readahead_end);
+    guint64 end = MIN (length, offset + size + READAHEAD_SIZE);
+
+    GST_LOG_OBJECT (src, "readahead %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
+        start, end);
+    gst_gio_base_src_advise (src, start, end - start, FALSE);
+    src->readahead_end = end;
+  }
+
+  GST_LOG_OBJECT (src, "wrapping mapped region: offset %" G_GUINT64_FORMAT
+      " length %u", offset, size);
+
+  mem = gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+      g_mapped_file_get_contents (src->mapped), length, offset, size,
+      g_mapped_file_ref (src->mapped), (GDestroyNotify) g_mapped_file_unref);
+
+  buf = gst_buffer_new ();
+  gst_buffer_append_memory (buf, mem);
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + size;
+
+  *buf_return = buf;
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_gio_base_src_create (GstBaseSrc * base_src, guint64 offset, guint size,
     GstBuffer ** buf_return)
@@ -300,6 +526,9 @@ gst_gio_base_src_create (GstBaseSrc * base_src, guint64 offset, guint size,
   GstBuffer *buf;
   GstFlowReturn ret = GST_FLOW_OK;
 
+  if (src->mapped)
+    return gst_gio_base_src_create_mapped (src, offset, size, buf_return);
+
   g_return_val_if_fail (G_IS_INPUT_STREAM (src->stream), GST_FLOW_ERROR);
 
   /* If we have the requested part in our cache take a subbuffer of that,
@@ -55,6 +55,11 @@ struct _GstGioBaseSrc
   /* < private > */
   GInputStream *stream;
   GstBuffer *cache;
+
+  /* memory mapped local file, used instead of the stream if set */
+  gboolean use_mmap;
+  GMappedFile *mapped;
+  guint64 readahead_end;
 };
 
 struct _GstGioBaseSrcClass 
@@ -62,6 +67,8 @@ struct _GstGioBaseSrcClass
   GstBaseSrcClass parent_class;
 
   GInputStream * (*get_stream) (GstGioBaseSrc *bsrc);
+  /* optional, returns a new reference to the file being read, if any */
+  GFile * (*get_file) (GstGioBaseSrc *bsrc);
   gboolean close_on_stop;
 };
 
@@ -95,6 +95,7 @@ static void gst_gio_src_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
 static GInputStream *gst_gio_src_get_stream (GstGioBaseSrc * bsrc);
+static GFile *gst_gio_src_get_file (GstGioBaseSrc * bsrc);
 
 static gboolean gst_gio_src_query (GstBaseSrc * base_src, GstQuery * query);
 
@@ -134,6 +135,7 @@ gst_gio_src_class_init (GstGioSrcClass * klass)
   gstbasesrc_class->query = GST_DEBUG_FUNCPTR (gst_gio_src_query);
 
   gstgiobasesrc_class->get_stream = GST_DEBUG_FUNCPTR (gst_gio_src_get_stream);
+  gstgiobasesrc_class->get_file = GST_DEBUG_FUNCPTR (gst_gio_src_get_file);
   gstgiobasesrc_class->close_on_stop = TRUE;
 }
 
@@ -345,3 +347,11 @@ gst_gio_src_get_stream (GstGioBaseSrc * bsrc)
 
   return stream;
 }
+
+static GFile *
+gst_gio_src_get_file (GstGioBaseSrc * bsrc)
+{
+  GstGioSrc *src = GST_GIO_SRC (bsrc);
+
+  return src->file ? g_object_ref (src->file) : NULL;
+}
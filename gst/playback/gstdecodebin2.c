@@ -163,10 +163,6 @@ struct _GstDecodeBin
   GstDecodeChain *decode_chain; /* Top level decode chain */
   guint nbpads;                 /* unique identifier for source pads */
 
-  GMutex factories_lock;
-  guint32 factories_cookie;     /* Cookie from last time when factories was updated */
-  GList *factories;             /* factories we can use for selecting elements */
-
   GMutex subtitle_lock;         /* Protects changes to subtitles and encoding */
   GList *subtitles;             /* List of elements with subtitle-encoding,
                                  * protected by above mutex! */
@@ -181,6 +177,10 @@ struct _GstDecodeBin
   GList *blocked_pads;          /* pads that have set to block */
 
   gboolean expose_allstreams;   /* Whether to expose unknow type streams or not */
+  gboolean use_plan_cache;      /* Whether to replay previously autoplugged factories,
+                                 * protected by the object lock */
+  GstElement *autoplug_proxy;   /* element whose autoplug signals our handlers
+                                 * forward to, protected by the object lock */
 
   GList *filtered;              /* elements for which error messages are filtered */
   GList *filtered_errors;       /* filtered error messages */
@@ -253,6 +253,7 @@ enum
 #define DEFAULT_POST_STREAM_TOPOLOGY FALSE
 #define DEFAULT_EXPOSE_ALL_STREAMS  TRUE
 #define DEFAULT_CONNECTION_SPEED    0
+#define DEFAULT_USE_PLAN_CACHE      FALSE
 
 /* Properties */
 enum
@@ -269,7 +270,8 @@ enum
   PROP_MAX_SIZE_TIME,
   PROP_POST_STREAM_TOPOLOGY,
   PROP_EXPOSE_ALL_STREAMS,
-  PROP_CONNECTION_SPEED
+  PROP_CONNECTION_SPEED,
+  PROP_USE_PLAN_CACHE
 };
 
 static GstBinClass *parent_class;
@@ -965,6 +967,38 @@ gst_decode_bin_class_init (GstDecodeBinClass * klass)
           0, G_MAXUINT64 / 1000, DEFAULT_CONNECTION_SPEED,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDecodeBin2::use-plan-cache
+   *
+   * Remember which factory was successfully autoplugged for the caps of a
+   * pad and try that factory first for later pads with the same caps, in
+   * this or any other decodebin. The plan cache is shared by all decodebins
+   * in the process.
+   *
+   * A replayed factory is not obtained from #GstDecodeBin::autoplug-factories
+   * and #GstDecodeBin::autoplug-sort, so these signals are only emitted when
+   * the replayed factory can't be used and decodebin falls back to regular
+   * autoplugging. #GstDecodeBin::autoplug-continue and
+   * #GstDecodeBin::autoplug-select are still emitted.
+   *
+   * Because factories stored by one decodebin could bypass the filtering
+   * of another one, the plan cache is neither used nor updated while
+   * handlers are connected to #GstDecodeBin::autoplug-factories or
+   * #GstDecodeBin::autoplug-sort. Factories chosen after a
+   * #GstDecodeBin::autoplug-select handler skipped others are not stored.
+   * Inside uridecodebin, the handlers connected to the uridecodebin are
+   * checked instead.
+   *
+   * The plan cache is not used when #GstDecodeBin:expose-all-streams is
+   * %FALSE.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_klass, PROP_USE_PLAN_CACHE,
+      g_param_spec_boolean ("use-plan-cache", "Use plan cache",
+          "Replay previously autoplugged factories for streams with the same caps",
+          DEFAULT_USE_PLAN_CACHE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
 
 
   klass->autoplug_continue =
@@ -1022,31 +1056,293 @@ _decode_bin_compare_factories_func (gconstpointer p1, gconstpointer p2)
   return gst_plugin_feature_rank_compare_func (p1, p2);
 }
 
-/* Must be called with factories lock! */
+/* Process-wide index of the decodable element factories by the media types
+ * of their sink pad templates. Autoplugging then only needs to intersect
+ * the caps with the factories that can possibly accept them instead of
+ * with every decodable factory. The index is shared by all decodebins and
+ * rebuilt when the registry feature list cookie changes. */
+static GMutex factory_index_lock;
+static guint32 factory_index_cookie;
+static GList *factory_index_all;        /* all factories, sorted, owns refs */
+static GHashTable *factory_index;       /* media type -> GList of factories */
+static GList *factory_index_any;        /* factories with ANY sink caps */
+
 static void
-gst_decode_bin_update_factories_list (GstDecodeBin * dbin)
+gst_decode_bin_clear_factory_index (void)
 {
-  guint cookie;
+  GHashTableIter iter;
+  gpointer value;
+
+  if (factory_index) {
+    g_hash_table_iter_init (&iter, factory_index);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+      g_list_free (value);
+    g_hash_table_remove_all (factory_index);
+  }
+  g_list_free (factory_index_any);
+  factory_index_any = NULL;
+  gst_plugin_feature_list_free (factory_index_all);
+  factory_index_all = NULL;
+}
+
+/* Must be called with the factory index lock! */
+static void
+gst_decode_bin_update_factory_index (void)
+{
+  GHashTableIter iter;
+  gpointer value;
+  guint32 cookie;
+  GList *l;
 
   cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
-  if (!dbin->factories || dbin->factories_cookie != cookie) {
-    if (dbin->factories)
-      gst_plugin_feature_list_free (dbin->factories);
-    dbin->factories =
-        gst_element_factory_list_get_elements
-        (GST_ELEMENT_FACTORY_TYPE_DECODABLE, GST_RANK_MARGINAL);
-    dbin->factories =
-        g_list_sort (dbin->factories, _decode_bin_compare_factories_func);
-    dbin->factories_cookie = cookie;
+  if (factory_index_all && factory_index_cookie == cookie)
+    return;
+
+  gst_decode_bin_clear_factory_index ();
+  if (!factory_index)
+    factory_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        NULL);
+
+  factory_index_all =
+      gst_element_factory_list_get_elements
+      (GST_ELEMENT_FACTORY_TYPE_DECODABLE, GST_RANK_MARGINAL);
+  factory_index_all =
+      g_list_sort (factory_index_all, _decode_bin_compare_factories_func);
+
+  for (l = factory_index_all; l; l = l->next) {
+    GstElementFactory *factory = GST_ELEMENT_FACTORY_CAST (l->data);
+    const GList *t;
+
+    for (t = gst_element_factory_get_static_pad_templates (factory); t;
+        t = t->next) {
+      GstStaticPadTemplate *templ = t->data;
+      GstCaps *caps;
+      guint i, n;
+
+      if (templ->direction != GST_PAD_SINK)
+        continue;
+
+      caps = gst_static_caps_get (&templ->static_caps);
+      if (gst_caps_is_any (caps)) {
+        if (!factory_index_any || factory_index_any->data != factory)
+          factory_index_any = g_list_prepend (factory_index_any, factory);
+        gst_caps_unref (caps);
+        continue;
+      }
+
+      n = gst_caps_get_size (caps);
+      for (i = 0; i < n; i++) {
+        const gchar *name;
+        GList *list;
+
+        name = gst_structure_get_name (gst_caps_get_structure (caps, i));
+        list = g_hash_table_lookup (factory_index, name);
+
+        /* the factories are visited in order, so the factory can only
+         * already be in the list as its first element */
+        if (list && list->data == factory)
+          continue;
+
+        /* replaces the value and keeps the existing key */
+        g_hash_table_insert (factory_index, g_strdup (name),
+            g_list_prepend (list, factory));
+      }
+      gst_caps_unref (caps);
+    }
   }
+
+  /* the lists were built in reverse */
+  g_hash_table_iter_init (&iter, factory_index);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_hash_table_iter_replace (&iter, g_list_reverse (value));
+  factory_index_any = g_list_reverse (factory_index_any);
+
+  factory_index_cookie = cookie;
+
+  GST_DEBUG ("indexed %u factories by %u media types",
+      g_list_length (factory_index_all), g_hash_table_size (factory_index));
+}
+
+/* Returns the factories that might accept @caps, in autoplugging order. The
+ * list does not hold references to the factories.
+ * Must be called with the factory index lock! */
+static GList *
+gst_decode_bin_lookup_factories (GstCaps * caps)
+{
+  GHashTable *seen;
+  GList *result = NULL, *l;
+  guint i, n;
+
+  if (gst_caps_is_any (caps))
+    return g_list_copy (factory_index_all);
+
+  seen = g_hash_table_new (NULL, NULL);
+  n = gst_caps_get_size (caps);
+  for (i = 0; i <= n; i++) {
+    if (i < n)
+      l = g_hash_table_lookup (factory_index,
+          gst_structure_get_name (gst_caps_get_structure (caps, i)));
+    else
+      l = factory_index_any;
+
+    for (; l; l = l->next) {
+      if (g_hash_table_contains (seen, l->data))
+        continue;
+      g_hash_table_add (seen, l->data);
+      result = g_list_prepend (result, l->data);
+    }
+  }
+  g_hash_table_destroy (seen);
+
+  return g_list_sort (result, _decode_bin_compare_factories_func);
+}
+
+/* Process-wide plan cache, used when the use-plan-cache property is set. It
+ * maps the caps of a pad to the factory that was last autoplugged for them.
+ * Like the factory index it is dropped when the registry feature list
+ * cookie changes. */
+#define PLAN_CACHE_MAX_SIZE 256
+
+static GMutex plan_cache_lock;
+static guint32 plan_cache_cookie;
+static GHashTable *plan_cache;  /* caps string -> GstElementFactory */
+
+static gboolean
+plan_cache_filter_field (GQuark field_id, GValue * value, gpointer user_data)
+{
+  /* codec data and stream headers differ between otherwise identical
+   * streams, the replayed factory still has to accept the full caps */
+  if (GST_VALUE_HOLDS_BUFFER (value))
+    return FALSE;
+  if (GST_VALUE_HOLDS_ARRAY (value) && gst_value_array_get_size (value) > 0
+      && GST_VALUE_HOLDS_BUFFER (gst_value_array_get_value (value, 0)))
+    return FALSE;
+
+  return TRUE;
 }
 
+static gchar *
+gst_decode_bin_plan_cache_key (GstCaps * caps)
+{
+  GstCaps *copy;
+  gchar *key;
+  guint i, n;
+
+  copy = gst_caps_copy (caps);
+  n = gst_caps_get_size (copy);
+  for (i = 0; i < n; i++)
+    gst_structure_filter_and_map_in_place (gst_caps_get_structure (copy, i),
+        plan_cache_filter_field, NULL);
+  key = gst_caps_to_string (copy);
+  gst_caps_unref (copy);
+
+  return key;
+}
+
+/* Must be called with the plan cache lock! */
 static void
-gst_decode_bin_init (GstDecodeBin * decode_bin)
+gst_decode_bin_plan_cache_validate (void)
+{
+  guint32 cookie;
+
+  cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
+  if (!plan_cache)
+    plan_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        gst_object_unref);
+  else if (plan_cache_cookie != cookie)
+    g_hash_table_remove_all (plan_cache);
+  plan_cache_cookie = cookie;
+}
+
+/* Returns the factory that was last autoplugged for @caps, or %NULL */
+static GstElementFactory *
+gst_decode_bin_plan_cache_lookup (GstCaps * caps)
 {
-  /* first filter out the interesting element factories */
-  g_mutex_init (&decode_bin->factories_lock);
+  GstElementFactory *factory;
+  gchar *key;
+
+  key = gst_decode_bin_plan_cache_key (caps);
+  g_mutex_lock (&plan_cache_lock);
+  gst_decode_bin_plan_cache_validate ();
+  factory = g_hash_table_lookup (plan_cache, key);
+  if (factory)
+    gst_object_ref (factory);
+  g_mutex_unlock (&plan_cache_lock);
+  g_free (key);
+
+  return factory;
+}
+
+static void
+gst_decode_bin_plan_cache_store (GstCaps * caps, GstElementFactory * factory)
+{
+  gchar *key;
+
+  key = gst_decode_bin_plan_cache_key (caps);
+  g_mutex_lock (&plan_cache_lock);
+  gst_decode_bin_plan_cache_validate ();
+  /* don't grow without bounds if every stream has different caps */
+  if (g_hash_table_size (plan_cache) >= PLAN_CACHE_MAX_SIZE
+      && !g_hash_table_lookup (plan_cache, key))
+    g_hash_table_remove_all (plan_cache);
+  g_hash_table_insert (plan_cache, key, gst_object_ref (factory));
+  g_mutex_unlock (&plan_cache_lock);
+}
+
+static gboolean
+has_handler_pending (GstElement * element, const gchar * name)
+{
+  guint signal_id = g_signal_lookup (name, G_OBJECT_TYPE (element));
 
+  return signal_id != 0
+      && g_signal_has_handler_pending (element, signal_id, 0, FALSE);
+}
+
+/* The cache is shared between decodebins, so it can only be used when the
+ * factory list is not customized by signal handlers. When our handlers only
+ * forward the signals of a uridecodebin, its handlers are checked instead */
+static gboolean
+gst_decode_bin_plan_cache_usable (GstDecodeBin * dbin)
+{
+  GstElement *element;
+  gboolean usable;
+
+  GST_OBJECT_LOCK (dbin);
+  if (!dbin->use_plan_cache) {
+    GST_OBJECT_UNLOCK (dbin);
+    return FALSE;
+  }
+  if (dbin->autoplug_proxy)
+    element = gst_object_ref (dbin->autoplug_proxy);
+  else
+    element = gst_object_ref (dbin);
+  GST_OBJECT_UNLOCK (dbin);
+
+  usable = !has_handler_pending (element, "autoplug-factories")
+      && !has_handler_pending (element, "autoplug-sort");
+  if (!usable)
+    GST_LOG_OBJECT (dbin, "autoplug handlers connected to %s, not using "
+        "plan cache", GST_OBJECT_NAME (element));
+  gst_object_unref (element);
+
+  return usable;
+}
+
+/* Called by uridecodebin, which forwards the autoplug signals of @decodebin
+ * to its own. @proxy must outlive @decodebin. */
+void
+gst_decode_bin_set_autoplug_proxy (GstElement * decodebin, GstElement * proxy)
+{
+  GstDecodeBin *dbin = GST_DECODE_BIN (decodebin);
+
+  GST_OBJECT_LOCK (dbin);
+  dbin->autoplug_proxy = proxy;
+  GST_OBJECT_UNLOCK (dbin);
+}
+
+static void
+gst_decode_bin_init (GstDecodeBin * decode_bin)
+{
   /* we create the typefind element only once */
   decode_bin->typefind = gst_element_factory_make ("typefind", "typefind");
   if (!decode_bin->typefind) {
@@ -1099,6 +1395,7 @@ gst_decode_bin_init (GstDecodeBin * decode_bin)
 
   decode_bin->expose_allstreams = DEFAULT_EXPOSE_ALL_STREAMS;
   decode_bin->connection_speed = DEFAULT_CONNECTION_SPEED;
+  decode_bin->use_plan_cache = DEFAULT_USE_PLAN_CACHE;
 }
 
 static void
@@ -1108,10 +1405,6 @@ gst_decode_bin_dispose (GObject * object)
 
   decode_bin = GST_DECODE_BIN (object);
 
-  if (decode_bin->factories)
-    gst_plugin_feature_list_free (decode_bin->factories);
-  decode_bin->factories = NULL;
-
   if (decode_bin->decode_chain)
     gst_decode_chain_free (decode_bin->decode_chain);
   decode_bin->decode_chain = NULL;
@@ -1139,7 +1432,6 @@ gst_decode_bin_finalize (GObject * object)
   g_mutex_clear (&decode_bin->expose_lock);
   g_mutex_clear (&decode_bin->dyn_lock);
   g_mutex_clear (&decode_bin->subtitle_lock);
-  g_mutex_clear (&decode_bin->factories_lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -1284,6 +1576,11 @@ gst_decode_bin_set_property (GObject * object, guint prop_id,
       dbin->connection_speed = g_value_get_uint64 (value) * 1000;
       GST_OBJECT_UNLOCK (dbin);
       break;
+    case PROP_USE_PLAN_CACHE:
+      GST_OBJECT_LOCK (dbin);
+      dbin->use_plan_cache = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (dbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1336,6 +1633,11 @@ gst_decode_bin_get_property (GObject * object, guint prop_id,
       g_value_set_uint64 (value, dbin->connection_speed / 1000);
       GST_OBJECT_UNLOCK (dbin);
       break;
+    case PROP_USE_PLAN_CACHE:
+      GST_OBJECT_LOCK (dbin);
+      g_value_set_boolean (value, dbin->use_plan_cache);
+      GST_OBJECT_UNLOCK (dbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1360,19 +1662,20 @@ static GValueArray *
 gst_decode_bin_autoplug_factories (GstElement * element, GstPad * pad,
     GstCaps * caps)
 {
-  GList *list, *tmp;
+  GList *list, *tmp, *candidates;
   GValueArray *result;
-  GstDecodeBin *dbin = GST_DECODE_BIN_CAST (element);
 
   GST_DEBUG_OBJECT (element, "finding factories");
 
   /* return all compatible factories for caps */
-  g_mutex_lock (&dbin->factories_lock);
-  gst_decode_bin_update_factories_list (dbin);
+  g_mutex_lock (&factory_index_lock);
+  gst_decode_bin_update_factory_index ();
+  candidates = gst_decode_bin_lookup_factories (caps);
   list =
-      gst_element_factory_list_filter (dbin->factories, caps, GST_PAD_SINK,
+      gst_element_factory_list_filter (candidates, caps, GST_PAD_SINK,
       gst_caps_is_fixed (caps));
-  g_mutex_unlock (&dbin->factories_lock);
+  g_mutex_unlock (&factory_index_lock);
+  g_list_free (candidates);
 
   result = g_value_array_new (g_list_length (list));
   for (tmp = list; tmp; tmp = tmp->next) {
@@ -1426,7 +1729,7 @@ static gboolean is_adaptive_demuxer_element (GstElement * srcelement);
 
 static gboolean connect_pad (GstDecodeBin * dbin, GstElement * src,
     GstDecodePad * dpad, GstPad * pad, GstCaps * caps, GValueArray * factories,
-    GstDecodeChain * chain, gchar ** deadend_details);
+    gboolean planned, GstDecodeChain * chain, gchar ** deadend_details);
 static GList *connect_element (GstDecodeBin * dbin, GstDecodeElement * delem,
     GstDecodeChain * chain);
 static void expose_pad (GstDecodeBin * dbin, GstElement * src,
@@ -1491,9 +1794,10 @@ analyze_new_pad (GstDecodeBin * dbin, GstElement * src, GstPad * pad,
   gboolean apcontinue = TRUE;
   GValueArray *factories = NULL, *result = NULL;
   GstDecodePad *dpad;
-  GstElementFactory *factory;
+  GstElementFactory *factory, *plan_factory;
   const gchar *classification;
   gboolean is_parser_converter = FALSE;
+  gboolean planned = FALSE;
   gboolean res;
   gchar *deadend_details = NULL;
 
@@ -1601,7 +1905,27 @@ analyze_new_pad (GstDecodeBin * dbin, GstElement * src, GstPad * pad,
     }
   }
 
-  /* 1.d else get the factories and if there's no compatible factory goto
+  /* 1.d if we autoplugged these caps before, replay that factory without
+   * collecting and sorting all compatible factories. connect_pad() falls
+   * back to the full list if it can't be used */
+  if (dbin->expose_allstreams && !is_parser_converter
+      && gst_decode_bin_plan_cache_usable (dbin)
+      && (plan_factory = gst_decode_bin_plan_cache_lookup (caps))) {
+    GValue val = { 0, };
+
+    GST_DEBUG_OBJECT (dbin, "replaying factory %s",
+        gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (plan_factory)));
+
+    factories = g_value_array_new (1);
+    g_value_init (&val, G_TYPE_OBJECT);
+    g_value_take_object (&val, plan_factory);
+    g_value_array_append (factories, &val);
+    g_value_unset (&val);
+    planned = TRUE;
+    goto try_factories;
+  }
+
+  /* 1.e else get the factories and if there's no compatible factory goto
    * unknown_type */
   g_signal_emit (G_OBJECT (dbin),
       gst_decode_bin_signals[SIGNAL_AUTOPLUG_FACTORIES], 0, dpad, caps,
@@ -1632,7 +1956,7 @@ analyze_new_pad (GstDecodeBin * dbin, GstElement * src, GstPad * pad,
     goto unknown_type;
   }
 
-  /* 1.e sort some more. */
+  /* 1.f sort some more. */
   g_signal_emit (G_OBJECT (dbin),
       gst_decode_bin_signals[SIGNAL_AUTOPLUG_SORT], 0, dpad, caps, factories,
       &result);
@@ -1650,7 +1974,7 @@ analyze_new_pad (GstDecodeBin * dbin, GstElement * src, GstPad * pad,
 
     GST_DEBUG ("Checking if we can abort early");
 
-    /* 1.f Do an early check to see if the candidates are potential decoders, but
+    /* 1.g Do an early check to see if the candidates are potential decoders, but
      * due to the fact that they decode to a mediatype that is not final we don't
      * need them */
 
@@ -1697,7 +2021,7 @@ analyze_new_pad (GstDecodeBin * dbin, GstElement * src, GstPad * pad,
     }
   }
 
-  /* 1.g now get the factory template caps and insert the capsfilter if this
+  /* 1.h now get the factory template caps and insert the capsfilter if this
    * is a parser/converter
    */
   if (is_parser_converter) {
@@ -1767,10 +2091,11 @@ analyze_new_pad (GstDecodeBin * dbin, GstElement * src, GstPad * pad,
     }
   }
 
-  /* 1.h else continue autoplugging something from the list. */
+try_factories:
+  /* 1.i else continue autoplugging something from the list. */
   GST_LOG_OBJECT (pad, "Let's continue discovery on this pad");
   res =
-      connect_pad (dbin, src, dpad, pad, caps, factories, chain,
+      connect_pad (dbin, src, dpad, pad, caps, factories, planned, chain,
       &deadend_details);
 
   /* Need to unref the capsfilter srcpad here if
@@ -2078,16 +2403,23 @@ demuxer_source_pad_probe (GstPad * pad, GstPadProbeInfo * info,
 static gboolean
 connect_pad (GstDecodeBin * dbin, GstElement * src, GstDecodePad * dpad,
     GstPad * pad, GstCaps * caps, GValueArray * factories,
-    GstDecodeChain * chain, gchar ** deadend_details)
+    gboolean planned, GstDecodeChain * chain, gchar ** deadend_details)
 {
   gboolean res = FALSE;
   GstPad *mqpad = NULL;
   gboolean is_demuxer = chain->parent && !chain->elements;      /* First pad after the demuxer */
   GString *error_details = NULL;
+  GstElementFactory *planned_factory = NULL;
+  gboolean select_skipped = FALSE;
 
   g_return_val_if_fail (factories != NULL, FALSE);
   g_return_val_if_fail (factories->n_values > 0, FALSE);
 
+  /* only used for comparing, the registry keeps the factory alive */
+  if (planned)
+    planned_factory =
+        g_value_get_object (g_value_array_get_nth (factories, 0));
+
   GST_DEBUG_OBJECT (dbin,
       "pad %s:%s , chain:%p, %d factories, caps %" GST_PTR_FORMAT,
       GST_DEBUG_PAD_NAME (pad), chain, factories->n_values, caps);
@@ -2113,7 +2445,7 @@ connect_pad (GstDecodeBin * dbin, GstElement * src, GstDecodePad * dpad,
   error_details = g_string_new ("");
 
   /* 2. Try to create an element and link to it */
-  while (factories->n_values > 0) {
+  while (factories->n_values > 0 || planned) {
     GstAutoplugSelectResult ret;
     GstElementFactory *factory;
     GstDecodeElement *delem;
@@ -2124,6 +2456,51 @@ connect_pad (GstDecodeBin * dbin, GstElement * src, GstDecodePad * dpad,
     GList *to_connect = NULL;
     gboolean is_parser_converter = FALSE, is_simple_demuxer = FALSE;
 
+    /* The factory from the plan cache could not be used, fall back to
+     * all compatible factories */
+    if (factories->n_values == 0) {
+      GValueArray *all = NULL, *result = NULL;
+      guint i;
+
+      planned = FALSE;
+      decode_pad_set_target (dpad, pad);
+
+      GST_DEBUG_OBJECT (dbin, "planned factory failed, trying all factories");
+      g_signal_emit (G_OBJECT (dbin),
+          gst_decode_bin_signals[SIGNAL_AUTOPLUG_FACTORIES], 0, dpad, caps,
+          &all);
+
+      /* NULL means that we can expose the pad */
+      if (all == NULL) {
+        expose_pad (dbin, src, dpad, pad, caps, chain);
+        res = TRUE;
+        goto beach;
+      }
+
+      if (all->n_values > 0) {
+        g_signal_emit (G_OBJECT (dbin),
+            gst_decode_bin_signals[SIGNAL_AUTOPLUG_SORT], 0, dpad, caps, all,
+            &result);
+        if (result) {
+          g_value_array_free (all);
+          all = result;
+        }
+      }
+
+      /* the caller owns the array, so refill it without the factory that
+       * was already tried */
+      for (i = 0; i < all->n_values; i++) {
+        GValue *val = g_value_array_get_nth (all, i);
+
+        if (g_value_get_object (val) != planned_factory)
+          g_value_array_append (factories, val);
+      }
+      g_value_array_free (all);
+
+      if (factories->n_values == 0)
+        break;
+    }
+
     /* Set dpad target to pad again, it might've been unset
      * below but we came back here because something failed
      */
@@ -2242,6 +2619,7 @@ connect_pad (GstDecodeBin * dbin, GstElement * src, GstDecodePad * dpad,
         goto beach;
       case GST_AUTOPLUG_SELECT_SKIP:
         GST_DEBUG_OBJECT (dbin, "autoplug select requested skip");
+        select_skipped = TRUE;
         continue;
       default:
         GST_WARNING_OBJECT (dbin, "autoplug select returned unhandled %d", ret);
@@ -2590,6 +2968,12 @@ connect_pad (GstDecodeBin * dbin, GstElement * src, GstDecodePad * dpad,
       to_connect = NULL;
     }
 
+    /* a factory that was only chosen because the application skipped
+     * others is not a good plan for other decodebins */
+    if (factory != planned_factory && !select_skipped
+        && gst_decode_bin_plan_cache_usable (dbin))
+      gst_decode_bin_plan_cache_store (caps, factory);
+
     res = TRUE;
     break;
   }
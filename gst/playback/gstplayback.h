@@ -29,5 +29,8 @@ gboolean gst_uri_decode_bin_plugin_init (GstPlugin * plugin);
 gboolean gst_play_bin_plugin_init (GstPlugin * plugin);
 gboolean gst_play_bin2_plugin_init (GstPlugin * plugin);
 
+void gst_decode_bin_set_autoplug_proxy (GstElement * decodebin,
+    GstElement * proxy);
+
 
 #endif /* __GST_PLAY_BACK_H__ */
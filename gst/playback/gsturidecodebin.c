@@ -117,6 +117,8 @@ struct _GstURIDecodeBin
   gboolean expose_allstreams;   /* Whether to expose unknow type streams or not */
 
   guint64 ring_buffer_max_size; /* 0 means disabled */
+
+  gboolean use_plan_cache;      /* propagated to the decodebins */
 };
 
 struct _GstURIDecodeBinClass
@@ -183,6 +185,7 @@ enum
 #define DEFAULT_USE_BUFFERING       FALSE
 #define DEFAULT_EXPOSE_ALL_STREAMS  TRUE
 #define DEFAULT_RING_BUFFER_MAX_SIZE 0
+#define DEFAULT_USE_PLAN_CACHE      FALSE
 
 enum
 {
@@ -197,7 +200,8 @@ enum
   PROP_DOWNLOAD,
   PROP_USE_BUFFERING,
   PROP_EXPOSE_ALL_STREAMS,
-  PROP_RING_BUFFER_MAX_SIZE
+  PROP_RING_BUFFER_MAX_SIZE,
+  PROP_USE_PLAN_CACHE
 };
 
 static guint gst_uri_decode_bin_signals[LAST_SIGNAL] = { 0 };
@@ -497,6 +501,20 @@ gst_uri_decode_bin_class_init (GstURIDecodeBinClass * klass)
           0, G_MAXUINT, DEFAULT_RING_BUFFER_MAX_SIZE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstURIDecodeBin::use-plan-cache
+   *
+   * Set the use-plan-cache property on the decodebins. Handlers connected
+   * to the autoplug-factories and autoplug-sort signals of the uridecodebin
+   * disable the plan cache, like they do on decodebin.
+   *
+   * Since: 1.8
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_PLAN_CACHE,
+      g_param_spec_boolean ("use-plan-cache", "Use plan cache",
+          "Replay previously autoplugged factories for streams with the same caps",
+          DEFAULT_USE_PLAN_CACHE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstURIDecodeBin::unknown-type:
    * @bin: The uridecodebin.
@@ -741,6 +759,7 @@ gst_uri_decode_bin_init (GstURIDecodeBin * dec)
   dec->use_buffering = DEFAULT_USE_BUFFERING;
   dec->expose_allstreams = DEFAULT_EXPOSE_ALL_STREAMS;
   dec->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
+  dec->use_plan_cache = DEFAULT_USE_PLAN_CACHE;
 
   GST_OBJECT_FLAG_SET (dec, GST_ELEMENT_FLAG_SOURCE);
 }
@@ -831,6 +850,11 @@ gst_uri_decode_bin_set_property (GObject * object, guint prop_id,
     case PROP_RING_BUFFER_MAX_SIZE:
       dec->ring_buffer_max_size = g_value_get_uint64 (value);
       break;
+    case PROP_USE_PLAN_CACHE:
+      GST_OBJECT_LOCK (dec);
+      dec->use_plan_cache = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (dec);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -891,6 +915,11 @@ gst_uri_decode_bin_get_property (GObject * object, guint prop_id,
     case PROP_RING_BUFFER_MAX_SIZE:
       g_value_set_uint64 (value, dec->ring_buffer_max_size);
       break;
+    case PROP_USE_PLAN_CACHE:
+      GST_OBJECT_LOCK (dec);
+      g_value_set_boolean (value, dec->use_plan_cache);
+      GST_OBJECT_UNLOCK (dec);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1786,6 +1815,7 @@ static GstElement *
 make_decoder (GstURIDecodeBin * decoder)
 {
   GstElement *decodebin;
+  gboolean use_plan_cache;
 
   /* re-use pending decodebin */
   if (decoder->pending_decodebins) {
@@ -1822,6 +1852,8 @@ make_decoder (GstURIDecodeBin * decoder)
         G_CALLBACK (proxy_autoplug_query_signal), decoder);
     g_signal_connect (decodebin, "drained",
         G_CALLBACK (proxy_drained_signal), decoder);
+    /* the handlers above don't customize anything themselves */
+    gst_decode_bin_set_autoplug_proxy (decodebin, GST_ELEMENT_CAST (decoder));
 
     /* set up callbacks to create the links between decoded data
      * and video/audio/subtitle rendering/output. */
@@ -1839,9 +1871,14 @@ make_decoder (GstURIDecodeBin * decoder)
   if (decoder->caps)
     g_object_set (decodebin, "caps", decoder->caps, NULL);
 
-  /* Propagate expose-all-streams and connection-speed properties */
+  /* Propagate expose-all-streams, connection-speed and use-plan-cache
+   * properties */
+  GST_OBJECT_LOCK (decoder);
+  use_plan_cache = decoder->use_plan_cache;
+  GST_OBJECT_UNLOCK (decoder);
   g_object_set (decodebin, "expose-all-streams", decoder->expose_allstreams,
-      "connection-speed", decoder->connection_speed / 1000, NULL);
+      "connection-speed", decoder->connection_speed / 1000,
+      "use-plan-cache", use_plan_cache, NULL);
 
   if (!decoder->is_stream || decoder->is_adaptive) {
     /* propagate the use-buffering property but only when we are not already
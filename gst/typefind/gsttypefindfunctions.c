@@ -118,6 +118,138 @@ data_scan_ctx_memcmp (GstTypeFind * tf, DataScanCtx * c, guint offset,
   return (memcmp (c->data + offset, data, len) == 0);
 }
 
+/* Sync word scanning: helpers for typefind functions that look for a sync
+ * pattern, to skip over the data between the candidates with memchr(),
+ * which is vectorized by the C library, instead of testing each and every
+ * offset */
+
+/* Returns the first position in the @size bytes of @data where the @len
+ * bytes of the pattern fit and equal @pattern after masking with @mask, or
+ * %NULL. The first byte of the pattern is always compared unmasked. */
+static inline const guint8 *
+scan_for_sync (const guint8 * data, guint size, const guint8 * pattern,
+    const guint8 * mask, guint len)
+{
+  const guint8 *p, *end;
+  guint i;
+
+  if (G_UNLIKELY (size < len))
+    return NULL;
+
+  end = data + size - len + 1;
+  for (p = data; (p = memchr (p, pattern[0], end - p)) != NULL; p++) {
+    for (i = 1; i < len; i++) {
+      if ((p[i] & mask[i]) != pattern[i])
+        break;
+    }
+    if (i == len)
+      return p;
+  }
+  return NULL;
+}
+
+/* Advances @c to the next position before @max_offset where the sync
+ * pattern (see scan_for_sync()) starts, making sure that at least @len
+ * bytes are available there. Returns FALSE if there is none. */
+static inline gboolean
+data_scan_ctx_find_sync (GstTypeFind * tf, DataScanCtx * c,
+    const guint8 * pattern, const guint8 * mask, guint len, guint64 max_offset)
+{
+  while (c->offset < max_offset) {
+    const guint8 *sync;
+    guint size;
+
+    if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, c, len)))
+      return FALSE;
+
+    /* only look at positions before max_offset */
+    size = MIN ((guint64) c->size, max_offset - c->offset + len - 1);
+    sync = scan_for_sync (c->data, size, pattern, mask, len);
+    if (sync != NULL) {
+      data_scan_ctx_advance (tf, c, sync - c->data);
+      return TRUE;
+    }
+    data_scan_ctx_advance (tf, c, size - len + 1);
+  }
+  return FALSE;
+}
+
+/* 00 00 01 start code, followed by the start code type or NAL header */
+static const guint8 mpeg_sync[] = { 0x00, 0x00, 0x01, 0x00, 0x00 };
+static const guint8 mpeg_sync_mask[] = { 0xff, 0xff, 0xff, 0x00, 0x00 };
+
+/* Signature index: the exact signatures of the start-with and riff
+ * typefinders that identify a format with maximum probability, by the first
+ * byte of the data. It is filled during plugin init and allows the scanning
+ * typefinders to bail out with a single table lookup instead of scanning
+ * the data of a stream that will be identified by its signature anyway */
+
+typedef struct _TypeFindSignature TypeFindSignature;
+
+struct _TypeFindSignature
+{
+  const gchar *prefix;          /* riff/avf0 header before the signature */
+  const guint8 *data;
+  guint offset;
+  guint size;
+  TypeFindSignature *next;
+};
+
+/* enough for all the signatures registered in plugin_init, further ones are
+ * not indexed and just don't short-circuit the scanners */
+#define MAX_SIGNATURES 64
+
+static TypeFindSignature signatures[MAX_SIGNATURES];
+static guint n_signatures;
+static TypeFindSignature *signature_index[256];
+
+static void
+signature_index_add (const gchar * prefix, const guint8 * data, guint size)
+{
+  TypeFindSignature *sig;
+  guint8 first;
+
+  if (n_signatures == MAX_SIGNATURES) {
+    GST_WARNING ("signature index full");
+    return;
+  }
+  sig = &signatures[n_signatures++];
+
+  sig->prefix = prefix;
+  sig->data = data;
+  sig->offset = prefix ? 8 : 0;
+  sig->size = size;
+
+  first = prefix ? (guint8) prefix[0] : data[0];
+  sig->next = signature_index[first];
+  signature_index[first] = sig;
+}
+
+static gboolean
+starts_with_exact_signature (GstTypeFind * tf)
+{
+  const guint8 *data;
+  TypeFindSignature *sig;
+
+  data = gst_type_find_peek (tf, 0, 1);
+  if (data == NULL)
+    return FALSE;
+
+  for (sig = signature_index[data[0]]; sig; sig = sig->next) {
+    data = gst_type_find_peek (tf, 0, sig->offset + sig->size);
+    if (data == NULL)
+      continue;
+    if (sig->prefix && memcmp (data, sig->prefix, 4) != 0)
+      continue;
+    if (memcmp (data + sig->offset, sig->data, sig->size) == 0) {
+      GST_LOG ("data starts with an exact signature, not scanning");
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
 /*** text/plain ***/
 static gboolean xml_check_first_element (GstTypeFind * tf,
     const gchar * element, guint elen, gboolean strict);
@@ -1027,6 +1159,9 @@ aac_type_find (GstTypeFind * tf, gpointer unused)
   GstCaps *best_caps = NULL;
   guint best_count = 0;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   while (c.offset < AAC_AMOUNT) {
     guint snc, len, offset, i;
 
@@ -1337,6 +1472,8 @@ static GstStaticCaps mp3_caps = GST_STATIC_CAPS ("audio/mpeg, "
 #define GST_MP3_TYPEFIND_SYNC_SIZE (2048)
 #define GST_MP3_WRONG_HEADER (10)
 
+static const guint8 mp3_sync[] = { 0xFF };
+
 static void
 mp3_type_find_at_offset (GstTypeFind * tf, guint64 start_off,
     guint * found_layer, GstTypeFindProbability * found_prob)
@@ -1345,6 +1482,8 @@ mp3_type_find_at_offset (GstTypeFind * tf, guint64 start_off,
   const guint8 *data_end = NULL;
   guint size;
   guint64 skipped;
+  const guint8 *sync;
+  guint skip;
   gint last_free_offset = -1;
   gint last_free_framelen = -1;
   gboolean headerstart = TRUE;
@@ -1474,9 +1613,15 @@ mp3_type_find_at_offset (GstTypeFind * tf, guint64 start_off,
         return;
       }
     }
-    data++;
-    skipped++;
-    size--;
+
+    /* jump to the next possible frame sync */
+    skip = MIN (size, GST_MP3_TYPEFIND_TRY_SYNC - skipped);
+    sync = scan_for_sync (data + 1, skip - 1, mp3_sync, mp3_sync, 1);
+    if (sync != NULL)
+      skip = sync - data;
+    data += skip;
+    skipped += skip;
+    size -= skip;
   }
 }
 
@@ -1488,6 +1633,9 @@ mp3_type_find (GstTypeFind * tf, gpointer unused)
   guint layer, mid_layer;
   guint64 length;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   mp3_type_find_at_offset (tf, 0, &layer, &prob);
   length = gst_type_find_get_length (tf);
 
@@ -1634,88 +1782,95 @@ static const struct ac3_frmsize ac3_frmsizecod_tbl[] = {
   {640, {1280, 1394, 1920}}
 };
 
+/* 0x0b77 sync word, the frame header up to bsid has to be available */
+static const guint8 ac3_sync[] = { 0x0b, 0x77, 0x00, 0x00, 0x00, 0x00 };
+static const guint8 ac3_sync_mask[] = { 0xff, 0xff, 0x00, 0x00, 0x00, 0x00 };
+
 static void
 ac3_type_find (GstTypeFind * tf, gpointer unused)
 {
   DataScanCtx c = { 0, NULL, 0 };
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   /* Search for an ac3 frame; not necessarily right at the start, but give it
    * a lower probability if not found right at the start. Check that the
    * frame is followed by a second frame at the expected offset.
    * We could also check the two ac3 CRCs, but we don't do that right now */
   while (c.offset < 1024) {
-    if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, &c, 5)))
+    guint bsid;
+
+    if (!data_scan_ctx_find_sync (tf, &c, ac3_sync, ac3_sync_mask, 6, 1024))
       break;
 
-    if (c.data[0] == 0x0b && c.data[1] == 0x77) {
-      guint bsid = c.data[5] >> 3;
-
-      if (bsid <= 8) {
-        /* ac3 */
-        guint fscod = c.data[4] >> 6;
-        guint frmsizecod = c.data[4] & 0x3f;
-
-        if (fscod < 3 && frmsizecod < 38) {
-          DataScanCtx c_next = c;
-          guint frame_size;
-
-          frame_size = ac3_frmsizecod_tbl[frmsizecod].frm_size[fscod];
-          GST_LOG ("possible AC3 frame sync at offset %"
-              G_GUINT64_FORMAT ", size=%u", c.offset, frame_size);
-          if (data_scan_ctx_ensure_data (tf, &c_next, (frame_size * 2) + 5)) {
-            data_scan_ctx_advance (tf, &c_next, frame_size * 2);
-
-            if (c_next.data[0] == 0x0b && c_next.data[1] == 0x77) {
-              fscod = c_next.data[4] >> 6;
-              frmsizecod = c_next.data[4] & 0x3f;
-
-              if (fscod < 3 && frmsizecod < 38) {
-                GstTypeFindProbability prob;
-
-                GST_LOG ("found second AC3 frame (size=%u), looks good",
-                    ac3_frmsizecod_tbl[frmsizecod].frm_size[fscod]);
-                if (c.offset == 0)
-                  prob = GST_TYPE_FIND_MAXIMUM;
-                else
-                  prob = GST_TYPE_FIND_NEARLY_CERTAIN;
-
-                gst_type_find_suggest (tf, prob, AC3_CAPS);
-                return;
-              }
-            } else {
-              GST_LOG ("no second AC3 frame found, false sync");
-            }
-          }
-        }
-      } else if (bsid <= 16 && bsid > 10) {
-        /* eac3 */
+    bsid = c.data[5] >> 3;
+
+    if (bsid <= 8) {
+      /* ac3 */
+      guint fscod = c.data[4] >> 6;
+      guint frmsizecod = c.data[4] & 0x3f;
+
+      if (fscod < 3 && frmsizecod < 38) {
         DataScanCtx c_next = c;
         guint frame_size;
 
-        frame_size = (((c.data[2] & 0x07) << 8) + c.data[3]) + 1;
-        GST_LOG ("possible E-AC3 frame sync at offset %"
+        frame_size = ac3_frmsizecod_tbl[frmsizecod].frm_size[fscod];
+        GST_LOG ("possible AC3 frame sync at offset %"
             G_GUINT64_FORMAT ", size=%u", c.offset, frame_size);
         if (data_scan_ctx_ensure_data (tf, &c_next, (frame_size * 2) + 5)) {
           data_scan_ctx_advance (tf, &c_next, frame_size * 2);
 
           if (c_next.data[0] == 0x0b && c_next.data[1] == 0x77) {
-            GstTypeFindProbability prob;
+            fscod = c_next.data[4] >> 6;
+            frmsizecod = c_next.data[4] & 0x3f;
 
-            GST_LOG ("found second E-AC3 frame, looks good");
-            if (c.offset == 0)
-              prob = GST_TYPE_FIND_MAXIMUM;
-            else
-              prob = GST_TYPE_FIND_NEARLY_CERTAIN;
+            if (fscod < 3 && frmsizecod < 38) {
+              GstTypeFindProbability prob;
 
-            gst_type_find_suggest (tf, prob, EAC3_CAPS);
-            return;
+              GST_LOG ("found second AC3 frame (size=%u), looks good",
+                  ac3_frmsizecod_tbl[frmsizecod].frm_size[fscod]);
+              if (c.offset == 0)
+                prob = GST_TYPE_FIND_MAXIMUM;
+              else
+                prob = GST_TYPE_FIND_NEARLY_CERTAIN;
+
+              gst_type_find_suggest (tf, prob, AC3_CAPS);
+              return;
+            }
           } else {
-            GST_LOG ("no second E-AC3 frame found, false sync");
+            GST_LOG ("no second AC3 frame found, false sync");
           }
         }
-      } else {
-        GST_LOG ("invalid AC3 BSID: %u", bsid);
       }
+    } else if (bsid <= 16 && bsid > 10) {
+      /* eac3 */
+      DataScanCtx c_next = c;
+      guint frame_size;
+
+      frame_size = (((c.data[2] & 0x07) << 8) + c.data[3]) + 1;
+      GST_LOG ("possible E-AC3 frame sync at offset %"
+          G_GUINT64_FORMAT ", size=%u", c.offset, frame_size);
+      if (data_scan_ctx_ensure_data (tf, &c_next, (frame_size * 2) + 5)) {
+        data_scan_ctx_advance (tf, &c_next, frame_size * 2);
+
+        if (c_next.data[0] == 0x0b && c_next.data[1] == 0x77) {
+          GstTypeFindProbability prob;
+
+          GST_LOG ("found second E-AC3 frame, looks good");
+          if (c.offset == 0)
+            prob = GST_TYPE_FIND_MAXIMUM;
+          else
+            prob = GST_TYPE_FIND_NEARLY_CERTAIN;
+
+          gst_type_find_suggest (tf, prob, EAC3_CAPS);
+          return;
+        } else {
+          GST_LOG ("no second E-AC3 frame found, false sync");
+        }
+      }
+    } else {
+      GST_LOG ("invalid AC3 BSID: %u", bsid);
     }
     data_scan_ctx_advance (tf, &c, 1);
   }
@@ -1806,6 +1961,9 @@ dts_type_find (GstTypeFind * tf, gpointer unused)
 {
   DataScanCtx c = { 0, NULL, 0 };
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   /* Search for an dts frame; not necessarily right at the start, but give it
    * a lower probability if not found right at the start. Check that the
    * frame is followed by a second frame at the expected offset. */
@@ -2202,6 +2360,9 @@ mpeg_sys_type_find (GstTypeFind * tf, gpointer unused)
   guint32 sync_word = 0xffffffff;
   guint potential_headers = 0;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   G_STMT_START {
     gint len;
 
@@ -2343,6 +2504,10 @@ static GstStaticCaps mpegts_caps = GST_STATIC_CAPS ("video/mpegts, "
                                 (((data)[1] & 0x80) == 0x00) && \
                                 (((data)[3] & 0x30) != 0x00))
 
+/* the part of IS_MPEGTS_HEADER that can be matched with a mask */
+static const guint8 mpegts_sync[] = { 0x47, 0x00, 0x00, 0x00 };
+static const guint8 mpegts_sync_mask[] = { 0xff, 0x80, 0x00, 0x00 };
+
 /* Helper function to search ahead at intervals of packet_size for mpegts
  * headers */
 static gint
@@ -2375,10 +2540,13 @@ mpeg_ts_type_find (GstTypeFind * tf, gpointer unused)
   /* TS packet sizes to test: normal, DVHS packet size and
    * FEC with 16 or 20 byte codes packet size. */
   const gint pack_sizes[] = { 188, 192, 204, 208 };
-  const guint8 *data = NULL;
-  guint size = 0;
+  const guint8 *data = NULL, *sync;
+  guint size = 0, skip;
   guint64 skipped = 0;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   while (skipped < GST_MPEGTS_TYPEFIND_SCAN_LENGTH) {
     if (size < MPEGTS_HDR_SIZE) {
       data = gst_type_find_peek (tf, skipped, GST_MPEGTS_TYPEFIND_SYNC_SIZE);
@@ -2387,7 +2555,23 @@ mpeg_ts_type_find (GstTypeFind * tf, gpointer unused)
       size = GST_MPEGTS_TYPEFIND_SYNC_SIZE;
     }
 
-    /* Have at least MPEGTS_HDR_SIZE bytes at this point */
+    /* Have at least MPEGTS_HDR_SIZE bytes at this point, jump to the next
+     * possible sync byte */
+    skip = MIN (size - MPEGTS_HDR_SIZE + 1,
+        GST_MPEGTS_TYPEFIND_SCAN_LENGTH - skipped);
+    sync = scan_for_sync (data, skip + MPEGTS_HDR_SIZE - 1, mpegts_sync,
+        mpegts_sync_mask, MPEGTS_HDR_SIZE);
+    if (sync == NULL) {
+      data += skip;
+      skipped += skip;
+      size -= skip;
+      continue;
+    }
+    skip = sync - data;
+    data += skip;
+    skipped += skip;
+    size -= skip;
+
     if (IS_MPEGTS_HEADER (data)) {
       gint p;
 
@@ -2430,18 +2614,12 @@ static gboolean
 mpeg_find_next_header (GstTypeFind * tf, DataScanCtx * c,
     guint64 max_extra_offset)
 {
-  guint64 extra_offset;
+  if (!data_scan_ctx_find_sync (tf, c, mpeg_sync, mpeg_sync_mask, 4,
+          c->offset + max_extra_offset + 1))
+    return FALSE;
 
-  for (extra_offset = 0; extra_offset <= max_extra_offset; ++extra_offset) {
-    if (!data_scan_ctx_ensure_data (tf, c, 4))
-      return FALSE;
-    if (IS_MPEG_HEADER (c->data)) {
-      data_scan_ctx_advance (tf, c, 3);
-      return TRUE;
-    }
-    data_scan_ctx_advance (tf, c, 1);
-  }
-  return FALSE;
+  data_scan_ctx_advance (tf, c, 3);
+  return TRUE;
 }
 
 /*** video/mpeg MPEG-4 elementary video stream ***/
@@ -2468,6 +2646,9 @@ mpeg4_video_type_find (GstTypeFind * tf, gpointer unused)
   guint num_vop_headers = 0;
   guint8 sc;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   while (c.offset < GST_MPEGVID_TYPEFIND_TRY_SYNC) {
     if (num_vop_headers >= GST_MPEGVID_TYPEFIND_TRY_PICTURES)
       break;
@@ -2588,6 +2769,9 @@ h263_video_type_find (GstTypeFind * tf, gpointer unused)
   guint good = 0;
   guint bad = 0;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   while (c.offset < H263_MAX_PROBE_LENGTH) {
     if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, &c, 4)))
       break;
@@ -2648,68 +2832,69 @@ h264_video_type_find (GstTypeFind * tf, gpointer unused)
   int good = 0;
   int bad = 0;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   while (c.offset < H264_MAX_PROBE_LENGTH) {
-    if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, &c, 4)))
+    if (!data_scan_ctx_find_sync (tf, &c, mpeg_sync, mpeg_sync_mask, 4,
+            H264_MAX_PROBE_LENGTH))
       break;
 
-    if (IS_MPEG_HEADER (c.data)) {
-      nut = c.data[3] & 0x9f;   /* forbiden_zero_bit | nal_unit_type */
-      ref = c.data[3] & 0x60;   /* nal_ref_idc */
+    nut = c.data[3] & 0x9f;   /* forbiden_zero_bit | nal_unit_type */
+    ref = c.data[3] & 0x60;   /* nal_ref_idc */
 
-      /* if forbidden bit is different to 0 won't be h264 */
-      if (nut > 0x1f) {
-        bad++;
-        break;
-      }
+    /* if forbidden bit is different to 0 won't be h264 */
+    if (nut > 0x1f) {
+      bad++;
+      break;
+    }
 
-      /* collect statistics about the NAL types */
-      if ((nut >= 1 && nut <= 13) || nut == 19) {
-        if ((nut == 5 && ref == 0) ||
-            ((nut == 6 || (nut >= 9 && nut <= 12)) && ref != 0)) {
-          bad++;
-        } else {
-          if (nut == 7)
-            seen_sps = TRUE;
-          else if (nut == 8)
-            seen_pps = TRUE;
-          else if (nut == 5)
-            seen_idr = TRUE;
+    /* collect statistics about the NAL types */
+    if ((nut >= 1 && nut <= 13) || nut == 19) {
+      if ((nut == 5 && ref == 0) ||
+          ((nut == 6 || (nut >= 9 && nut <= 12)) && ref != 0)) {
+        bad++;
+      } else {
+        if (nut == 7)
+          seen_sps = TRUE;
+        else if (nut == 8)
+          seen_pps = TRUE;
+        else if (nut == 5)
+          seen_idr = TRUE;
 
+        good++;
+      }
+    } else if (nut >= 14 && nut <= 33) {
+      if (nut == 15) {
+        seen_ssps = TRUE;
+        good++;
+      } else if (nut == 14 || nut == 20) {
+        /* Sometimes we see NAL 14 or 20 without SSPS
+         * if dropped into the middle of a stream -
+         * just ignore those (don't add to bad count) */
+        if (seen_ssps)
           good++;
-        }
-      } else if (nut >= 14 && nut <= 33) {
-        if (nut == 15) {
-          seen_ssps = TRUE;
-          good++;
-        } else if (nut == 14 || nut == 20) {
-          /* Sometimes we see NAL 14 or 20 without SSPS
-           * if dropped into the middle of a stream -
-           * just ignore those (don't add to bad count) */
-          if (seen_ssps)
-            good++;
-        } else {
-          /* reserved */
-          /* Theoretically these are good, since if they exist in the
-             stream it merely means that a newer backwards-compatible
-             h.264 stream.  But we should be identifying that separately. */
-          bad++;
-        }
       } else {
-        /* unspecified, application specific */
-        /* don't consider these bad */
+        /* reserved */
+        /* Theoretically these are good, since if they exist in the
+           stream it merely means that a newer backwards-compatible
+           h.264 stream.  But we should be identifying that separately. */
+        bad++;
       }
+    } else {
+      /* unspecified, application specific */
+      /* don't consider these bad */
+    }
 
-      GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, idr:%d ssps:%d", good, bad,
-          seen_pps, seen_sps, seen_idr, seen_ssps);
-
-      if (seen_sps && seen_pps && seen_idr && good >= 10 && bad < 4) {
-        gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H264_VIDEO_CAPS);
-        return;
-      }
+    GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, idr:%d ssps:%d", good, bad,
+        seen_pps, seen_sps, seen_idr, seen_ssps);
 
-      data_scan_ctx_advance (tf, &c, 4);
+    if (seen_sps && seen_pps && seen_idr && good >= 10 && bad < 4) {
+      gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H264_VIDEO_CAPS);
+      return;
     }
-    data_scan_ctx_advance (tf, &c, 1);
+
+    data_scan_ctx_advance (tf, &c, 5);
   }
 
   GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, idr:%d ssps=%d", good, bad,
@@ -2745,64 +2930,65 @@ h265_video_type_find (GstTypeFind * tf, gpointer unused)
   int good = 0;
   int bad = 0;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   while (c.offset < H265_MAX_PROBE_LENGTH) {
-    if (G_UNLIKELY (!data_scan_ctx_ensure_data (tf, &c, 5)))
+    if (!data_scan_ctx_find_sync (tf, &c, mpeg_sync, mpeg_sync_mask, 5,
+            H265_MAX_PROBE_LENGTH))
       break;
 
-    if (IS_MPEG_HEADER (c.data)) {
-      /* forbiden_zero_bit | nal_unit_type */
-      nut = c.data[3] & 0xfe;
+    /* forbiden_zero_bit | nal_unit_type */
+    nut = c.data[3] & 0xfe;
 
-      /* if forbidden bit is different to 0 won't be h265 */
-      if (nut > 0x7e) {
-        bad++;
-        break;
-      }
-      nut = nut >> 1;
-
-      /* if nuh_layer_id is not zero or nuh_temporal_id_plus1 is zero then
-       * it won't be h265 */
-      if ((c.data[3] & 0x01) || (c.data[4] & 0xf8) || !(c.data[4] & 0x07)) {
-        bad++;
-        break;
-      }
+    /* if forbidden bit is different to 0 won't be h265 */
+    if (nut > 0x7e) {
+      bad++;
+      break;
+    }
+    nut = nut >> 1;
 
-      /* collect statistics about the NAL types */
-      if ((nut >= 0 && nut <= 9) || (nut >= 16 && nut <= 21) || (nut >= 32
-              && nut <= 40)) {
-        if (nut == 32)
-          seen_vps = TRUE;
-        else if (nut == 33)
-          seen_sps = TRUE;
-        else if (nut == 34)
-          seen_pps = TRUE;
-        else if (nut >= 16 && nut <= 21) {
-          /* BLA, IDR and CRA pictures are belongs to be IRAP picture */
-          /* we are not counting the reserved IRAP pictures (22 and 23) to good */
-          seen_irap = TRUE;
-        }
+    /* if nuh_layer_id is not zero or nuh_temporal_id_plus1 is zero then
+     * it won't be h265 */
+    if ((c.data[3] & 0x01) || (c.data[4] & 0xf8) || !(c.data[4] & 0x07)) {
+      bad++;
+      break;
+    }
 
-        good++;
-      } else if ((nut >= 10 && nut <= 15) || (nut >= 22 && nut <= 31)
-          || (nut >= 41 && nut <= 47)) {
-        /* reserved values are counting as bad */
-        bad++;
-      } else {
-        /* unspecified (48..63), application specific */
-        /* don't consider these as bad */
+    /* collect statistics about the NAL types */
+    if ((nut >= 0 && nut <= 9) || (nut >= 16 && nut <= 21) || (nut >= 32
+            && nut <= 40)) {
+      if (nut == 32)
+        seen_vps = TRUE;
+      else if (nut == 33)
+        seen_sps = TRUE;
+      else if (nut == 34)
+        seen_pps = TRUE;
+      else if (nut >= 16 && nut <= 21) {
+        /* BLA, IDR and CRA pictures are belongs to be IRAP picture */
+        /* we are not counting the reserved IRAP pictures (22 and 23) to good */
+        seen_irap = TRUE;
       }
 
-      GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, vps:%d, irap:%d", good, bad,
-          seen_pps, seen_sps, seen_vps, seen_irap);
+      good++;
+    } else if ((nut >= 10 && nut <= 15) || (nut >= 22 && nut <= 31)
+        || (nut >= 41 && nut <= 47)) {
+      /* reserved values are counting as bad */
+      bad++;
+    } else {
+      /* unspecified (48..63), application specific */
+      /* don't consider these as bad */
+    }
 
-      if (seen_sps && seen_pps && seen_irap && good >= 10 && bad < 4) {
-        gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H265_VIDEO_CAPS);
-        return;
-      }
+    GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, vps:%d, irap:%d", good, bad,
+        seen_pps, seen_sps, seen_vps, seen_irap);
 
-      data_scan_ctx_advance (tf, &c, 5);
+    if (seen_sps && seen_pps && seen_irap && good >= 10 && bad < 4) {
+      gst_type_find_suggest (tf, GST_TYPE_FIND_LIKELY, H265_VIDEO_CAPS);
+      return;
     }
-    data_scan_ctx_advance (tf, &c, 1);
+
+    data_scan_ctx_advance (tf, &c, 6);
   }
 
   GST_LOG ("good:%d, bad:%d, pps:%d, sps:%d, vps:%d, irap:%d", good, bad,
@@ -2839,16 +3025,17 @@ mpeg_video_stream_type_find (GstTypeFind * tf, gpointer unused)
   guint num_pic_headers = 0;
   gint found = 0;
 
+  if (starts_with_exact_signature (tf))
+    return;
+
   while (c.offset < GST_MPEGVID_TYPEFIND_TRY_SYNC) {
     if (found >= GST_MPEGVID_TYPEFIND_TRY_PICTURES)
       break;
 
-    if (!data_scan_ctx_ensure_data (tf, &c, 5))
+    if (!data_scan_ctx_find_sync (tf, &c, mpeg_sync, mpeg_sync_mask, 5,
+            GST_MPEGVID_TYPEFIND_TRY_SYNC))
       break;
 
-    if (!IS_MPEG_HEADER (c.data))
-      goto next;
-
     /* a pack header indicates that this isn't an elementary stream */
     if (c.data[3] == 0xBA && mpeg_sys_is_valid_pack (tf, c.data, c.size, NULL))
       return;
@@ -2886,8 +3073,6 @@ mpeg_video_stream_type_find (GstTypeFind * tf, gpointer unused)
       continue;
     }
 
-  next:
-
     data_scan_ctx_advance (tf, &c, 1);
   }
 
@@ -5476,6 +5661,8 @@ G_BEGIN_DECLS{                                                          \
                      ext, sw_data->caps, sw_data,                       \
                      (GDestroyNotify) (sw_data_destroy))) {             \
     sw_data_destroy (sw_data);                                          \
+  } else if (_probability == GST_TYPE_FIND_MAXIMUM && _size >= 4) {     \
+    signature_index_add (NULL, (const guint8 *)_data, _size);           \
   }                                                                     \
 }G_END_DECLS
 
@@ -5505,6 +5692,9 @@ G_BEGIN_DECLS{                                                          \
                       ext, sw_data->caps, sw_data,                      \
                       (GDestroyNotify) (sw_data_destroy))) {            \
     sw_data_destroy (sw_data);                                          \
+  } else {                                                              \
+    signature_index_add ("RIFF", (const guint8 *)_data, 4);             \
+    signature_index_add ("AVF0", (const guint8 *)_data, 4);             \
   }                                                                     \
 }G_END_DECLS
 
@@ -35,12 +35,24 @@
  * (peak values are around -6 dB and RMS around -9 dB) compared to
  * the same pipeline without the volume element.
  * </refsect2>
+ *
+ * Besides the global #GstVolume:volume, a gain can be set for each channel
+ * with #GstVolume:channel-volumes. When the volume is controlled, the control
+ * binding is sampled for every sample by default. For long fades it is
+ * cheaper to set #GstVolume:ramp-block-size, the control binding is then
+ * only sampled every that many samples and the volume is interpolated in
+ * between as selected by #GstVolume:ramp-mode.
  */
 
+/* FIXME 0.11: suppress warnings for deprecated API such as GValueArray
+ * with newer GLib versions (>= 2.31.0) */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include <math.h>
 #include <string.h>
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
@@ -90,14 +102,38 @@ enum
 
 #define DEFAULT_PROP_MUTE       FALSE
 #define DEFAULT_PROP_VOLUME     1.0
+#define DEFAULT_PROP_RAMP_BLOCK_SIZE 0
+#define DEFAULT_PROP_RAMP_MODE  GST_VOLUME_RAMP_LINEAR
 
 enum
 {
   PROP_0,
   PROP_MUTE,
-  PROP_VOLUME
+  PROP_VOLUME,
+  PROP_CHANNEL_VOLUMES,
+  PROP_RAMP_BLOCK_SIZE,
+  PROP_RAMP_MODE
 };
 
+#define GST_TYPE_VOLUME_RAMP_MODE (gst_volume_ramp_mode_get_type ())
+static GType
+gst_volume_ramp_mode_get_type (void)
+{
+  static GType gtype = 0;
+
+  if (gtype == 0) {
+    static const GEnumValue values[] = {
+      {GST_VOLUME_RAMP_LINEAR, "Linear interpolation", "linear"},
+      {GST_VOLUME_RAMP_EXPONENTIAL, "Exponential interpolation",
+          "exponential"},
+      {0, NULL, NULL}
+    };
+
+    gtype = g_enum_register_static ("GstVolumeRampMode", values);
+  }
+  return gtype;
+}
+
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
 #define ALLOWED_CAPS \
     GST_AUDIO_CAPS_MAKE ("{ F32LE, F64LE, S8, S16LE, S24LE, S32LE }") \
@@ -158,6 +194,18 @@ static void volume_process_int8_clamp (GstVolume * self, gpointer bytes,
     guint n_bytes);
 static void volume_process_controlled_int8_clamp (GstVolume * self,
     gpointer bytes, gdouble * volume, guint channels, guint n_bytes);
+static void volume_process_gains_double (GstVolume * self, gpointer bytes,
+    gdouble * volume, guint channels, guint n_bytes);
+static void volume_process_gains_float (GstVolume * self, gpointer bytes,
+    gdouble * volume, guint channels, guint n_bytes);
+static void volume_process_gains_int32 (GstVolume * self, gpointer bytes,
+    gdouble * volume, guint channels, guint n_bytes);
+static void volume_process_gains_int24 (GstVolume * self, gpointer bytes,
+    gdouble * volume, guint channels, guint n_bytes);
+static void volume_process_gains_int16 (GstVolume * self, gpointer bytes,
+    gdouble * volume, guint channels, guint n_bytes);
+static void volume_process_gains_int8 (GstVolume * self, gpointer bytes,
+    gdouble * volume, guint channels, guint n_bytes);
 
 
 /* helper functions */
@@ -169,6 +217,7 @@ volume_choose_func (GstVolume * self, const GstAudioInfo * info)
 
   self->process = NULL;
   self->process_controlled = NULL;
+  self->process_gains = NULL;
 
   format = GST_AUDIO_INFO_FORMAT (info);
 
@@ -184,6 +233,7 @@ volume_choose_func (GstVolume * self, const GstAudioInfo * info)
         self->process = volume_process_int32;
       }
       self->process_controlled = volume_process_controlled_int32_clamp;
+      self->process_gains = volume_process_gains_int32;
       break;
     case GST_AUDIO_FORMAT_S24:
       /* only clamp if the gain is greater than 1.0 */
@@ -193,6 +243,7 @@ volume_choose_func (GstVolume * self, const GstAudioInfo * info)
         self->process = volume_process_int24;
       }
       self->process_controlled = volume_process_controlled_int24_clamp;
+      self->process_gains = volume_process_gains_int24;
       break;
     case GST_AUDIO_FORMAT_S16:
       /* only clamp if the gain is greater than 1.0 */
@@ -202,6 +253,7 @@ volume_choose_func (GstVolume * self, const GstAudioInfo * info)
         self->process = volume_process_int16;
       }
       self->process_controlled = volume_process_controlled_int16_clamp;
+      self->process_gains = volume_process_gains_int16;
       break;
     case GST_AUDIO_FORMAT_S8:
       /* only clamp if the gain is greater than 1.0 */
@@ -211,14 +263,17 @@ volume_choose_func (GstVolume * self, const GstAudioInfo * info)
         self->process = volume_process_int8;
       }
       self->process_controlled = volume_process_controlled_int8_clamp;
+      self->process_gains = volume_process_gains_int8;
       break;
     case GST_AUDIO_FORMAT_F32:
       self->process = volume_process_float;
       self->process_controlled = volume_process_controlled_float;
+      self->process_gains = volume_process_gains_float;
       break;
     case GST_AUDIO_FORMAT_F64:
       self->process = volume_process_double;
       self->process_controlled = volume_process_controlled_double;
+      self->process_gains = volume_process_gains_double;
       break;
     default:
       break;
@@ -227,6 +282,33 @@ volume_choose_func (GstVolume * self, const GstAudioInfo * info)
   return (self->process != NULL);
 }
 
+/* expand the channel volumes to one gain per channel, channels without a
+ * volume keep unity gain */
+static void
+volume_update_gains (GstVolume * self, const GstAudioInfo * info)
+{
+  gint i, channels = GST_AUDIO_INFO_CHANNELS (info);
+
+  g_free (self->current_gains);
+  self->current_gains = g_new (gdouble, MAX (channels, 1));
+  self->use_gains = FALSE;
+
+  GST_OBJECT_LOCK (self);
+  for (i = 0; i < channels; i++) {
+    if (i < self->n_channel_volumes)
+      self->current_gains[i] = self->channel_volumes[i];
+    else
+      self->current_gains[i] = 1.0;
+
+    if (self->current_gains[i] != 1.0)
+      self->use_gains = TRUE;
+  }
+  self->channel_volumes_changed = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "use channel gains %d", self->use_gains);
+}
+
 static gboolean
 volume_update_volume (GstVolume * self, const GstAudioInfo * info,
     gfloat volume, gboolean mute)
@@ -267,6 +349,7 @@ volume_update_volume (GstVolume * self, const GstAudioInfo * info,
    * else in the middle of a buffer.
    */
   passthrough &= !gst_object_has_active_control_bindings (GST_OBJECT (self));
+  passthrough &= !self->use_gains;
 
   GST_DEBUG_OBJECT (self, "set passthrough %d", passthrough);
 
@@ -291,6 +374,10 @@ gst_volume_dispose (GObject * object)
     volume->tracklist = NULL;
   }
 
+  g_free (volume->channel_volumes);
+  volume->channel_volumes = NULL;
+  volume->n_channel_volumes = 0;
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -322,6 +409,45 @@ gst_volume_class_init (GstVolumeClass * klass)
           0.0, VOLUME_MAX_DOUBLE, DEFAULT_PROP_VOLUME,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVolume:channel-volumes:
+   *
+   * Volume factor for each channel, applied on top of #GstVolume:volume.
+   * Channels without an entry in the array keep a factor of 1.0.
+   */
+  g_object_class_install_property (gobject_class, PROP_CHANNEL_VOLUMES,
+      g_param_spec_value_array ("channel-volumes", "Channel volumes",
+          "Volume factor for each channel, 1.0=100%",
+          g_param_spec_double ("volume", "Volume", "volume factor, 1.0=100%",
+              0.0, VOLUME_MAX_DOUBLE, DEFAULT_PROP_VOLUME,
+              G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVolume:ramp-block-size:
+   *
+   * Number of samples between two points where the volume control binding
+   * is sampled. The volume is interpolated in between. 0 samples the
+   * control binding for every sample.
+   */
+  g_object_class_install_property (gobject_class, PROP_RAMP_BLOCK_SIZE,
+      g_param_spec_uint ("ramp-block-size", "Ramp block size",
+          "Samples between two points where the volume controller is sampled "
+          "(0 = every sample)", 0, G_MAXUINT16, DEFAULT_PROP_RAMP_BLOCK_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVolume:ramp-mode:
+   *
+   * How the volume is interpolated between the points where the volume
+   * control binding is sampled, see #GstVolume:ramp-block-size.
+   */
+  g_object_class_install_property (gobject_class, PROP_RAMP_MODE,
+      g_param_spec_enum ("ramp-mode", "Ramp mode",
+          "Interpolation between the sampled volume control points",
+          GST_TYPE_VOLUME_RAMP_MODE, DEFAULT_PROP_RAMP_MODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class, "Volume",
       "Filter/Effect/Audio",
       "Set volume on audio/raw streams", "Andy Wingo <wingo@pobox.com>");
@@ -343,6 +469,8 @@ gst_volume_init (GstVolume * self)
 {
   self->mute = DEFAULT_PROP_MUTE;
   self->volume = DEFAULT_PROP_VOLUME;
+  self->ramp_block_size = DEFAULT_PROP_RAMP_BLOCK_SIZE;
+  self->ramp_mode = DEFAULT_PROP_RAMP_MODE;
 
   self->tracklist = NULL;
   self->negotiated = FALSE;
@@ -638,6 +766,109 @@ volume_process_controlled_int8_clamp (GstVolume * self, gpointer bytes,
   }
 }
 
+/* apply the channel gains together with the volume, which is either the
+ * array of controlled volumes or the current volume when @volume is NULL */
+#define MAKE_PROCESS_GAINS(name, type, min, max)                        \
+static void                                                             \
+volume_process_gains_##name (GstVolume * self, gpointer bytes,          \
+    gdouble * volume, guint channels, guint n_bytes)                    \
+{                                                                       \
+  type *data = (type *) bytes;                                          \
+  const gdouble *gains = self->current_gains;                           \
+  guint i, j;                                                           \
+  guint num_samples = n_bytes / (sizeof (type) * channels);             \
+  gdouble vol = self->current_volume, val;                              \
+                                                                        \
+  for (i = 0; i < num_samples; i++) {                                   \
+    if (volume)                                                         \
+      vol = *volume++;                                                  \
+    for (j = 0; j < channels; j++) {                                    \
+      val = *data * vol * gains[j];                                     \
+      *data++ = (type) CLAMP (val, min, max);                           \
+    }                                                                   \
+  }                                                                     \
+}
+
+MAKE_PROCESS_GAINS (double, gdouble, -G_MAXDOUBLE, G_MAXDOUBLE)
+MAKE_PROCESS_GAINS (float, gfloat, -G_MAXFLOAT, G_MAXFLOAT)
+MAKE_PROCESS_GAINS (int32, gint32, VOLUME_MIN_INT32, VOLUME_MAX_INT32)
+MAKE_PROCESS_GAINS (int16, gint16, VOLUME_MIN_INT16, VOLUME_MAX_INT16)
+MAKE_PROCESS_GAINS (int8, gint8, VOLUME_MIN_INT8, VOLUME_MAX_INT8)
+
+static void
+volume_process_gains_int24 (GstVolume * self, gpointer bytes,
+    gdouble * volume, guint channels, guint n_bytes)
+{
+  gint8 *data = (gint8 *) bytes;        /* treat the data as a byte stream */
+  const gdouble *gains = self->current_gains;
+  guint i, j;
+  guint num_samples = n_bytes / (sizeof (gint8) * 3 * channels);
+  gdouble vol = self->current_volume, val;
+
+  for (i = 0; i < num_samples; i++) {
+    if (volume)
+      vol = *volume++;
+    for (j = 0; j < channels; j++) {
+      val = get_unaligned_i24 (data) * vol * gains[j];
+      val = CLAMP (val, VOLUME_MIN_INT24, VOLUME_MAX_INT24);
+      write_unaligned_u24 (data, (gint32) val);
+    }
+  }
+}
+
+/* sample the volume control binding every block samples and interpolate
+ * the volume for the samples in between */
+static gboolean
+volume_get_ramp (GstVolume * self, GstControlBinding * cb, GstClockTime ts,
+    gint rate, guint nsamples, guint block)
+{
+  GstVolumeRampMode mode;
+  GstClockTime interval;
+  gdouble *v = self->volumes;
+  guint n_points, i, j, len;
+
+  GST_OBJECT_LOCK (self);
+  mode = self->ramp_mode;
+  GST_OBJECT_UNLOCK (self);
+
+  n_points = (nsamples + block - 1) / block + 1;
+  if (self->ramp_points_count < n_points) {
+    self->ramp_points =
+        g_realloc (self->ramp_points, sizeof (gdouble) * n_points);
+    self->ramp_points_count = n_points;
+  }
+
+  interval = gst_util_uint64_scale_int (block, GST_SECOND, rate);
+  if (!gst_control_binding_get_value_array (cb, ts, interval, n_points,
+          (gpointer) self->ramp_points))
+    return FALSE;
+
+  for (i = 0; i < n_points - 1; i++) {
+    gdouble start = self->ramp_points[i];
+    gdouble end = self->ramp_points[i + 1];
+
+    len = MIN (block, nsamples - i * block);
+
+    if (mode == GST_VOLUME_RAMP_EXPONENTIAL && start > 0.0 && end > 0.0) {
+      gdouble ratio = pow (end / start, 1.0 / block);
+
+      for (j = 0; j < len; j++) {
+        *v++ = start;
+        start *= ratio;
+      }
+    } else {
+      gdouble step = (end - start) / block;
+
+      for (j = 0; j < len; j++) {
+        *v++ = start;
+        start += step;
+      }
+    }
+  }
+
+  return TRUE;
+}
+
 /* GstBaseTransform vmethod implementations */
 
 /* get notified of caps and plug in the correct process function */
@@ -654,6 +885,7 @@ volume_setup (GstAudioFilter * filter, const GstAudioInfo * info)
   mute = self->mute;
   GST_OBJECT_UNLOCK (self);
 
+  volume_update_gains (self, info);
   res = volume_update_volume (self, info, volume, mute);
   if (!res) {
     GST_ELEMENT_ERROR (self, CORE, NEGOTIATION,
@@ -677,6 +909,14 @@ volume_stop (GstBaseTransform * base)
   self->mutes = NULL;
   self->mutes_count = 0;
 
+  g_free (self->ramp_points);
+  self->ramp_points = NULL;
+  self->ramp_points_count = 0;
+
+  g_free (self->current_gains);
+  self->current_gains = NULL;
+  self->use_gains = FALSE;
+
   return GST_CALL_PARENT_WITH_DEFAULT (GST_BASE_TRANSFORM_CLASS, stop, (base),
       TRUE);
 }
@@ -687,7 +927,7 @@ volume_before_transform (GstBaseTransform * base, GstBuffer * buffer)
   GstClockTime timestamp;
   GstVolume *self = GST_VOLUME (base);
   gfloat volume;
-  gboolean mute;
+  gboolean mute, gains_changed;
 
   timestamp = GST_BUFFER_TIMESTAMP (buffer);
   timestamp =
@@ -703,9 +943,14 @@ volume_before_transform (GstBaseTransform * base, GstBuffer * buffer)
   GST_OBJECT_LOCK (self);
   volume = self->volume;
   mute = self->mute;
+  gains_changed = self->channel_volumes_changed;
   GST_OBJECT_UNLOCK (self);
 
-  if ((volume != self->current_volume) || (mute != self->current_mute)) {
+  if (gains_changed)
+    volume_update_gains (self, GST_AUDIO_FILTER_INFO (self));
+
+  if ((volume != self->current_volume) || (mute != self->current_mute)
+      || gains_changed) {
     /* the volume or mute was updated, update our internal state before
      * we continue processing. */
     volume_update_volume (self, GST_AUDIO_FILTER_INFO (self), volume, mute);
@@ -749,6 +994,11 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
       GstClockTime interval = gst_util_uint64_scale_int (1, GST_SECOND, rate);
       gboolean have_mutes = FALSE;
       gboolean have_volumes = FALSE;
+      guint block;
+
+      GST_OBJECT_LOCK (self);
+      block = self->ramp_block_size;
+      GST_OBJECT_UNLOCK (self);
 
       if (self->mutes_count < nsamples && mute_cb) {
         self->mutes = g_realloc (self->mutes, sizeof (gboolean) * nsamples);
@@ -761,9 +1011,13 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
       }
 
       if (volume_cb) {
-        have_volumes =
-            gst_control_binding_get_value_array (volume_cb, ts, interval,
-            nsamples, (gpointer) self->volumes);
+        if (block > 1 && nsamples > block)
+          have_volumes =
+              volume_get_ramp (self, volume_cb, ts, rate, nsamples, block);
+        else
+          have_volumes =
+              gst_control_binding_get_value_array (volume_cb, ts, interval,
+              nsamples, (gpointer) self->volumes);
         gst_object_replace ((GstObject **) & volume_cb, NULL);
       }
       if (!have_volumes) {
@@ -783,8 +1037,12 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
         self->mutes_count = 0;
       }
 
-      self->process_controlled (self, map.data, self->volumes, channels,
-          map.size);
+      if (self->use_gains)
+        self->process_gains (self, map.data, self->volumes, channels,
+            map.size);
+      else
+        self->process_controlled (self, map.data, self->volumes, channels,
+            map.size);
 
       goto done;
     } else if (volume_cb) {
@@ -795,6 +1053,9 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
   if (self->current_volume == 0.0 || self->current_mute) {
     orc_memset (map.data, 0, map.size);
     GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_GAP);
+  } else if (self->use_gains) {
+    self->process_gains (self, map.data, NULL,
+        GST_AUDIO_INFO_CHANNELS (&filter->info), map.size);
   } else if (self->current_volume != 1.0) {
     self->process (self, map.data, map.size);
   }
@@ -830,6 +1091,34 @@ volume_set_property (GObject * object, guint prop_id, const GValue * value,
       self->volume = g_value_get_double (value);
       GST_OBJECT_UNLOCK (self);
       break;
+    case PROP_CHANNEL_VOLUMES:{
+      GValueArray *array = g_value_get_boxed (value);
+      guint i;
+
+      GST_OBJECT_LOCK (self);
+      g_free (self->channel_volumes);
+      self->channel_volumes = NULL;
+      self->n_channel_volumes = array ? array->n_values : 0;
+      if (self->n_channel_volumes) {
+        self->channel_volumes = g_new (gdouble, self->n_channel_volumes);
+        for (i = 0; i < self->n_channel_volumes; i++)
+          self->channel_volumes[i] =
+              g_value_get_double (g_value_array_get_nth (array, i));
+      }
+      self->channel_volumes_changed = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    case PROP_RAMP_BLOCK_SIZE:
+      GST_OBJECT_LOCK (self);
+      self->ramp_block_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_RAMP_MODE:
+      GST_OBJECT_LOCK (self);
+      self->ramp_mode = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -853,6 +1142,35 @@ volume_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_double (value, self->volume);
       GST_OBJECT_UNLOCK (self);
       break;
+    case PROP_CHANNEL_VOLUMES:{
+      GValueArray *array;
+      GValue v = G_VALUE_INIT;
+      guint i;
+
+      g_value_init (&v, G_TYPE_DOUBLE);
+
+      GST_OBJECT_LOCK (self);
+      array = g_value_array_new (self->n_channel_volumes);
+      for (i = 0; i < self->n_channel_volumes; i++) {
+        g_value_set_double (&v, self->channel_volumes[i]);
+        g_value_array_append (array, &v);
+      }
+      GST_OBJECT_UNLOCK (self);
+
+      g_value_unset (&v);
+      g_value_take_boxed (value, array);
+      break;
+    }
+    case PROP_RAMP_BLOCK_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->ramp_block_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_RAMP_MODE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, self->ramp_mode);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
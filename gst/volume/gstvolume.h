@@ -46,6 +46,21 @@ G_BEGIN_DECLS
 typedef struct _GstVolume GstVolume;
 typedef struct _GstVolumeClass GstVolumeClass;
 
+/**
+ * GstVolumeRampMode:
+ * @GST_VOLUME_RAMP_LINEAR: interpolate linearly between the control points
+ * @GST_VOLUME_RAMP_EXPONENTIAL: interpolate exponentially between the control
+ *     points, which gives fades that sound linear. Falls back to linear
+ *     interpolation when one of the control points is 0.0
+ *
+ * How the volume is interpolated between the control points when the volume
+ * controller is sampled in blocks.
+ */
+typedef enum {
+  GST_VOLUME_RAMP_LINEAR,
+  GST_VOLUME_RAMP_EXPONENTIAL
+} GstVolumeRampMode;
+
 /**
  * GstVolume:
  *
@@ -56,6 +71,7 @@ struct _GstVolume {
 
   void (*process)(GstVolume*, gpointer, guint);
   void (*process_controlled)(GstVolume*, gpointer, gdouble *, guint, guint);
+  void (*process_gains)(GstVolume*, gpointer, gdouble *, guint, guint);
 
   gboolean mute;
   gfloat volume;
@@ -75,6 +91,19 @@ struct _GstVolume {
   guint mutes_count;
   gdouble *volumes;
   guint volumes_count;
+
+  /* per channel gains as set and as used for processing */
+  gdouble *channel_volumes;
+  guint n_channel_volumes;
+  gboolean channel_volumes_changed;
+  gdouble *current_gains;
+  gboolean use_gains;
+
+  /* controller sampling in blocks */
+  guint ramp_block_size;
+  GstVolumeRampMode ramp_mode;
+  gdouble *ramp_points;
+  guint ramp_points_count;
 };
 
 struct _GstVolumeClass {
@@ -0,0 +1,74 @@
+/* GStreamer
+ *
+ * unit tests for alsasink and alsasrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+static void
+check_use_mmap (const gchar * factory)
+{
+  GstElement *element;
+  gboolean use_mmap;
+
+  element = gst_element_factory_make (factory, NULL);
+  fail_unless (element != NULL, "Could not create %s", factory);
+
+  /* read/write access is the default */
+  g_object_get (element, "use-mmap", &use_mmap, NULL);
+  fail_if (use_mmap);
+
+  g_object_set (element, "use-mmap", TRUE, NULL);
+  g_object_get (element, "use-mmap", &use_mmap, NULL);
+  fail_unless (use_mmap);
+
+  g_object_set (element, "use-mmap", FALSE, NULL);
+  g_object_get (element, "use-mmap", &use_mmap, NULL);
+  fail_if (use_mmap);
+
+  gst_object_unref (element);
+}
+
+GST_START_TEST (test_alsasink_use_mmap)
+{
+  check_use_mmap ("alsasink");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_alsasrc_use_mmap)
+{
+  check_use_mmap ("alsasrc");
+}
+
+GST_END_TEST;
+
+static Suite *
+alsa_suite (void)
+{
+  Suite *s = suite_create ("alsa");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_alsasink_use_mmap);
+  tcase_add_test (tc_chain, test_alsasrc_use_mmap);
+
+  return s;
+}
+
+GST_CHECK_MAIN (alsa);
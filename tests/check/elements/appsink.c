@@ -348,6 +348,60 @@ GST_START_TEST (test_segment)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pull_samples)
+{
+  GstElement *sink;
+  GstBuffer *buffer;
+  GstSample *samples[8];
+  guint i, n;
+
+  sink = setup_appsink ();
+
+  ASSERT_SET_STATE (sink, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  for (i = 0; i < 5; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    GST_BUFFER_OFFSET (buffer) = i;
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* all queued samples are returned at once, in order */
+  n = gst_app_sink_pull_samples (GST_APP_SINK (sink), samples,
+      G_N_ELEMENTS (samples), 0);
+  fail_unless_equals_int (n, 5);
+  for (i = 0; i < n; i++) {
+    buffer = gst_sample_get_buffer (samples[i]);
+    fail_unless_equals_int (GST_BUFFER_OFFSET (buffer), i);
+    fail_unless (gst_sample_get_caps (samples[i]) != NULL);
+    gst_sample_unref (samples[i]);
+  }
+
+  /* nothing left, the timeout expires */
+  n = gst_app_sink_pull_samples (GST_APP_SINK (sink), samples,
+      G_N_ELEMENTS (samples), 10 * GST_MSECOND);
+  fail_unless_equals_int (n, 0);
+
+  /* no more than n_samples are returned */
+  for (i = 0; i < 3; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+  n = gst_app_sink_pull_samples (GST_APP_SINK (sink), samples, 2,
+      GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (n, 2);
+  gst_sample_unref (samples[0]);
+  gst_sample_unref (samples[1]);
+  n = gst_app_sink_pull_samples (GST_APP_SINK (sink), samples, 2,
+      GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (n, 1);
+  gst_sample_unref (samples[0]);
+
+  ASSERT_SET_STATE (sink, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_appsink (sink);
+}
+
+GST_END_TEST;
+
 static Suite *
 appsink_suite (void)
 {
@@ -362,6 +416,7 @@ appsink_suite (void)
   tcase_add_test (tc_chain, test_buffer_list_fallback);
   tcase_add_test (tc_chain, test_buffer_list_fallback_signal);
   tcase_add_test (tc_chain, test_segment);
+  tcase_add_test (tc_chain, test_pull_samples);
 
   return s;
 }
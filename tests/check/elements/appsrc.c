@@ -418,6 +418,93 @@ GST_START_TEST (test_appsrc_caps_in_push_modes)
 
 GST_END_TEST;
 
+GST_START_TEST (test_appsrc_push_buffer_list)
+{
+  GstElement *src;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  GList *l;
+  guint i;
+
+  src = setup_appsrc ();
+
+  ASSERT_SET_STATE (src, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    GST_BUFFER_OFFSET (buffer) = i;
+    gst_buffer_list_add (list, buffer);
+  }
+  fail_unless (gst_app_src_push_buffer_list (GST_APP_SRC (src),
+          list) == GST_FLOW_OK);
+
+  /* empty lists are accepted and ignored */
+  fail_unless (gst_app_src_push_buffer_list (GST_APP_SRC (src),
+          gst_buffer_list_new ()) == GST_FLOW_OK);
+
+  buffer = gst_buffer_new_and_alloc (4);
+  GST_BUFFER_OFFSET (buffer) = 3;
+  fail_unless (gst_app_src_push_buffer (GST_APP_SRC (src),
+          buffer) == GST_FLOW_OK);
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 4)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  /* the list buffers come out in order, followed by the single buffer */
+  for (l = buffers, i = 0; l; l = l->next, i++)
+    fail_unless_equals_int (GST_BUFFER_OFFSET (l->data), i);
+  fail_unless_equals_int (gst_app_src_get_current_level_bytes (GST_APP_SRC
+          (src)), 0);
+
+  ASSERT_SET_STATE (src, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_appsrc (src);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_appsrc_push_buffer_list_signal)
+{
+  GstFlowReturn flow_ret = GST_FLOW_ERROR;
+  GstElement *src;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  GList *l;
+  guint i;
+
+  src = setup_appsrc ();
+
+  ASSERT_SET_STATE (src, GST_STATE_PLAYING, GST_STATE_CHANGE_SUCCESS);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    GST_BUFFER_OFFSET (buffer) = i;
+    gst_buffer_list_add (list, buffer);
+  }
+  g_signal_emit_by_name (src, "push-buffer-list", list, &flow_ret);
+  fail_unless_equals_int (flow_ret, GST_FLOW_OK);
+
+  /* the signal does not take ownership of the list */
+  fail_unless_equals_int (gst_buffer_list_length (list), 3);
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 3)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  for (l = buffers, i = 0; l; l = l->next, i++)
+    fail_unless_equals_int (GST_BUFFER_OFFSET (l->data), i);
+
+  ASSERT_SET_STATE (src, GST_STATE_NULL, GST_STATE_CHANGE_SUCCESS);
+  cleanup_appsrc (src);
+  gst_buffer_list_unref (list);
+}
+
+GST_END_TEST;
+
 static Suite *
 appsrc_suite (void)
 {
@@ -427,6 +514,8 @@ appsrc_suite (void)
   tcase_add_test (tc_chain, test_appsrc_non_null_caps);
   tcase_add_test (tc_chain, test_appsrc_set_caps_twice);
   tcase_add_test (tc_chain, test_appsrc_caps_in_push_modes);
+  tcase_add_test (tc_chain, test_appsrc_push_buffer_list);
+  tcase_add_test (tc_chain, test_appsrc_push_buffer_list_signal);
 
   if (RUNNING_ON_VALGRIND)
     tcase_add_loop_test (tc_chain, test_appsrc_block_deadlock, 0, 5);
@@ -1501,6 +1501,46 @@ GST_START_TEST (test_preserve_width)
 
 GST_END_TEST;
 
+/* returns the caps with the layout changed */
+static GstCaps *
+set_layout (GstCaps * caps, const gchar * layout)
+{
+  caps = gst_caps_make_writable (caps);
+  gst_caps_set_simple (caps, "layout", G_TYPE_STRING, layout, NULL);
+
+  return caps;
+}
+
+GST_START_TEST (test_layout_conversion)
+{
+  /* interleaved to non-interleaved */
+  {
+    gint16 in[] = { 1, 2, 3, 4, 5, 6 };
+    gint16 out[] = { 1, 3, 5, 2, 4, 6 };
+
+    RUN_CONVERSION ("interleaved to non-interleaved", in,
+        get_int_caps (2, G_BYTE_ORDER, 16, 16, TRUE), out,
+        set_layout (get_int_caps (2, G_BYTE_ORDER, 16, 16, TRUE),
+            "non-interleaved"));
+    RUN_CONVERSION ("non-interleaved to interleaved", out,
+        set_layout (get_int_caps (2, G_BYTE_ORDER, 16, 16, TRUE),
+            "non-interleaved"), in, get_int_caps (2, G_BYTE_ORDER, 16, 16,
+            TRUE));
+  }
+  /* non-interleaved with a format conversion */
+  {
+    gint16 in[] = { 1, 2, 3, 4 };
+    gint32 out[] = { 1 << 16, 3 << 16, 2 << 16, 4 << 16 };
+
+    RUN_CONVERSION ("non-interleaved 16 to interleaved 32", in,
+        set_layout (get_int_caps (2, G_BYTE_ORDER, 16, 16, TRUE),
+            "non-interleaved"), out, get_int_caps (2, G_BYTE_ORDER, 32, 32,
+            TRUE));
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 audioconvert_suite (void)
 {
@@ -1516,6 +1556,7 @@ audioconvert_suite (void)
   tcase_add_test (tc_chain, test_caps_negotiation);
   tcase_add_test (tc_chain, test_convert_undefined_multichannel);
   tcase_add_test (tc_chain, test_preserve_width);
+  tcase_add_test (tc_chain, test_layout_conversion);
 
   return s;
 }
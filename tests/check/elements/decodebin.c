@@ -23,8 +23,12 @@
 # include <config.h>
 #endif
 
+/* for GValueArray */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
 #include <gst/check/gstcheck.h>
 #include <gst/base/gstbaseparse.h>
+#include <gst/base/gstpushsrc.h>
 #include <unistd.h>
 
 static const gchar dummytext[] =
@@ -623,6 +627,383 @@ GST_START_TEST (test_parser_negotiation)
 
 GST_END_TEST;
 
+/* connected after the default handler, whose result is used, so it never
+ * runs but still counts as a connected handler */
+static GValueArray *
+plan_cache_autoplug_factories_cb (GstElement * dec, GstPad * pad,
+    GstCaps * caps, gpointer user_data)
+{
+  return NULL;
+}
+
+/* counts emissions without connecting a handler, which would disable the
+ * plan cache */
+static gboolean
+plan_cache_emission_hook (GSignalInvocationHint * ihint, guint n_params,
+    const GValue * params, gpointer user_data)
+{
+  guint *count = user_data;
+
+  *count += 1;
+
+  return TRUE;
+}
+
+/*** fakeh264:// source ***/
+
+static GstURIType
+gst_fake_h264_src_uri_get_type (GType type)
+{
+  return GST_URI_SRC;
+}
+
+static const gchar *const *
+gst_fake_h264_src_uri_get_protocols (GType type)
+{
+  static const gchar *protocols[] = { "fakeh264", NULL };
+
+  return protocols;
+}
+
+static gchar *
+gst_fake_h264_src_uri_get_uri (GstURIHandler * handler)
+{
+  return g_strdup ("fakeh264://");
+}
+
+static gboolean
+gst_fake_h264_src_uri_set_uri (GstURIHandler * handler, const gchar * uri,
+    GError ** error)
+{
+  return (uri != NULL && g_str_has_prefix (uri, "fakeh264:"));
+}
+
+static void
+gst_fake_h264_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
+{
+  GstURIHandlerInterface *iface = (GstURIHandlerInterface *) g_iface;
+
+  iface->get_type = gst_fake_h264_src_uri_get_type;
+  iface->get_protocols = gst_fake_h264_src_uri_get_protocols;
+  iface->get_uri = gst_fake_h264_src_uri_get_uri;
+  iface->set_uri = gst_fake_h264_src_uri_set_uri;
+}
+
+static void
+gst_fake_h264_src_init_type (GType type)
+{
+  static const GInterfaceInfo uri_hdlr_info = {
+    gst_fake_h264_src_uri_handler_init, NULL, NULL
+  };
+
+  g_type_add_interface_static (type, GST_TYPE_URI_HANDLER, &uri_hdlr_info);
+}
+
+typedef GstPushSrc GstFakeH264Src;
+typedef GstPushSrcClass GstFakeH264SrcClass;
+
+G_DEFINE_TYPE_WITH_CODE (GstFakeH264Src, gst_fake_h264_src,
+    GST_TYPE_PUSH_SRC, gst_fake_h264_src_init_type (g_define_type_id));
+
+static GstFlowReturn
+gst_fake_h264_src_create (GstPushSrc * src, GstBuffer ** p_buf)
+{
+  *p_buf = gst_buffer_new_allocate (NULL, 64, NULL);
+  gst_buffer_memset (*p_buf, 0, 0, 64);
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_fake_h264_src_class_init (GstFakeH264SrcClass * klass)
+{
+  GstPushSrcClass *pushsrc_class = GST_PUSH_SRC_CLASS (klass);
+  static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC, GST_PAD_ALWAYS,
+      GST_STATIC_CAPS ("video/x-h264")
+      );
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&src_templ));
+  gst_element_class_set_metadata (element_class,
+      "Fake H264 Src", "Source/Video", "yep", "me");
+
+  pushsrc_class->create = gst_fake_h264_src_create;
+}
+
+static void
+gst_fake_h264_src_init (GstFakeH264Src * src)
+{
+  g_object_set (src, "num-buffers", 5, NULL);
+}
+
+static guint
+run_plan_cache_pipeline (gboolean use_uridecodebin, gboolean connect_handler)
+{
+  GstMessage *msg;
+  GstCaps *caps;
+  GstElement *pipe, *src, *filter, *dec;
+  guint count = 0;
+  guint signal_id;
+  gulong hook_id;
+
+  pipe = gst_pipeline_new (NULL);
+
+  /* the handlers of uridecodebin are checked, not the ones it connects to
+   * its decodebin to forward the signals */
+  if (use_uridecodebin) {
+    dec = gst_element_factory_make ("uridecodebin", NULL);
+    fail_unless (dec != NULL);
+    g_object_set (dec, "uri", "fakeh264://", NULL);
+  } else {
+    dec = gst_element_factory_make ("decodebin", NULL);
+    fail_unless (dec != NULL);
+  }
+  g_object_set (dec, "use-plan-cache", TRUE, NULL);
+
+  g_signal_connect (dec, "pad-added",
+      G_CALLBACK (parser_negotiation_pad_added_cb), pipe);
+  if (connect_handler)
+    g_signal_connect_after (dec, "autoplug-factories",
+        G_CALLBACK (plan_cache_autoplug_factories_cb), NULL);
+
+  signal_id = g_signal_lookup ("autoplug-factories", G_OBJECT_TYPE (dec));
+  hook_id = g_signal_add_emission_hook (signal_id, 0,
+      plan_cache_emission_hook, &count, NULL);
+
+  if (use_uridecodebin) {
+    gst_bin_add (GST_BIN (pipe), dec);
+  } else {
+    src = gst_element_factory_make ("fakesrc", NULL);
+    fail_unless (src != NULL);
+    g_object_set (G_OBJECT (src), "num-buffers", 5, "sizetype", 2,
+        "filltype", 2, "can-activate-pull", FALSE, NULL);
+
+    filter = gst_element_factory_make ("capsfilter", NULL);
+    fail_unless (filter != NULL);
+    caps = gst_caps_from_string ("video/x-h264");
+    g_object_set (G_OBJECT (filter), "caps", caps, NULL);
+    gst_caps_unref (caps);
+
+    gst_bin_add_many (GST_BIN (pipe), src, filter, dec, NULL);
+    gst_element_link_many (src, filter, dec, NULL);
+  }
+
+  fail_unless_equals_int (gst_element_set_state (pipe, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  /* wait for EOS or error */
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipe),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  g_signal_remove_emission_hook (signal_id, hook_id);
+  gst_object_unref (pipe);
+
+  return count;
+}
+
+GST_START_TEST (test_plan_cache)
+{
+  guint first, second, third;
+
+  gst_element_register (NULL, "fakeh264parse", GST_RANK_PRIMARY + 101,
+      gst_fake_h264_parser_get_type ());
+  gst_element_register (NULL, "fakeh264dec", GST_RANK_PRIMARY + 100,
+      gst_fake_h264_decoder_get_type ());
+
+  /* the first run fills the plan cache, the second one replays the parser
+   * for the typefind caps without asking for the factories */
+  first = run_plan_cache_pipeline (FALSE, FALSE);
+  second = run_plan_cache_pipeline (FALSE, FALSE);
+  fail_unless (first > 0);
+  fail_unless (second < first, "%u factory lookups, expected less than %u",
+      second, first);
+
+  /* the factories might be filtered by the handler, nothing is replayed */
+  third = run_plan_cache_pipeline (FALSE, TRUE);
+  fail_unless_equals_int (third, first);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_plan_cache_uridecodebin)
+{
+  guint first, second, third;
+
+  gst_element_register (NULL, "fakeh264parse", GST_RANK_PRIMARY + 101,
+      gst_fake_h264_parser_get_type ());
+  gst_element_register (NULL, "fakeh264dec", GST_RANK_PRIMARY + 100,
+      gst_fake_h264_decoder_get_type ());
+  gst_element_register (NULL, "fakeh264src", GST_RANK_PRIMARY,
+      gst_fake_h264_src_get_type ());
+
+  first = run_plan_cache_pipeline (TRUE, FALSE);
+  second = run_plan_cache_pipeline (TRUE, FALSE);
+  fail_unless (first > 0);
+  fail_unless (second < first, "%u factory lookups, expected less than %u",
+      second, first);
+
+  third = run_plan_cache_pipeline (TRUE, TRUE);
+  fail_unless_equals_int (third, first);
+}
+
+GST_END_TEST;
+
+/*** factory index ***/
+
+typedef GstElement GstIndexAnyDecoder;
+typedef GstElementClass GstIndexAnyDecoderClass;
+
+static GType gst_index_any_decoder_get_type (void);
+static GType gst_index_fake_decoder_get_type (void);
+
+G_DEFINE_TYPE (GstIndexAnyDecoder, gst_index_any_decoder, GST_TYPE_ELEMENT);
+
+static void
+gst_index_any_decoder_class_init (GstIndexAnyDecoderClass * klass)
+{
+  static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+  gst_element_class_add_pad_template (klass,
+      gst_static_pad_template_get (&sink_templ));
+  gst_element_class_set_metadata (klass,
+      "IndexAnyDecoder", "Codec/Decoder/Video", "yep", "me");
+}
+
+static void
+gst_index_any_decoder_init (GstIndexAnyDecoder * self)
+{
+}
+
+typedef GstElement GstIndexFakeDecoder;
+typedef GstElementClass GstIndexFakeDecoderClass;
+
+G_DEFINE_TYPE (GstIndexFakeDecoder, gst_index_fake_decoder, GST_TYPE_ELEMENT);
+
+static void
+gst_index_fake_decoder_class_init (GstIndexFakeDecoderClass * klass)
+{
+  static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK, GST_PAD_ALWAYS,
+      GST_STATIC_CAPS ("video/x-fake-index; video/x-fake-index-alt"));
+
+  gst_element_class_add_pad_template (klass,
+      gst_static_pad_template_get (&sink_templ));
+  gst_element_class_set_metadata (klass,
+      "IndexFakeDecoder", "Codec/Decoder/Video", "yep", "me");
+}
+
+static void
+gst_index_fake_decoder_init (GstIndexFakeDecoder * self)
+{
+}
+
+/* the autoplugging order of decodebin: parsers first, then by rank */
+static gint
+factory_index_compare (gconstpointer p1, gconstpointer p2)
+{
+  gboolean is_parser1, is_parser2;
+
+  is_parser1 = gst_element_factory_list_is_type ((GstElementFactory *) p1,
+      GST_ELEMENT_FACTORY_TYPE_PARSER);
+  is_parser2 = gst_element_factory_list_is_type ((GstElementFactory *) p2,
+      GST_ELEMENT_FACTORY_TYPE_PARSER);
+
+  if (is_parser1 != is_parser2)
+    return is_parser1 ? -1 : 1;
+
+  return gst_plugin_feature_rank_compare_func (p1, p2);
+}
+
+/* checks that the indexed autoplug-factories result of @dec for @caps_str
+ * is the list filtered from all decodable factories without an index, and
+ * returns whether @name is in it */
+static gboolean
+check_factory_index (GstElement * dec, const gchar * caps_str,
+    const gchar * name)
+{
+  GValueArray *factories = NULL;
+  GList *all, *expected, *l;
+  gboolean found = FALSE;
+  GstCaps *caps;
+  GstPad *pad;
+  guint i;
+
+  caps = gst_caps_from_string (caps_str);
+  pad = gst_pad_new ("sink", GST_PAD_SINK);
+  g_signal_emit_by_name (dec, "autoplug-factories", pad, caps, &factories);
+  gst_object_unref (pad);
+  fail_unless (factories != NULL);
+
+  all = gst_element_factory_list_get_elements
+      (GST_ELEMENT_FACTORY_TYPE_DECODABLE, GST_RANK_MARGINAL);
+  all = g_list_sort (all, factory_index_compare);
+  expected = gst_element_factory_list_filter (all, caps, GST_PAD_SINK,
+      gst_caps_is_fixed (caps));
+  gst_plugin_feature_list_free (all);
+
+  fail_unless_equals_int (factories->n_values, g_list_length (expected));
+  for (i = 0, l = expected; l; i++, l = l->next) {
+    GstPluginFeature *factory =
+        g_value_get_object (g_value_array_get_nth (factories, i));
+
+    fail_unless (factory == l->data, "%s: got %s at %u, expected %s",
+        caps_str, GST_OBJECT_NAME (factory), i, GST_OBJECT_NAME (l->data));
+    if (g_strcmp0 (GST_OBJECT_NAME (factory), name) == 0)
+      found = TRUE;
+  }
+
+  gst_plugin_feature_list_free (expected);
+  g_value_array_free (factories);
+  gst_caps_unref (caps);
+
+  return found;
+}
+
+GST_START_TEST (test_factory_index)
+{
+  GstElement *dec;
+
+  dec = gst_element_factory_make ("decodebin", NULL);
+  fail_unless (dec != NULL);
+
+  fail_if (check_factory_index (dec, "video/x-fake-index", "indexanydec"));
+  check_factory_index (dec, "audio/mpeg, mpegversion=(int) 1", NULL);
+  check_factory_index (dec, "video/x-h264; audio/x-raw", NULL);
+
+  /* new features invalidate the index, factories with ANY sink caps are
+   * candidates for all caps */
+  gst_element_register (NULL, "indexanydec", GST_RANK_MARGINAL,
+      gst_index_any_decoder_get_type ());
+  fail_unless (check_factory_index (dec, "video/x-fake-index",
+          "indexanydec"));
+  fail_unless (check_factory_index (dec, "audio/mpeg, mpegversion=(int) 1",
+          "indexanydec"));
+
+  /* factories are found by any of the structure names of their caps */
+  fail_if (check_factory_index (dec, "video/x-fake-index-alt",
+          "indexfakedec"));
+  gst_element_register (NULL, "indexfakedec", GST_RANK_PRIMARY,
+      gst_index_fake_decoder_get_type ());
+  fail_unless (check_factory_index (dec, "video/x-fake-index",
+          "indexfakedec"));
+  fail_unless (check_factory_index (dec, "video/x-fake-index-alt",
+          "indexfakedec"));
+  fail_unless (check_factory_index (dec,
+          "audio/x-raw; video/x-fake-index-alt", "indexfakedec"));
+  fail_if (check_factory_index (dec, "video/x-h264", "indexfakedec"));
+
+  gst_object_unref (dec);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_buffering_aggregation)
 {
   GstElement *pipe, *decodebin;
@@ -727,6 +1108,9 @@ decodebin_suite (void)
   tcase_add_test (tc_chain, test_reuse_without_decoders);
   tcase_add_test (tc_chain, test_mp3_parser_loop);
   tcase_add_test (tc_chain, test_parser_negotiation);
+  tcase_add_test (tc_chain, test_plan_cache);
+  tcase_add_test (tc_chain, test_plan_cache_uridecodebin);
+  tcase_add_test (tc_chain, test_factory_index);
   tcase_add_test (tc_chain, test_buffering_aggregation);
 
   return s;
@@ -20,6 +20,10 @@
  * Boston, MA 02110-1301, USA.
  */
 
+/* for GValueArray */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
+#include <math.h>
 #include <unistd.h>
 
 #include <gst/base/gstbasetransform.h>
@@ -74,6 +78,13 @@ static GstPad *mysrcpad, *mysinkpad;
     "rate = (int) 44100,"               \
     "layout = (string) interleaved"
 
+#define VOLUME_CAPS_STRING_S16_STEREO   \
+    "audio/x-raw, "                     \
+    "format = (string) "FORMATS3", "   \
+    "channels = (int) 2, "              \
+    "rate = (int) 44100,"               \
+    "layout = (string) interleaved"
+
 #define VOLUME_CAPS_STRING_S24          \
     "audio/x-raw, "                     \
     "format = (string) "FORMATS4", "   \
@@ -1862,6 +1873,200 @@ GST_START_TEST (test_controller_defaults_at_ts0)
 
 GST_END_TEST;
 
+GST_START_TEST (test_channel_volumes_s16)
+{
+  GstElement *volume;
+  GstBuffer *inbuffer;
+  GstBuffer *outbuffer;
+  GstCaps *caps;
+  gint16 in[4] = { 16384, -256, 16384, -256 };
+  gint16 out[4] = { 8192, -512, 8192, -512 };
+  GValueArray *array;
+  GValue v = G_VALUE_INIT;
+  GstMapInfo map;
+
+  volume = setup_volume ();
+
+  array = g_value_array_new (2);
+  g_value_init (&v, G_TYPE_DOUBLE);
+  g_value_set_double (&v, 0.5);
+  g_value_array_append (array, &v);
+  g_value_set_double (&v, 2.0);
+  g_value_array_append (array, &v);
+  g_value_unset (&v);
+  g_object_set (G_OBJECT (volume), "channel-volumes", array, NULL);
+  g_value_array_free (array);
+
+  g_object_get (G_OBJECT (volume), "channel-volumes", &array, NULL);
+  fail_unless_equals_int (array->n_values, 2);
+  fail_unless_equals_float (g_value_get_double (g_value_array_get_nth (array,
+              1)), 2.0);
+  g_value_array_free (array);
+
+  fail_unless (gst_element_set_state (volume,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = gst_buffer_new_and_alloc (8);
+  gst_buffer_fill (inbuffer, 0, in, 8);
+  caps = gst_caps_from_string (VOLUME_CAPS_STRING_S16_STEREO);
+  gst_check_setup_events (mysrcpad, volume, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* unity volume, but the channel volumes disable passthrough */
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_if ((outbuffer = (GstBuffer *) buffers->data) == NULL);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data, out, 8) == 0);
+  gst_buffer_unmap (outbuffer, &map);
+
+  /* cleanup */
+  cleanup_volume (volume);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_controller_ramp)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstElement *volume;
+  GstBuffer *inbuffer, *outbuffer;
+  GstCaps *caps;
+  GstSegment seg;
+  GstMapInfo map;
+  gdouble *out;
+  gint i;
+
+  volume = setup_volume ();
+  g_object_set (volume, "ramp-block-size", 16, NULL);
+
+  cs = gst_interpolation_control_source_new ();
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  gst_object_add_control_binding (GST_OBJECT_CAST (volume),
+      gst_direct_control_binding_new (GST_OBJECT_CAST (volume), "volume", cs));
+
+  /* the value range for volume is 0.0 ... 10.0, raise by 1.0 every 1000
+   * samples. The curve goes past the end of the buffer so that the last
+   * block has a point to interpolate to. */
+  tvcs = (GstTimedValueControlSource *) cs;
+  gst_timed_value_control_source_set (tvcs, 0, 0.0);
+  gst_timed_value_control_source_set (tvcs,
+      gst_util_uint64_scale_int (2000, GST_SECOND, 44100), 0.2);
+
+  fail_unless (gst_element_set_state (volume,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = gst_buffer_new_and_alloc (1000 * sizeof (gdouble));
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < 1000; i++)
+    ((gdouble *) map.data)[i] = 1.0;
+  gst_buffer_unmap (inbuffer, &map);
+  caps = gst_caps_from_string (VOLUME_CAPS_STRING_F64);
+  gst_check_setup_events (mysrcpad, volume, caps, GST_FORMAT_TIME);
+  GST_BUFFER_TIMESTAMP (inbuffer) = 0;
+  gst_caps_unref (caps);
+
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_segment (&seg)) == TRUE);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_if ((outbuffer = (GstBuffer *) buffers->data) == NULL);
+
+  /* the interpolated ramp matches the linear control curve */
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  out = (gdouble *) map.data;
+  for (i = 0; i < 1000; i++)
+    fail_unless (fabs (out[i] - i * 1.0 / 1000) < 1e-3,
+        "sample %d: %f != %f", i, out[i], i * 1.0 / 1000);
+  gst_buffer_unmap (outbuffer, &map);
+
+  gst_object_unref (cs);
+  cleanup_volume (volume);
+}
+
+GST_END_TEST;
+
+
+GST_START_TEST (test_controller_ramp_exponential)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstElement *volume;
+  GstBuffer *inbuffer, *outbuffer;
+  GstCaps *caps;
+  GstSegment seg;
+  GstMapInfo map;
+  GstClockTime interval;
+  gdouble *out, start, end, expected;
+  gint i;
+
+  volume = setup_volume ();
+  g_object_set (volume, "ramp-block-size", 16, NULL);
+  gst_util_set_object_arg (G_OBJECT (volume), "ramp-mode", "exponential");
+
+  cs = gst_interpolation_control_source_new ();
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  gst_object_add_control_binding (GST_OBJECT_CAST (volume),
+      gst_direct_control_binding_new (GST_OBJECT_CAST (volume), "volume", cs));
+
+  /* raise the volume from 0.1 by 1.0 every 1000 samples, the gain must not
+   * start at 0.0 for an exponential ramp */
+  tvcs = (GstTimedValueControlSource *) cs;
+  gst_timed_value_control_source_set (tvcs, 0, 0.01);
+  gst_timed_value_control_source_set (tvcs,
+      gst_util_uint64_scale_int (2000, GST_SECOND, 44100), 0.21);
+
+  fail_unless (gst_element_set_state (volume,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = gst_buffer_new_and_alloc (1000 * sizeof (gdouble));
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < 1000; i++)
+    ((gdouble *) map.data)[i] = 1.0;
+  gst_buffer_unmap (inbuffer, &map);
+  caps = gst_caps_from_string (VOLUME_CAPS_STRING_F64);
+  gst_check_setup_events (mysrcpad, volume, caps, GST_FORMAT_TIME);
+  GST_BUFFER_TIMESTAMP (inbuffer) = 0;
+  gst_caps_unref (caps);
+
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_segment (&seg)) == TRUE);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_if ((outbuffer = (GstBuffer *) buffers->data) == NULL);
+
+  /* the control curve is sampled every block of 16 samples, at the block
+   * interval rounded to nanoseconds. The gains in between follow a
+   * geometric curve, which stays below a straight line inside a block. */
+  interval = gst_util_uint64_scale_int (16, GST_SECOND, 44100);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  out = (gdouble *) map.data;
+  for (i = 0; i < 1000; i++) {
+    start = 0.1 + 44.1 * (i / 16) * interval / GST_SECOND;
+    end = 0.1 + 44.1 * (i / 16 + 1) * interval / GST_SECOND;
+    expected = start * pow (end / start, (i % 16) / 16.0);
+
+    fail_unless (fabs (out[i] - expected) < 1e-6,
+        "sample %d: %f != %f", i, out[i], expected);
+    if (i % 16 != 0)
+      fail_unless (out[i] < start + (end - start) * (i % 16) / 16.0,
+          "sample %d: %f not below the linear ramp", i, out[i]);
+  }
+  gst_buffer_unmap (outbuffer, &map);
+
+  gst_object_unref (cs);
+  cleanup_volume (volume);
+}
+
+GST_END_TEST;
 
 static Suite *
 volume_suite (void)
@@ -1906,6 +2111,9 @@ volume_suite (void)
   tcase_add_test (tc_chain, test_controller_usability);
   tcase_add_test (tc_chain, test_controller_processing);
   tcase_add_test (tc_chain, test_controller_defaults_at_ts0);
+  tcase_add_test (tc_chain, test_channel_volumes_s16);
+  tcase_add_test (tc_chain, test_controller_ramp);
+  tcase_add_test (tc_chain, test_controller_ramp_exponential);
 
   return s;
 }
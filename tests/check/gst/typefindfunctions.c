@@ -348,6 +348,145 @@ GST_START_TEST (test_eac3)
 
 GST_END_TEST;
 
+GST_START_TEST (test_mpegts_after_garbage)
+{
+  GstTypeFindProbability prob;
+  GstStructure *st;
+  GstCaps *caps;
+  gint packetsize = 0;
+  guint8 *data;
+  guint i;
+
+  /* the sync scanning has to skip over data without sync bytes and over
+   * sync bytes that are not followed by a valid header */
+  data = g_malloc (1000 + 12 * 192);
+  memset (data, 0x55, 1000);
+  data[100] = 0x47;
+  data[101] = 0x80;
+  memset (data + 1000, 0, 12 * 192);
+  for (i = 0; i < 12; i++) {
+    guint8 *pkt = data + 1000 + i * 192;
+
+    pkt[0] = 0x47;
+    pkt[1] = 0x40;
+    pkt[3] = 0x10;
+  }
+
+  caps = typefind_data (data, 1000 + 12 * 192, &prob);
+  fail_unless (caps != NULL);
+  st = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_has_name (st, "video/mpegts"));
+  fail_unless (gst_structure_get_int (st, "packetsize", &packetsize));
+  fail_unless_equals_int (packetsize, 192);
+  gst_caps_unref (caps);
+
+  g_free (data);
+}
+
+GST_END_TEST;
+
+/* runs a single typefinder on @data and returns its best suggestion */
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  guint prob;
+  GstCaps *caps;
+} TypeFinderCall;
+
+static const guint8 *
+typefinder_call_peek (gpointer data, gint64 offset, guint size)
+{
+  TypeFinderCall *call = data;
+
+  if (offset < 0 || offset + size > call->size)
+    return NULL;
+
+  return call->data + offset;
+}
+
+static void
+typefinder_call_suggest (gpointer data, guint probability, GstCaps * caps)
+{
+  TypeFinderCall *call = data;
+
+  if (probability > call->prob) {
+    gst_caps_replace (&call->caps, caps);
+    call->prob = probability;
+  }
+}
+
+static guint64
+typefinder_call_get_length (gpointer data)
+{
+  return ((TypeFinderCall *) data)->size;
+}
+
+static GstCaps *
+typefinder_call (const gchar * name, const guint8 * data, gsize data_size)
+{
+  GstPluginFeature *feature;
+  TypeFinderCall call = { NULL, 0, 0, NULL };
+  GstTypeFind find = { 0, };
+
+  call.data = data;
+  call.size = data_size;
+
+  feature = gst_registry_lookup_feature (gst_registry_get (), name);
+  fail_unless (feature != NULL, "no %s typefinder", name);
+
+  find.peek = typefinder_call_peek;
+  find.suggest = typefinder_call_suggest;
+  find.get_length = typefinder_call_get_length;
+  find.data = &call;
+  gst_type_find_factory_call_function (GST_TYPE_FIND_FACTORY (feature), &find);
+  gst_object_unref (feature);
+
+  return call.caps;
+}
+
+GST_START_TEST (test_exact_signature)
+{
+  GstTypeFindProbability prob;
+  GstCaps *caps;
+  guint8 *data;
+  guint i;
+
+  /* transport stream packets after a 4 byte prefix */
+  data = g_malloc0 (4 + 10 * 188);
+  memcpy (data, "QQQQ", 4);
+  for (i = 0; i < 10; i++) {
+    guint8 *pkt = data + 4 + i * 188;
+
+    pkt[0] = 0x47;
+    pkt[1] = 0x40;
+    pkt[3] = 0x10;
+  }
+
+  /* the scanner finds the packets behind a prefix that is no signature */
+  caps = typefinder_call ("video/mpegts", data, 4 + 10 * 188);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "video/mpegts"));
+  gst_caps_unref (caps);
+
+  /* but does not scan data that starts with the gym signature */
+  memcpy (data, "GYMX", 4);
+  caps = typefinder_call ("video/mpegts", data, 4 + 10 * 188);
+  fail_unless (caps == NULL);
+
+  caps = typefind_data (data, 4 + 10 * 188, &prob);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "audio/x-gym"));
+  fail_unless_equals_int (prob, GST_TYPE_FIND_MAXIMUM);
+  gst_caps_unref (caps);
+
+  g_free (data);
+}
+
+GST_END_TEST;
+
 #define TEST_RANDOM_DATA_SIZE (4*1024)
 
 /* typefind random data, to make sure all typefinders are called */
@@ -490,6 +629,8 @@ typefindfunctions_suite (void)
   tcase_add_test (tc_chain, test_mpegts);
   tcase_add_test (tc_chain, test_ac3);
   tcase_add_test (tc_chain, test_eac3);
+  tcase_add_test (tc_chain, test_mpegts_after_garbage);
+  tcase_add_test (tc_chain, test_exact_signature);
   tcase_add_test (tc_chain, test_random_data);
   tcase_add_test (tc_chain, test_hls_m3u8);
   tcase_add_test (tc_chain, test_manifest_typefinding);
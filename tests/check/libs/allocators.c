@@ -26,6 +26,7 @@
 #include <gst/check/gstcheck.h>
 
 #include <gst/allocators/gstdmabuf.h>
+#include <gst/allocators/gsthugepagememory.h>
 #include <string.h>
 
 #define FILE_SIZE 4096
@@ -60,6 +61,65 @@ GST_START_TEST (test_dmabuf)
 
 GST_END_TEST;
 
+GST_START_TEST (test_huge_page)
+{
+  GstAllocator *alloc;
+  GstAllocationParams params;
+  GstMemory *mem, *sub, *copy;
+  GstMapInfo info;
+  gsize size = 4 * 1024 * 1024 + 100;
+  gint i;
+
+  alloc = gst_huge_page_allocator_new (GST_HUGE_PAGE_FLAG_EXPLICIT |
+      GST_HUGE_PAGE_FLAG_NUMA_LOCAL);
+
+  gst_allocation_params_init (&params);
+  params.align = 63;
+  params.prefix = 16;
+
+  mem = gst_allocator_alloc (alloc, size, &params);
+  fail_unless (mem != NULL);
+  fail_unless (gst_is_huge_page_memory (mem));
+  fail_unless (mem->offset == 16);
+  fail_unless (mem->size == size);
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_READWRITE));
+  fail_unless (info.size == size);
+  fail_unless ((((guintptr) info.data) - 16) % 64 == 0);
+  for (i = 0; i < 256; i++)
+    info.data[i] = i;
+  gst_memory_unmap (mem, &info);
+
+  sub = gst_memory_share (mem, 10, 20);
+  fail_unless (gst_is_huge_page_memory (sub));
+  fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+  fail_unless (info.size == 20);
+  fail_unless (info.data[0] == 10);
+  gst_memory_unmap (sub, &info);
+  gst_memory_unref (sub);
+
+  copy = gst_memory_copy (mem, 100, -1);
+  fail_unless (gst_is_huge_page_memory (copy));
+  fail_unless (copy->size == size - 100);
+  fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 100);
+  fail_unless (info.data[155] == 255);
+  gst_memory_unmap (copy, &info);
+  gst_memory_unref (copy);
+
+  gst_memory_unref (mem);
+
+  /* small allocations work too */
+  mem = gst_allocator_alloc (alloc, 100, NULL);
+  fail_unless (mem != NULL);
+  fail_unless (mem->size == 100);
+  gst_memory_unref (mem);
+
+  gst_object_unref (alloc);
+}
+
+GST_END_TEST;
+
 static Suite *
 allocators_suite (void)
 {
@@ -68,6 +128,7 @@ allocators_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_dmabuf);
+  tcase_add_test (tc_chain, test_huge_page);
 
   return s;
 }
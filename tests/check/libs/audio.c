@@ -578,6 +578,77 @@ GST_START_TEST (test_multichannel_reorder)
 
 GST_END_TEST;
 
+GST_START_TEST (test_channel_reorder_plan)
+{
+  static const GstAudioChannelPosition from[6] = {
+    GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_CENTER,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_REAR_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_LFE1
+  };
+  static const GstAudioChannelPosition to[6] = {
+    GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_CENTER,
+    GST_AUDIO_CHANNEL_POSITION_LFE1,
+    GST_AUDIO_CHANNEL_POSITION_REAR_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT
+  };
+  static const GstAudioChannelPosition other[6] = {
+    GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_CENTER,
+    GST_AUDIO_CHANNEL_POSITION_LFE1,
+    GST_AUDIO_CHANNEL_POSITION_SIDE_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_SIDE_RIGHT
+  };
+  /* channel of the input that ends up in each output channel */
+  static const gint expected[6] = { 0, 2, 1, 5, 3, 4 };
+  static const GstAudioFormat formats[] = {
+    GST_AUDIO_FORMAT_S8, GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_S24,
+    GST_AUDIO_FORMAT_S32, GST_AUDIO_FORMAT_F64
+  };
+  GstAudioChannelReorder *reorder;
+  guint64 data[10 * 6], ref[10 * 6];
+  guint8 *bytes = (guint8 *) data;
+  gint i, f, c, b;
+
+  fail_unless (gst_audio_channel_reorder_new (GST_AUDIO_FORMAT_S16, 6, from,
+          other) == NULL);
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    const GstAudioFormatInfo *finfo = gst_audio_format_get_info (formats[f]);
+    gint bps = GST_AUDIO_FORMAT_INFO_WIDTH (finfo) / 8;
+    gsize size = 10 * 6 * bps;
+
+    /* every byte of a sample holds its frame and channel */
+    for (i = 0; i < 10; i++)
+      for (c = 0; c < 6; c++)
+        memset (bytes + (i * 6 + c) * bps, i * 16 + c, bps);
+    memcpy (ref, data, size);
+
+    reorder = gst_audio_channel_reorder_new (formats[f], 6, from, to);
+    fail_unless (reorder != NULL);
+    gst_audio_channel_reorder_samples (reorder, data, size);
+    gst_audio_channel_reorder_free (reorder);
+
+    for (i = 0; i < 10; i++)
+      for (c = 0; c < 6; c++)
+        for (b = 0; b < bps; b++)
+          fail_unless_equals_int (bytes[(i * 6 + c) * bps + b],
+              i * 16 + expected[c]);
+
+    /* the one-shot function gives the same result */
+    fail_unless (gst_audio_reorder_channels (ref, size, formats[f], 6, from,
+            to));
+    fail_unless (memcmp (data, ref, size) == 0);
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_audio_info)
 {
   GstAudioFormat fmt;
@@ -612,6 +683,327 @@ GST_START_TEST (test_fill_silence)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pack_unpack)
+{
+  GstAudioFormat f;
+  /* not a multiple of 4 so that the tail of the block loops is tested */
+  const gint n_samples = 37;
+  guint8 packed[37 * 8];
+  gint32 s32[37], r32[37];
+  gdouble f64[37], r64[37];
+  gint i;
+
+  for (f = GST_AUDIO_FORMAT_S8; f <= GST_AUDIO_FORMAT_F64BE; f++) {
+    const GstAudioFormatInfo *finfo = gst_audio_format_get_info (f);
+
+    GST_DEBUG ("testing %s", GST_AUDIO_FORMAT_INFO_NAME (finfo));
+
+    if (finfo->unpack_format == GST_AUDIO_FORMAT_F64) {
+      for (i = 0; i < n_samples; i++) {
+        f64[i] = g_random_double_range (-1.0, 1.0);
+        /* make the value representable in the packed format */
+        if (finfo->width == 32)
+          f64[i] = (gfloat) f64[i];
+      }
+      finfo->pack_func (finfo, 0, f64, packed, n_samples);
+      finfo->unpack_func (finfo, 0, r64, packed, n_samples);
+      fail_unless (memcmp (f64, r64, sizeof (f64)) == 0);
+    } else {
+      guint32 mask = 0xffffffff;
+
+      /* only the most significant depth bits survive a round trip */
+      if (finfo->depth < 32)
+        mask <<= 32 - finfo->depth;
+
+      for (i = 0; i < n_samples; i++)
+        s32[i] = g_random_int () & mask;
+      finfo->pack_func (finfo, 0, s32, packed, n_samples);
+      finfo->unpack_func (finfo, 0, r32, packed, n_samples);
+      fail_unless (memcmp (s32, r32, sizeof (s32)) == 0);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_audio_meta)
+{
+  GstAudioInfo info;
+  GstAudioMeta *meta;
+  GstBuffer *buf, *copy;
+  gsize offsets[2] = { 400, 0 };
+
+  gst_audio_info_set_format (&info, GST_AUDIO_FORMAT_S16, 48000, 2, NULL);
+  info.layout = GST_AUDIO_LAYOUT_NON_INTERLEAVED;
+
+  buf = gst_buffer_new_and_alloc (800);
+
+  /* planes packed back to back */
+  meta = gst_buffer_add_audio_meta (buf, &info, 200, NULL);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (meta->samples, 200);
+  fail_unless (meta->offsets != NULL);
+  fail_unless_equals_int (meta->offsets[0], 0);
+  fail_unless_equals_int (meta->offsets[1], 400);
+  fail_unless (gst_buffer_get_audio_meta (buf) == meta);
+  fail_unless (gst_buffer_remove_meta (buf, (GstMeta *) meta));
+
+  /* explicit offsets are copied along */
+  meta = gst_buffer_add_audio_meta (buf, &info, 200, offsets);
+  fail_unless (meta != NULL);
+  copy = gst_buffer_copy (buf);
+  meta = gst_buffer_get_audio_meta (copy);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (meta->offsets[0], 400);
+  fail_unless_equals_int (meta->offsets[1], 0);
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buf);
+
+  /* interleaved audio has no offsets */
+  info.layout = GST_AUDIO_LAYOUT_INTERLEAVED;
+  buf = gst_buffer_new_and_alloc (800);
+  meta = gst_buffer_add_audio_meta (buf, &info, 200, NULL);
+  fail_unless (meta != NULL);
+  fail_unless (meta->offsets == NULL);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+/* a software ringbuffer, the test plays the device by reading from it in
+ * a separate thread */
+#define GST_TYPE_TEST_RING_BUFFER gst_test_ring_buffer_get_type ()
+static GType gst_test_ring_buffer_get_type (void);
+
+typedef GstAudioRingBuffer GstTestRingBuffer;
+typedef GstAudioRingBufferClass GstTestRingBufferClass;
+
+G_DEFINE_TYPE (GstTestRingBuffer, gst_test_ring_buffer,
+    GST_TYPE_AUDIO_RING_BUFFER);
+
+static gboolean
+gst_test_ring_buffer_open_device (GstAudioRingBuffer * buf)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_test_ring_buffer_close_device (GstAudioRingBuffer * buf)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_test_ring_buffer_acquire (GstAudioRingBuffer * buf,
+    GstAudioRingBufferSpec * spec)
+{
+  buf->size = spec->segtotal * spec->segsize;
+  buf->memory = g_malloc0 (buf->size);
+
+  return TRUE;
+}
+
+static gboolean
+gst_test_ring_buffer_release (GstAudioRingBuffer * buf)
+{
+  g_free (buf->memory);
+  buf->memory = NULL;
+
+  return TRUE;
+}
+
+static gboolean
+gst_test_ring_buffer_start (GstAudioRingBuffer * buf)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_test_ring_buffer_stop (GstAudioRingBuffer * buf)
+{
+  return TRUE;
+}
+
+static void
+gst_test_ring_buffer_class_init (GstTestRingBufferClass * klass)
+{
+  klass->open_device = gst_test_ring_buffer_open_device;
+  klass->close_device = gst_test_ring_buffer_close_device;
+  klass->acquire = gst_test_ring_buffer_acquire;
+  klass->release = gst_test_ring_buffer_release;
+  klass->start = gst_test_ring_buffer_start;
+  klass->stop = gst_test_ring_buffer_stop;
+}
+
+static void
+gst_test_ring_buffer_init (GstTestRingBuffer * buf)
+{
+}
+
+/* never 0 so that cleared segments can be told apart */
+#define RING_SAMPLE_VALUE(pos) ((gint16) ((pos) % 32767 + 1))
+#define RING_TOTAL_SAMPLES (44100 / 5)
+
+static volatile gint reader_running;
+static volatile gint reader_stalled;
+static volatile gint reader_samples;
+static volatile gint reader_errors;
+
+static gpointer
+ring_buffer_reader (gpointer data)
+{
+  GstAudioRingBuffer *buf = data;
+  guint64 pos = 0;
+  gint segment, len, i;
+  guint8 *ptr;
+
+  while (g_atomic_int_get (&reader_running)) {
+    if (g_atomic_int_get (&reader_stalled) ||
+        !gst_audio_ring_buffer_prepare_read (buf, &segment, &ptr, &len)) {
+      g_usleep (100);
+      continue;
+    }
+    /* consume the segment at about the pace of a device */
+    g_usleep (500);
+
+    for (i = 0; i < len / 2; i++, pos++) {
+      gint16 val = ((gint16 *) ptr)[i];
+
+      if (val == 0)
+        continue;
+      if (val != RING_SAMPLE_VALUE (pos))
+        g_atomic_int_inc (&reader_errors);
+      g_atomic_int_inc (&reader_samples);
+    }
+    gst_audio_ring_buffer_clear (buf, segment);
+    gst_audio_ring_buffer_advance (buf, 1);
+  }
+
+  return NULL;
+}
+
+static volatile gint writer_done;
+static guint64 writer_position;
+static guint writer_written;
+
+static gpointer
+ring_buffer_blocked_writer (gpointer data)
+{
+  GstAudioRingBuffer *buf = data;
+  gint16 samples[1024] = { 0, };
+  gint accum = 0, i;
+
+  for (i = 0; i < G_N_ELEMENTS (samples); i++)
+    samples[i] = 1;
+
+  /* a full ringbuffer ahead of the stalled reader */
+  writer_written = gst_audio_ring_buffer_commit (buf, &writer_position,
+      (guint8 *) samples,
+      G_N_ELEMENTS (samples), G_N_ELEMENTS (samples), &accum);
+  g_atomic_int_set (&writer_done, 1);
+
+  return NULL;
+}
+
+static void
+run_ring_buffer (gboolean lock_free)
+{
+  GstAudioRingBuffer *buf;
+  GstAudioInfo info;
+  GstCaps *caps;
+  GThread *reader, *writer;
+  gint16 samples[100];
+  guint64 pos = 0;
+  gint accum, i, waited;
+
+  buf = g_object_new (GST_TYPE_TEST_RING_BUFFER, NULL);
+  fail_unless (gst_audio_ring_buffer_set_lock_free (buf, lock_free));
+  fail_unless_equals_int (gst_audio_ring_buffer_get_lock_free (buf),
+      lock_free);
+
+  fail_unless (gst_audio_ring_buffer_open_device (buf));
+  gst_audio_info_set_format (&info, GST_AUDIO_FORMAT_S16, 44100, 1, NULL);
+  caps = gst_audio_info_to_caps (&info);
+  buf->spec.buffer_time = 8000;
+  buf->spec.latency_time = 1000;
+  fail_unless (gst_audio_ring_buffer_parse_caps (&buf->spec, caps));
+  gst_caps_unref (caps);
+  fail_unless (gst_audio_ring_buffer_acquire (buf, &buf->spec));
+  fail_unless_equals_int (buf->spec.segtotal, 8);
+  gst_audio_ring_buffer_may_start (buf, TRUE);
+
+  g_atomic_int_set (&reader_running, 1);
+  g_atomic_int_set (&reader_stalled, 0);
+  g_atomic_int_set (&reader_samples, 0);
+  g_atomic_int_set (&reader_errors, 0);
+  reader = g_thread_new ("reader", ring_buffer_reader, buf);
+
+  /* the first commit starts the ringbuffer, the writer then keeps waiting
+   * for the reader to free segments. Committing advances pos. */
+  while (pos < RING_TOTAL_SAMPLES) {
+    for (i = 0; i < G_N_ELEMENTS (samples); i++)
+      samples[i] = RING_SAMPLE_VALUE (pos + i);
+    accum = 0;
+    fail_unless_equals_int (gst_audio_ring_buffer_commit (buf, &pos,
+            (guint8 *) samples, G_N_ELEMENTS (samples),
+            G_N_ELEMENTS (samples), &accum), G_N_ELEMENTS (samples));
+  }
+  fail_unless_equals_int (g_atomic_int_get (&buf->state),
+      GST_AUDIO_RING_BUFFER_STATE_STARTED);
+
+  for (waited = 0; waited < 5000 &&
+      g_atomic_int_get (&reader_samples) < RING_TOTAL_SAMPLES; waited++)
+    g_usleep (1000);
+  fail_unless_equals_int (g_atomic_int_get (&reader_samples),
+      RING_TOTAL_SAMPLES);
+  fail_unless_equals_int (g_atomic_int_get (&reader_errors), 0);
+
+  /* a writer waiting for space is woken up by stopping */
+  g_atomic_int_set (&reader_stalled, 1);
+  g_usleep (1000);
+  writer_position = (g_atomic_int_get (&buf->segdone) - buf->segbase +
+      buf->spec.segtotal) * buf->samples_per_seg;
+  g_atomic_int_set (&writer_done, 0);
+  writer = g_thread_new ("writer", ring_buffer_blocked_writer, buf);
+  g_usleep (50000);
+  fail_if (g_atomic_int_get (&writer_done));
+
+  fail_unless (gst_audio_ring_buffer_stop (buf));
+  g_thread_join (writer);
+  fail_unless (writer_written < 1024);
+
+  g_atomic_int_set (&reader_running, 0);
+  g_thread_join (reader);
+
+  fail_unless (gst_audio_ring_buffer_release (buf));
+  fail_unless (gst_audio_ring_buffer_close_device (buf));
+  gst_object_unref (buf);
+}
+
+GST_START_TEST (test_ring_buffer)
+{
+  run_ring_buffer (FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ring_buffer_lock_free)
+{
+#ifdef __linux__
+  run_ring_buffer (TRUE);
+#else
+  GstAudioRingBuffer *buf;
+
+  /* lock-free wakeups need futexes */
+  buf = g_object_new (GST_TYPE_TEST_RING_BUFFER, NULL);
+  fail_if (gst_audio_ring_buffer_set_lock_free (buf, TRUE));
+  fail_if (gst_audio_ring_buffer_get_lock_free (buf));
+  gst_object_unref (buf);
+#endif
+}
+
+GST_END_TEST;
+
 static Suite *
 audio_suite (void)
 {
@@ -625,7 +1017,12 @@ audio_suite (void)
   tcase_add_test (tc_chain, test_buffer_clipping_samples);
   tcase_add_test (tc_chain, test_multichannel_checks);
   tcase_add_test (tc_chain, test_multichannel_reorder);
+  tcase_add_test (tc_chain, test_channel_reorder_plan);
   tcase_add_test (tc_chain, test_fill_silence);
+  tcase_add_test (tc_chain, test_pack_unpack);
+  tcase_add_test (tc_chain, test_audio_meta);
+  tcase_add_test (tc_chain, test_ring_buffer);
+  tcase_add_test (tc_chain, test_ring_buffer_lock_free);
 
   return s;
 }
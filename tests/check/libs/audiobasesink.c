@@ -0,0 +1,379 @@
+/* GStreamer
+ *
+ * unit tests for GstAudioBaseSink
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
+
+static GstPad *mysrcpad;
+static GstElement *sink;
+
+#define TEST_AUDIO_RATE 44100
+#define TEST_AUDIO_FORMAT "S16LE"
+/* frames reported as queued in the device */
+#define TEST_DELAY_FRAMES 441
+#define TEST_BUFFER_FRAMES 441
+#define NUM_BUFFERS 20
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw, format=(string)" TEST_AUDIO_FORMAT
+        ", rate=(int)44100, channels=(int)1, layout=(string)interleaved")
+    );
+
+#define GST_AUDIO_SINK_TESTER_TYPE gst_audio_sink_tester_get_type()
+static GType gst_audio_sink_tester_get_type (void);
+
+typedef struct _GstAudioSinkTester GstAudioSinkTester;
+typedef struct _GstAudioSinkTesterClass GstAudioSinkTesterClass;
+
+struct _GstAudioSinkTester
+{
+  GstAudioSink parent;
+
+  gint bpf;
+  gint rate;
+
+  /* grow the reported delay with every query */
+  gboolean growing_delay;
+  guint delay_queries;
+};
+
+struct _GstAudioSinkTesterClass
+{
+  GstAudioSinkClass parent_class;
+};
+
+G_DEFINE_TYPE (GstAudioSinkTester, gst_audio_sink_tester, GST_TYPE_AUDIO_SINK);
+
+static gboolean
+gst_audio_sink_tester_open (GstAudioSink * asink)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_audio_sink_tester_prepare (GstAudioSink * asink,
+    GstAudioRingBufferSpec * spec)
+{
+  GstAudioSinkTester *tester = (GstAudioSinkTester *) asink;
+
+  tester->bpf = GST_AUDIO_INFO_BPF (&spec->info);
+  tester->rate = GST_AUDIO_INFO_RATE (&spec->info);
+
+  return TRUE;
+}
+
+static gboolean
+gst_audio_sink_tester_unprepare (GstAudioSink * asink)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_audio_sink_tester_close (GstAudioSink * asink)
+{
+  return TRUE;
+}
+
+static gint
+gst_audio_sink_tester_write (GstAudioSink * asink, gpointer data, guint length)
+{
+  GstAudioSinkTester *tester = (GstAudioSinkTester *) asink;
+
+  /* consume the samples in real time like a device would */
+  g_usleep (gst_util_uint64_scale_int (length / tester->bpf, G_USEC_PER_SEC,
+          tester->rate));
+
+  return length;
+}
+
+static guint
+gst_audio_sink_tester_delay (GstAudioSink * asink)
+{
+  GstAudioSinkTester *tester = (GstAudioSinkTester *) asink;
+
+  if (tester->growing_delay)
+    return TEST_DELAY_FRAMES + 10 * tester->delay_queries++;
+
+  return TEST_DELAY_FRAMES;
+}
+
+static void
+gst_audio_sink_tester_reset (GstAudioSink * asink)
+{
+}
+
+static void
+gst_audio_sink_tester_class_init (GstAudioSinkTesterClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstAudioSinkClass *audiosink_class = GST_AUDIO_SINK_CLASS (klass);
+
+  static GstStaticPadTemplate sink_templ = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK, GST_PAD_ALWAYS,
+      GST_STATIC_CAPS ("audio/x-raw"));
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_templ));
+
+  gst_element_class_set_metadata (element_class,
+      "AudioSinkTester", "Sink/Audio", "yep", "me");
+
+  audiosink_class->open = gst_audio_sink_tester_open;
+  audiosink_class->prepare = gst_audio_sink_tester_prepare;
+  audiosink_class->unprepare = gst_audio_sink_tester_unprepare;
+  audiosink_class->close = gst_audio_sink_tester_close;
+  audiosink_class->write = gst_audio_sink_tester_write;
+  audiosink_class->delay = gst_audio_sink_tester_delay;
+  audiosink_class->reset = gst_audio_sink_tester_reset;
+}
+
+static void
+gst_audio_sink_tester_init (GstAudioSinkTester * tester)
+{
+}
+
+static void
+setup_audiosinktester (gboolean low_latency)
+{
+  GstSegment segment;
+  GstCaps *caps;
+
+  sink = g_object_new (GST_AUDIO_SINK_TESTER_TYPE, "sync", FALSE,
+      "low-latency", low_latency, NULL);
+  mysrcpad = gst_check_setup_src_pad (sink, &srctemplate);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("test")));
+  caps = gst_static_pad_template_get_caps (&srctemplate);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+}
+
+static void
+cleanup_audiosinktester (void)
+{
+  gst_element_set_state (sink, GST_STATE_NULL);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (sink);
+  gst_check_teardown_element (sink);
+}
+
+static void
+push_buffers (guint n)
+{
+  GstBuffer *buffer;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    buffer = gst_buffer_new_allocate (NULL, TEST_BUFFER_FRAMES * 2, NULL);
+    gst_buffer_memset (buffer, 0, 0, TEST_BUFFER_FRAMES * 2);
+    GST_BUFFER_PTS (buffer) = gst_util_uint64_scale_int (i * TEST_BUFFER_FRAMES,
+        GST_SECOND, TEST_AUDIO_RATE);
+    GST_BUFFER_DURATION (buffer) = gst_util_uint64_scale_int
+        (TEST_BUFFER_FRAMES, GST_SECOND, TEST_AUDIO_RATE);
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+}
+
+static guint64
+get_uint64 (const GstStructure * s, const gchar * field)
+{
+  guint64 val = 0;
+
+  fail_unless (gst_structure_get_uint64 (s, field, &val), "no field %s",
+      field);
+
+  return val;
+}
+
+GST_START_TEST (test_stats)
+{
+  GstStructure *stats;
+  const GValue *bounds, *hist;
+  GstClockTime delay;
+  guint64 sum = 0;
+  guint i;
+
+  sink = g_object_new (GST_AUDIO_SINK_TESTER_TYPE, NULL);
+
+  /* nothing rendered yet, no delay known */
+  g_object_get (sink, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_has_name (stats,
+          "application/x-audio-base-sink-stats"));
+  fail_unless_equals_uint64 (get_uint64 (stats, "underruns"), 0);
+  fail_unless_equals_uint64 (get_uint64 (stats, "renders"), 0);
+  fail_unless_equals_uint64 (get_uint64 (stats, "delay"), GST_CLOCK_TIME_NONE);
+  fail_unless_equals_uint64 (get_uint64 (stats, "min-delay"),
+      GST_CLOCK_TIME_NONE);
+  fail_unless_equals_uint64 (get_uint64 (stats, "max-delay"),
+      GST_CLOCK_TIME_NONE);
+  gst_structure_free (stats);
+  gst_object_unref (sink);
+
+  setup_audiosinktester (FALSE);
+  push_buffers (NUM_BUFFERS);
+
+  g_object_get (sink, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+
+  fail_unless_equals_uint64 (get_uint64 (stats, "renders"), NUM_BUFFERS);
+
+  /* the delay is sampled from the device when the stats are read */
+  delay = gst_util_uint64_scale_int (TEST_DELAY_FRAMES, GST_SECOND,
+      TEST_AUDIO_RATE);
+  fail_unless_equals_uint64 (get_uint64 (stats, "delay"), delay);
+  fail_unless_equals_uint64 (get_uint64 (stats, "min-delay"), delay);
+  fail_unless_equals_uint64 (get_uint64 (stats, "max-delay"), delay);
+
+  bounds = gst_structure_get_value (stats, "jitter-bounds");
+  hist = gst_structure_get_value (stats, "jitter-histogram");
+  fail_unless (GST_VALUE_HOLDS_ARRAY (bounds));
+  fail_unless (GST_VALUE_HOLDS_ARRAY (hist));
+  fail_unless_equals_int (gst_value_array_get_size (hist),
+      gst_value_array_get_size (bounds) + 1);
+
+  for (i = 0; i < gst_value_array_get_size (bounds); i++) {
+    const GValue *v = gst_value_array_get_value (bounds, i);
+
+    fail_unless (G_VALUE_HOLDS_UINT64 (v));
+    if (i > 0)
+      fail_unless (g_value_get_uint64 (v) >
+          g_value_get_uint64 (gst_value_array_get_value (bounds, i - 1)));
+  }
+
+  /* every render but the first is accounted in the histogram */
+  for (i = 0; i < gst_value_array_get_size (hist); i++)
+    sum += g_value_get_uint64 (gst_value_array_get_value (hist, i));
+  fail_unless (sum > 0);
+  fail_unless (sum < NUM_BUFFERS);
+
+  gst_structure_free (stats);
+
+  cleanup_audiosinktester ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stats_delay_range)
+{
+  GstStructure *stats;
+
+  setup_audiosinktester (FALSE);
+  ((GstAudioSinkTester *) sink)->growing_delay = TRUE;
+  push_buffers (NUM_BUFFERS);
+
+  /* read once, the range must still cover the delays seen while
+   * rendering */
+  g_object_get (sink, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (get_uint64 (stats, "min-delay") <
+      get_uint64 (stats, "max-delay"));
+  fail_unless_equals_uint64 (get_uint64 (stats, "delay"),
+      get_uint64 (stats, "max-delay"));
+  gst_structure_free (stats);
+
+  cleanup_audiosinktester ();
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_low_latency)
+{
+  GstAudioRingBuffer *ringbuffer;
+  GstStructure *stats;
+  gboolean low_latency;
+  guint64 buffer_time, latency_time;
+
+  /* default profile */
+  sink = g_object_new (GST_AUDIO_SINK_TESTER_TYPE, NULL);
+  g_object_get (sink, "low-latency", &low_latency, NULL);
+  fail_if (low_latency);
+  g_object_set (sink, "low-latency", TRUE, NULL);
+  g_object_get (sink, "low-latency", &low_latency, NULL);
+  fail_unless (low_latency);
+  gst_object_unref (sink);
+
+  setup_audiosinktester (FALSE);
+  push_buffers (2);
+
+  ringbuffer = GST_AUDIO_BASE_SINK (sink)->ringbuffer;
+  fail_if (gst_audio_ring_buffer_get_lock_free (ringbuffer));
+  g_object_get (sink, "buffer-time", &buffer_time, "latency-time",
+      &latency_time, NULL);
+  fail_unless_equals_uint64 (ringbuffer->spec.buffer_time, buffer_time);
+  fail_unless_equals_uint64 (ringbuffer->spec.latency_time, latency_time);
+
+  cleanup_audiosinktester ();
+
+  /* low-latency profile, the segments are capped but the properties keep
+   * their values */
+  setup_audiosinktester (TRUE);
+  push_buffers (NUM_BUFFERS);
+
+  ringbuffer = GST_AUDIO_BASE_SINK (sink)->ringbuffer;
+#ifdef __linux__
+  /* lock-free wakeups need futexes */
+  fail_unless (gst_audio_ring_buffer_get_lock_free (ringbuffer));
+#endif
+  fail_unless (ringbuffer->spec.buffer_time <= 2000);
+  fail_unless (ringbuffer->spec.latency_time <= 500);
+  g_object_get (sink, "buffer-time", &buffer_time, "latency-time",
+      &latency_time, NULL);
+  fail_unless (buffer_time > 2000);
+  fail_unless (latency_time > 500);
+
+  /* all data got through the small ringbuffer */
+  g_object_get (sink, "stats", &stats, NULL);
+  fail_unless_equals_uint64 (get_uint64 (stats, "renders"), NUM_BUFFERS);
+  gst_structure_free (stats);
+
+  cleanup_audiosinktester ();
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_audiobasesink_suite (void)
+{
+  Suite *s = suite_create ("GstAudioBaseSink");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, test_stats);
+  tcase_add_test (tc, test_stats_delay_range);
+  tcase_add_test (tc, test_low_latency);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_audiobasesink);
@@ -30,6 +30,8 @@
 static GstPad *mysrcpad, *mysinkpad;
 static GstElement *dec;
 static GList *events = NULL;
+/* memories of output buffers that came from the downstream pool */
+static GHashTable *pool_memories = NULL;
 
 #define TEST_MSECS_PER_SAMPLE 44100
 
@@ -76,6 +78,7 @@ struct _GstAudioDecoderTester
 
   gboolean setoutputformat_on_decoding;
   gboolean output_too_many_frames;
+  gboolean use_output_buffer;
 };
 
 struct _GstAudioDecoderTesterClass
@@ -152,11 +155,19 @@ gst_audio_decoder_tester_handle_frame (GstAudioDecoder * dec,
   /* the output is SE32LE stereo 44100 Hz */
   size = 2 * 4;
   g_assert (size == sizeof (guint64));
-  data = g_malloc0 (size);
+  if (tester->use_output_buffer) {
+    output_buffer = gst_audio_decoder_allocate_output_buffer (dec, size);
+    gst_buffer_fill (output_buffer, 0, map.data, sizeof (guint64));
+    if (output_buffer->pool && pool_memories)
+      g_hash_table_add (pool_memories,
+          gst_memory_ref (gst_buffer_peek_memory (output_buffer, 0)));
+  } else {
+    data = g_malloc0 (size);
 
-  memcpy (data, map.data, sizeof (guint64));
+    memcpy (data, map.data, sizeof (guint64));
 
-  output_buffer = gst_buffer_new_wrapped (data, size);
+    output_buffer = gst_buffer_new_wrapped (data, size);
+  }
 
   gst_buffer_unmap (buffer, &map);
 
@@ -323,6 +334,180 @@ GST_START_TEST (audiodecoder_playback)
 
 GST_END_TEST;
 
+static gboolean
+_mysrcpad_query_not_live (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_LATENCY) {
+    gst_query_set_latency (query, FALSE, 0, GST_CLOCK_TIME_NONE);
+    return TRUE;
+  }
+  return gst_pad_query_default (pad, parent, query);
+}
+
+#define POOL_MAX_BUFFERS 4
+/* larger than a decoded frame */
+#define POOL_BUFFER_SIZE (2 * sizeof (guint64))
+static gboolean
+_mysinkpad_query_pool (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION) {
+    GstBufferPool *pool = gst_buffer_pool_new ();
+
+    /* fewer buffers than get aggregated, acquiring must not block */
+    gst_query_add_allocation_pool (query, pool, POOL_BUFFER_SIZE, 0,
+        POOL_MAX_BUFFERS);
+    gst_object_unref (pool);
+    return TRUE;
+  }
+  return gst_pad_query_default (pad, parent, query);
+}
+
+/* stays below the maximum number of memories in a buffer so that
+ * aggregating doesn't need to merge them */
+#define AGGREGATE_SAMPLES 8
+GST_START_TEST (audiodecoder_playback_aggregate)
+{
+  GstSegment segment;
+  GstBuffer *buffer;
+  GList *iter;
+  guint64 i, expected = 0;
+  gboolean multi_memory = FALSE, pooled = FALSE;
+
+  setup_audiodecodertester (NULL, NULL);
+  ((GstAudioDecoderTester *) dec)->use_output_buffer = TRUE;
+  pool_memories = g_hash_table_new_full (NULL, NULL,
+      (GDestroyNotify) gst_memory_unref, NULL);
+
+  gst_pad_set_query_function (mysrcpad, _mysrcpad_query_not_live);
+  gst_pad_set_query_function (mysinkpad, _mysinkpad_query_pool);
+  gst_audio_decoder_set_min_latency (GST_AUDIO_DECODER (dec),
+      gst_util_uint64_scale_round (AGGREGATE_SAMPLES, GST_SECOND,
+          TEST_MSECS_PER_SAMPLE));
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  send_startup_events ();
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    buffer = create_test_buffer (i);
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* decoded frames got aggregated into fewer buffers */
+  fail_unless (g_list_length (buffers) < NUM_BUFFERS / AGGREGATE_SAMPLES * 2);
+
+  for (iter = buffers; iter; iter = g_list_next (iter)) {
+    GstMapInfo map;
+    guint64 *data;
+    gsize j, n;
+
+    buffer = iter->data;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+        gst_util_uint64_scale_round (expected, GST_SECOND,
+            TEST_MSECS_PER_SAMPLE));
+
+    /* the decoded frames are referenced, not copied */
+    n = gst_buffer_n_memory (buffer);
+    if (n > 1)
+      multi_memory = TRUE;
+    for (j = 0; j < n; j++) {
+      GstMemory *mem = gst_buffer_peek_memory (buffer, j);
+
+      if (mem->parent)
+        mem = mem->parent;
+      if (g_hash_table_contains (pool_memories, mem))
+        pooled = TRUE;
+    }
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    data = (guint64 *) map.data;
+    n = map.size / sizeof (guint64);
+    for (j = 0; j < n; j++)
+      fail_unless_equals_uint64 (data[j], expected++);
+    gst_buffer_unmap (buffer, &map);
+  }
+  fail_unless_equals_uint64 (expected, NUM_BUFFERS);
+  fail_unless (multi_memory);
+  fail_unless (pooled);
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  cleanup_audiodecodertest ();
+
+  g_hash_table_unref (pool_memories);
+  pool_memories = NULL;
+}
+
+GST_END_TEST;
+
+static void
+buffer_finalized (gpointer data, GstMiniObject * obj)
+{
+  gboolean *finalized = data;
+
+  *finalized = TRUE;
+}
+
+GST_START_TEST (audiodecoder_output_buffer_pool)
+{
+  GstBuffer *buffer, *again;
+  GstBufferPool *pool;
+  gboolean finalized = FALSE;
+
+  setup_audiodecodertester (NULL, NULL);
+  gst_pad_set_query_function (mysinkpad, _mysinkpad_query_pool);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  send_startup_events ();
+
+  /* a frame smaller than the pool buffers is taken from the pool */
+  buffer = gst_audio_decoder_allocate_output_buffer (GST_AUDIO_DECODER (dec),
+      sizeof (guint64));
+  fail_unless (buffer != NULL);
+  fail_unless (buffer->pool != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), sizeof (guint64));
+  pool = gst_object_ref (buffer->pool);
+
+  /* the pool keeps the buffer instead of discarding it */
+  gst_mini_object_weak_ref (GST_MINI_OBJECT_CAST (buffer), buffer_finalized,
+      &finalized);
+  gst_buffer_unref (buffer);
+  fail_if (finalized);
+
+  again = gst_audio_decoder_allocate_output_buffer (GST_AUDIO_DECODER (dec),
+      POOL_BUFFER_SIZE);
+  fail_unless (again == buffer);
+  fail_unless (again->pool == pool);
+  fail_unless_equals_int (gst_buffer_get_size (again), POOL_BUFFER_SIZE);
+  gst_mini_object_weak_unref (GST_MINI_OBJECT_CAST (again), buffer_finalized,
+      &finalized);
+  gst_buffer_unref (again);
+
+  /* frames that don't fit are allocated normally */
+  buffer = gst_audio_decoder_allocate_output_buffer (GST_AUDIO_DECODER (dec),
+      POOL_BUFFER_SIZE + 1);
+  fail_unless (buffer->pool == NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), POOL_BUFFER_SIZE + 1);
+  gst_buffer_unref (buffer);
+
+  gst_object_unref (pool);
+  cleanup_audiodecodertest ();
+}
+
+GST_END_TEST;
+
 static void
 check_audiodecoder_negotiation (void)
 {
@@ -1172,6 +1357,8 @@ gst_audiodecoder_suite (void)
 
   suite_add_tcase (s, tc);
   tcase_add_test (tc, audiodecoder_playback);
+  tcase_add_test (tc, audiodecoder_playback_aggregate);
+  tcase_add_test (tc, audiodecoder_output_buffer_pool);
   tcase_add_test (tc, audiodecoder_flush_events_no_buffers);
   tcase_add_test (tc, audiodecoder_eos_events_no_buffers);
   tcase_add_test (tc, audiodecoder_flush_events);
@@ -44,6 +44,9 @@ typedef struct _GstAudioEncoderTesterClass GstAudioEncoderTesterClass;
 struct _GstAudioEncoderTester
 {
   GstAudioEncoder parent;
+
+  gint frame_samples;
+  guint multi_memory_frames;
 };
 
 struct _GstAudioEncoderTesterClass
@@ -76,6 +79,13 @@ gst_audio_encoder_tester_set_format (GstAudioEncoder * enc, GstAudioInfo * info)
   gst_audio_encoder_set_output_format (enc, caps);
   gst_caps_unref (caps);
 
+  if (((GstAudioEncoderTester *) enc)->frame_samples > 0) {
+    gst_audio_encoder_set_frame_samples_min (enc,
+        ((GstAudioEncoderTester *) enc)->frame_samples);
+    gst_audio_encoder_set_frame_samples_max (enc,
+        ((GstAudioEncoderTester *) enc)->frame_samples);
+  }
+
   return TRUE;
 }
 
@@ -91,6 +101,9 @@ gst_audio_encoder_tester_handle_frame (GstAudioEncoder * enc,
   if (buffer == NULL)
     return GST_FLOW_OK;
 
+  if (gst_buffer_n_memory (buffer) > 1)
+    ((GstAudioEncoderTester *) enc)->multi_memory_frames++;
+
   gst_buffer_map (buffer, &map, GST_MAP_READ);
   input_num = *((guint64 *) map.data);
   gst_buffer_unmap (buffer, &map);
@@ -102,7 +115,8 @@ gst_audio_encoder_tester_handle_frame (GstAudioEncoder * enc,
   GST_BUFFER_PTS (output_buffer) = GST_BUFFER_PTS (buffer);
   GST_BUFFER_DURATION (output_buffer) = GST_BUFFER_DURATION (buffer);
 
-  return gst_audio_encoder_finish_frame (enc, output_buffer, TEST_AUDIO_RATE);
+  return gst_audio_encoder_finish_frame (enc, output_buffer,
+      gst_buffer_get_size (buffer) / (2 * TEST_AUDIO_CHANNELS));
 }
 
 static void
@@ -278,6 +292,68 @@ GST_START_TEST (audioencoder_playback)
 
 GST_END_TEST;
 
+GST_START_TEST (audioencoder_zero_copy_input)
+{
+  GstAudioEncoderTester *tester;
+  GstSegment segment;
+  GstBuffer *buffer;
+  guint64 i;
+  GList *iter;
+
+  setup_audioencodertester ();
+
+  /* frames of 1.5 seconds over buffers of 1 second, so every frame spans
+   * two input buffers */
+  tester = (GstAudioEncoderTester *) enc;
+  tester->frame_samples = TEST_AUDIO_RATE * 3 / 2;
+  gst_audio_encoder_set_zero_copy_input (GST_AUDIO_ENCODER (enc), TRUE);
+  fail_unless (gst_audio_encoder_get_zero_copy_input (GST_AUDIO_ENCODER
+          (enc)));
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (enc, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  send_startup_events ();
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    buffer = create_test_buffer (i);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* all complete frames span two input buffers and were not merged, the
+   * leftover second at EOS comes from a single input buffer */
+  fail_unless_equals_int (tester->multi_memory_frames, NUM_BUFFERS * 2 / 3);
+  fail_unless_equals_int (g_list_length (buffers), NUM_BUFFERS * 2 / 3 + 1);
+
+  /* each frame starting on an input buffer boundary carries its number */
+  i = 0;
+  for (iter = buffers; iter; iter = g_list_next (iter)) {
+    GstMapInfo map;
+
+    buffer = iter->data;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    if (i % 2 == 0)
+      fail_unless_equals_uint64 (*(guint64 *) map.data, i * 3 / 2);
+    gst_buffer_unmap (buffer, &map);
+    i++;
+  }
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  cleanup_audioencodertest ();
+}
+
+GST_END_TEST;
+
 
 GST_START_TEST (audioencoder_flush_events)
 {
@@ -505,6 +581,7 @@ gst_audioencoder_suite (void)
 
   suite_add_tcase (s, tc);
   tcase_add_test (tc, audioencoder_playback);
+  tcase_add_test (tc, audioencoder_zero_copy_input);
 
   tcase_add_test (tc, audioencoder_tags_before_eos);
   tcase_add_test (tc, audioencoder_events_before_eos);
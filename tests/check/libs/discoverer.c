@@ -231,6 +231,236 @@ GST_START_TEST (test_disco_missing_plugins)
 
 GST_END_TEST;
 
+static void
+disco_parallel_discovered_cb (GstDiscoverer * dc, GstDiscovererInfo * info,
+    GError * err, guint * n_discovered)
+{
+  fail_unless (info != NULL);
+  (*n_discovered)++;
+}
+
+static void
+disco_parallel_finished_cb (GstDiscoverer * dc, GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+GST_START_TEST (test_disco_async_parallel)
+{
+  const gchar *files[] = { "theora-vorbis.ogg", "test.mp3",
+    "partialframe.mjpeg", "theora-vorbis.ogg", "test.mp3"
+  };
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  GMainLoop *loop;
+  guint n_discovered = 0, max_concurrent;
+  gchar *uri, *path;
+  guint i;
+
+  dc = gst_discoverer_new (5 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  fail_unless (err == NULL);
+
+  g_object_set (dc, "max-concurrent", 3, NULL);
+  g_object_get (dc, "max-concurrent", &max_concurrent, NULL);
+  fail_unless_equals_int (max_concurrent, 3);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (dc, "discovered",
+      G_CALLBACK (disco_parallel_discovered_cb), &n_discovered);
+  g_signal_connect (dc, "finished", G_CALLBACK (disco_parallel_finished_cb),
+      loop);
+
+  gst_discoverer_start (dc);
+  for (i = 0; i < G_N_ELEMENTS (files); i++) {
+    path = g_build_filename (GST_TEST_FILES_PATH, files[i], NULL);
+    uri = gst_filename_to_uri (path, &err);
+    g_free (path);
+    fail_unless (err == NULL);
+    fail_unless (gst_discoverer_discover_uri_async (dc, uri));
+    g_free (uri);
+  }
+
+  g_main_loop_run (loop);
+  gst_discoverer_stop (dc);
+
+  fail_unless_equals_int (n_discovered, G_N_ELEMENTS (files));
+
+  g_main_loop_unref (loop);
+  g_object_unref (dc);
+}
+
+GST_END_TEST;
+
+static void
+disco_count_finished_cb (GstDiscoverer * dc, guint * n_finished)
+{
+  (*n_finished)++;
+}
+
+GST_START_TEST (test_disco_async_parallel_empty)
+{
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  guint n_finished = 0;
+
+  dc = gst_discoverer_new (5 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  fail_unless (err == NULL);
+
+  g_object_set (dc, "max-concurrent", 3, NULL);
+  g_signal_connect (dc, "finished", G_CALLBACK (disco_count_finished_cb),
+      &n_finished);
+
+  /* nothing to discover, so the discoverer is done right away */
+  gst_discoverer_start (dc);
+  fail_unless_equals_int (n_finished, 1);
+  gst_discoverer_stop (dc);
+
+  g_object_unref (dc);
+}
+
+GST_END_TEST;
+
+static void
+disco_cache_source_setup_cb (GstDiscoverer * dc, GstElement * source,
+    guint * n_setups)
+{
+  (*n_setups)++;
+}
+
+GST_START_TEST (test_disco_cache)
+{
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  GstDiscovererInfo *info, *cached;
+  GstDiscovererStreamInfo *sinfo;
+  guint n_setups = 0;
+  gchar *uri, *path, *cache_dir, *cache_file;
+
+  dc = gst_discoverer_new (5 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  fail_unless (err == NULL);
+  g_object_set (dc, "cache-size", 4, NULL);
+  g_signal_connect (dc, "source-setup",
+      G_CALLBACK (disco_cache_source_setup_cb), &n_setups);
+
+  path = g_build_filename (GST_TEST_FILES_PATH, "test.mp3", NULL);
+  uri = gst_filename_to_uri (path, &err);
+  g_free (path);
+  fail_unless (err == NULL);
+
+  info = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (info != NULL);
+  if (err) {
+    /* we don't have the elements needed, nothing gets cached */
+    g_error_free (err);
+    gst_discoverer_info_unref (info);
+    g_object_unref (dc);
+    g_free (uri);
+    return;
+  }
+  fail_unless_equals_int (gst_discoverer_info_get_result (info),
+      GST_DISCOVERER_OK);
+  fail_unless_equals_int (n_setups, 1);
+
+  /* second discovery is answered from the cache */
+  cached = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (err == NULL);
+  fail_unless (cached == info);
+  fail_unless_equals_int (n_setups, 1);
+  gst_discoverer_info_unref (cached);
+
+  /* private directory, parallel test runs must not share the file */
+  cache_dir = g_dir_make_tmp ("gst-disco-cache-XXXXXX", &err);
+  fail_unless (cache_dir != NULL);
+  cache_file = g_build_filename (cache_dir, "cache", NULL);
+  fail_unless (gst_discoverer_save_cache (dc, cache_file, &err));
+  g_object_unref (dc);
+
+  /* and survives a new discoverer through the cache file */
+  dc = gst_discoverer_new (5 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  g_object_set (dc, "cache-size", 4, NULL);
+  g_signal_connect (dc, "source-setup",
+      G_CALLBACK (disco_cache_source_setup_cb), &n_setups);
+  fail_unless (gst_discoverer_load_cache (dc, cache_file, &err));
+  fail_unless (err == NULL);
+
+  cached = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (err == NULL);
+  fail_unless_equals_int (n_setups, 1);
+  fail_unless_equals_string (gst_discoverer_info_get_uri (cached), uri);
+  fail_unless_equals_uint64 (gst_discoverer_info_get_duration (cached),
+      gst_discoverer_info_get_duration (info));
+  sinfo = gst_discoverer_info_get_stream_info (cached);
+  fail_unless (sinfo != NULL);
+  gst_discoverer_stream_info_unref (sinfo);
+  gst_discoverer_info_unref (cached);
+
+  g_unlink (cache_file);
+  g_rmdir (cache_dir);
+  g_free (cache_file);
+  g_free (cache_dir);
+  gst_discoverer_info_unref (info);
+  g_object_unref (dc);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_disco_header_only)
+{
+  GError *err = NULL;
+  GstDiscoverer *dc;
+  GstDiscovererInfo *info;
+  GstDiscovererStreamInfo *sinfo;
+  GList *streams, *l;
+  GstStructure *st;
+  GstCaps *caps;
+  gchar *uri, *path;
+
+  dc = gst_discoverer_new (5 * GST_SECOND, &err);
+  fail_unless (dc != NULL);
+  fail_unless (err == NULL);
+  g_object_set (dc, "header-only", TRUE, NULL);
+
+  path = g_build_filename (GST_TEST_FILES_PATH, "theora-vorbis.ogg", NULL);
+  uri = gst_filename_to_uri (path, &err);
+  g_free (path);
+  fail_unless (err == NULL);
+
+  info = gst_discoverer_discover_uri (dc, uri, &err);
+  fail_unless (info != NULL);
+
+  if (err == NULL) {
+    fail_unless_equals_int (gst_discoverer_info_get_result (info),
+        GST_DISCOVERER_OK);
+    streams = gst_discoverer_info_get_stream_list (info);
+    fail_unless (streams != NULL);
+    for (l = streams; l; l = l->next) {
+      sinfo = l->data;
+      caps = gst_discoverer_stream_info_get_caps (sinfo);
+      st = gst_caps_get_structure (caps, 0);
+      GST_INFO ("stream caps %" GST_PTR_FORMAT, caps);
+      /* nothing was decoded */
+      fail_if (gst_structure_has_name (st, "audio/x-raw"));
+      fail_if (gst_structure_has_name (st, "video/x-raw"));
+      gst_caps_unref (caps);
+    }
+    gst_discoverer_stream_info_list_free (streams);
+  } else {
+    /* we don't have the elements needed */
+    g_error_free (err);
+  }
+
+  gst_discoverer_info_unref (info);
+  g_free (uri);
+  g_object_unref (dc);
+}
+
+GST_END_TEST;
+
 static Suite *
 discoverer_suite (void)
 {
@@ -245,6 +475,10 @@ discoverer_suite (void)
   tcase_add_test (tc_chain, test_disco_sync_reuse_timeout);
   tcase_add_test (tc_chain, test_disco_missing_plugins);
   tcase_add_test (tc_chain, test_disco_serializing);
+  tcase_add_test (tc_chain, test_disco_async_parallel);
+  tcase_add_test (tc_chain, test_disco_async_parallel_empty);
+  tcase_add_test (tc_chain, test_disco_cache);
+  tcase_add_test (tc_chain, test_disco_header_only);
   return s;
 }
 
@@ -2326,6 +2326,302 @@ GST_END_TEST;
 #undef WIDTH
 #undef HEIGHT
 
+static const struct
+{
+  GstVideoFormat infmt;
+  GstVideoFormat outfmt;
+} fused_formats[] = {
+  {
+  GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_NV12}, {
+  GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_NV21}, {
+  GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_I420}, {
+  GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_I420}, {
+  GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_YV12}, {
+  GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_YUY2}, {
+  GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_UYVY}
+};
+
+static gdouble
+run_size_convert (GstVideoFrame * inframe, GstVideoFrame * outframe,
+    gint method, gboolean generic)
+{
+  GstVideoConverter *convert;
+  GstStructure *config;
+  GTimer *timer;
+  gdouble elapsed;
+  gint count;
+
+  config = gst_structure_new ("options",
+      GST_VIDEO_CONVERTER_OPT_RESAMPLER_METHOD,
+      GST_TYPE_VIDEO_RESAMPLER_METHOD, method, NULL);
+  /* quantization without a dither method disables the fastpaths without
+   * adding extra steps to the generic conversion */
+  if (generic)
+    gst_structure_set (config,
+        GST_VIDEO_CONVERTER_OPT_DITHER_METHOD, GST_TYPE_VIDEO_DITHER_METHOD,
+        GST_VIDEO_DITHER_NONE, GST_VIDEO_CONVERTER_OPT_DITHER_QUANTIZATION,
+        G_TYPE_UINT, 2, NULL);
+
+  convert = gst_video_converter_new (&inframe->info, &outframe->info, config);
+
+  /* warmup */
+  gst_video_converter_frame (convert, inframe, outframe);
+
+  timer = g_timer_new ();
+  count = 0;
+  while (TRUE) {
+    gst_video_converter_frame (convert, inframe, outframe);
+
+    count++;
+    elapsed = g_timer_elapsed (timer, NULL);
+    if (elapsed >= TIME)
+      break;
+  }
+  g_timer_destroy (timer);
+  gst_video_converter_free (convert);
+
+  return count / elapsed;
+}
+
+/* fills every component with a smooth gradient, so that any interpolating
+ * resampler produces nearly the same values */
+static void
+fill_gradient (GstVideoFrame * frame)
+{
+  gint c, x, y, w, h, stride, pstride;
+  guint8 *data;
+
+  for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (frame); c++) {
+    w = GST_VIDEO_FRAME_COMP_WIDTH (frame, c);
+    h = GST_VIDEO_FRAME_COMP_HEIGHT (frame, c);
+    stride = GST_VIDEO_FRAME_COMP_STRIDE (frame, c);
+    pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, c);
+    data = GST_VIDEO_FRAME_COMP_DATA (frame, c);
+
+    for (y = 0; y < h; y++)
+      for (x = 0; x < w; x++)
+        data[y * stride + x * pstride] = 16 + (c * 32) + (x * 160) / w +
+            (y * 32) / h;
+  }
+}
+
+/* returns the largest difference between the components of @f1 and @f2 */
+static gint
+max_frame_diff (GstVideoFrame * f1, GstVideoFrame * f2)
+{
+  gint c, x, y, w, h, diff, max_diff = 0;
+  guint8 *d1, *d2;
+
+  for (c = 0; c < GST_VIDEO_FRAME_N_COMPONENTS (f1); c++) {
+    w = GST_VIDEO_FRAME_COMP_WIDTH (f1, c);
+    h = GST_VIDEO_FRAME_COMP_HEIGHT (f1, c);
+
+    for (y = 0; y < h; y++) {
+      d1 = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (f1, c) +
+          y * GST_VIDEO_FRAME_COMP_STRIDE (f1, c);
+      d2 = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (f2, c) +
+          y * GST_VIDEO_FRAME_COMP_STRIDE (f2, c);
+
+      for (x = 0; x < w; x++) {
+        diff = ABS (d1[x * GST_VIDEO_FRAME_COMP_PSTRIDE (f1, c)] -
+            d2[x * GST_VIDEO_FRAME_COMP_PSTRIDE (f2, c)]);
+        max_diff = MAX (max_diff, diff);
+      }
+    }
+  }
+  return max_diff;
+}
+
+/* the fused fastpaths may site and round chroma slightly differently than
+ * the generic path */
+#define FUSED_TOLERANCE 6
+
+GST_START_TEST (test_video_size_convert_fused)
+{
+  gint i, method;
+
+  for (i = 0; i < G_N_ELEMENTS (fused_formats); i++) {
+    GstVideoInfo ininfo, outinfo;
+    GstVideoFrame inframe, fused_frame, generic_frame;
+    GstBuffer *inbuffer, *fused_buffer, *generic_buffer;
+    gdouble fused_sec, generic_sec;
+    gint diff;
+
+    gst_video_info_set_format (&ininfo, fused_formats[i].infmt, WIDTH_IN,
+        HEIGHT_IN);
+    inbuffer = gst_buffer_new_and_alloc (ininfo.size);
+    gst_video_frame_map (&inframe, &ininfo, inbuffer, GST_MAP_READWRITE);
+    fill_gradient (&inframe);
+
+    gst_video_info_set_format (&outinfo, fused_formats[i].outfmt, WIDTH_OUT,
+        HEIGHT_OUT);
+    fused_buffer = gst_buffer_new_and_alloc (outinfo.size);
+    generic_buffer = gst_buffer_new_and_alloc (outinfo.size);
+
+    for (method = 0; method < 4; method++) {
+      gst_video_frame_map (&fused_frame, &outinfo, fused_buffer,
+          GST_MAP_READWRITE);
+      gst_video_frame_map (&generic_frame, &outinfo, generic_buffer,
+          GST_MAP_READWRITE);
+
+      fused_sec = run_size_convert (&inframe, &fused_frame, method, FALSE);
+      generic_sec = run_size_convert (&inframe, &generic_frame, method, TRUE);
+
+      /* the fastpath must produce the same picture as the generic path */
+      diff = max_frame_diff (&fused_frame, &generic_frame);
+      GST_DEBUG ("%s->%s, method %d: fused %f/sec, generic %f/sec (%.2fx), "
+          "max diff %d", gst_video_format_to_string (fused_formats[i].infmt),
+          gst_video_format_to_string (fused_formats[i].outfmt), method,
+          fused_sec, generic_sec, fused_sec / generic_sec, diff);
+      fail_unless (diff <= FUSED_TOLERANCE,
+          "%s->%s, method %d: difference %d with the generic path",
+          gst_video_format_to_string (fused_formats[i].infmt),
+          gst_video_format_to_string (fused_formats[i].outfmt), method, diff);
+
+      gst_video_frame_unmap (&generic_frame);
+      gst_video_frame_unmap (&fused_frame);
+    }
+    gst_buffer_unref (generic_buffer);
+    gst_buffer_unref (fused_buffer);
+    gst_video_frame_unmap (&inframe);
+    gst_buffer_unref (inbuffer);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_dither)
+{
+  GstVideoDither *dither;
+  GstVideoDitherMethod method;
+  guint quant[GST_VIDEO_MAX_COMPONENTS] = { 256, 256, 256, 256 };
+  guint16 line[WIDTH_IN * 4];
+  gint i, y;
+
+  for (method = GST_VIDEO_DITHER_NONE; method <= GST_VIDEO_DITHER_BLUE_NOISE;
+      method++) {
+    dither = gst_video_dither_new (method, GST_VIDEO_DITHER_FLAG_QUANTIZE,
+        GST_VIDEO_FORMAT_AYUV64, quant, WIDTH_IN);
+    fail_unless (dither != NULL);
+
+    for (y = 0; y < 32; y++) {
+      for (i = 0; i < WIDTH_IN * 4; i++)
+        line[i] = 0x1234 + i;
+
+      gst_video_dither_line (dither, line, 0, y, WIDTH_IN);
+
+      /* all values must be quantized to 8 bits */
+      for (i = 0; i < WIDTH_IN * 4; i++)
+        fail_unless_equals_int (line[i] & 0xff, 0);
+    }
+    gst_video_dither_free (dither);
+  }
+
+  /* quantizers above 8 bits need the threshold map scaled up, a value
+   * halfway between two steps must then be rounded both ways */
+  for (i = 0; i < GST_VIDEO_MAX_COMPONENTS; i++)
+    quant[i] = 4096;
+
+  for (method = GST_VIDEO_DITHER_BAYER; method <= GST_VIDEO_DITHER_BLUE_NOISE;
+      method++) {
+    guint n_low = 0, n_high = 0;
+
+    dither = gst_video_dither_new (method, GST_VIDEO_DITHER_FLAG_QUANTIZE,
+        GST_VIDEO_FORMAT_AYUV64, quant, WIDTH_IN);
+    fail_unless (dither != NULL);
+
+    for (y = 0; y < 16; y++) {
+      for (i = 0; i < WIDTH_IN * 4; i++)
+        line[i] = 0x1800;
+
+      gst_video_dither_line (dither, line, 0, y, WIDTH_IN);
+
+      for (i = 0; i < WIDTH_IN * 4; i++) {
+        if (line[i] == 0x1000)
+          n_low++;
+        else if (line[i] == 0x2000)
+          n_high++;
+        else
+          fail ("value %04x not quantized to 12 bits", line[i]);
+      }
+    }
+    fail_unless (n_low > 0);
+    fail_unless (n_high > 0);
+    gst_video_dither_free (dither);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_buffer_pool_stats)
+{
+  GstBufferPool *pool;
+  GstStructure *config, *stats;
+  GstVideoInfo info;
+  GstCaps *caps;
+  GstBuffer *buffers[4];
+  guint64 acquired, allocated, reused, freed, trimmed;
+  guint outstanding, peak;
+  gint i;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, 64, 48);
+  caps = gst_video_info_to_caps (&info);
+
+  pool = gst_video_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, info.size, 1, 4);
+  gst_buffer_pool_config_add_option (config,
+      GST_BUFFER_POOL_OPTION_VIDEO_ADAPTIVE_SIZE);
+  /* an idle timeout of 0 trims as soon as possible */
+  gst_buffer_pool_config_set_video_adaptive_size (config, 0);
+  fail_unless (gst_buffer_pool_set_config (pool, config));
+  gst_caps_unref (caps);
+
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+
+  for (i = 0; i < 4; i++)
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &buffers[i],
+            NULL) == GST_FLOW_OK);
+
+  stats = gst_video_buffer_pool_get_stats (GST_VIDEO_BUFFER_POOL (pool));
+  fail_unless (gst_structure_get (stats,
+          "acquired", G_TYPE_UINT64, &acquired,
+          "allocated", G_TYPE_UINT64, &allocated,
+          "reused", G_TYPE_UINT64, &reused,
+          "outstanding", G_TYPE_UINT, &outstanding,
+          "peak-outstanding", G_TYPE_UINT, &peak, NULL));
+  fail_unless_equals_uint64 (acquired, 4);
+  fail_unless_equals_uint64 (allocated, 4);
+  /* the preallocated buffer was reused */
+  fail_unless_equals_uint64 (reused, 1);
+  fail_unless_equals_int (outstanding, 4);
+  fail_unless_equals_int (peak, 4);
+  gst_structure_free (stats);
+
+  for (i = 0; i < 4; i++)
+    gst_buffer_unref (buffers[i]);
+
+  /* all buffers are idle now, the pool can shrink back to its minimum */
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buffers[0],
+          NULL) == GST_FLOW_OK);
+  gst_buffer_unref (buffers[0]);
+
+  stats = gst_video_buffer_pool_get_stats (GST_VIDEO_BUFFER_POOL (pool));
+  fail_unless (gst_structure_get (stats,
+          "freed", G_TYPE_UINT64, &freed,
+          "trimmed", G_TYPE_UINT64, &trimmed,
+          "outstanding", G_TYPE_UINT, &outstanding, NULL));
+  fail_unless_equals_int (outstanding, 0);
+  fail_unless (trimmed > 0);
+  fail_unless_equals_uint64 (freed, trimmed);
+  gst_structure_free (stats);
+
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_video_convert)
 {
   GstVideoInfo ininfo, outinfo;
@@ -2664,6 +2960,9 @@ video_suite (void)
   tcase_add_test (tc_chain, test_video_scaler);
   tcase_add_test (tc_chain, test_video_color_convert);
   tcase_add_test (tc_chain, test_video_size_convert);
+  tcase_add_test (tc_chain, test_video_size_convert_fused);
+  tcase_add_test (tc_chain, test_video_dither);
+  tcase_add_test (tc_chain, test_video_buffer_pool_stats);
   tcase_add_test (tc_chain, test_video_convert);
   tcase_add_test (tc_chain, test_video_transfer);
   tcase_add_test (tc_chain, test_overlay_blend);
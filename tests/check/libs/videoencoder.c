@@ -45,6 +45,8 @@ typedef struct _GstVideoEncoderTesterClass GstVideoEncoderTesterClass;
 struct _GstVideoEncoderTester
 {
   GstVideoEncoder parent;
+
+  gint preprocessed;
 };
 
 struct _GstVideoEncoderTesterClass
@@ -92,6 +94,12 @@ gst_video_encoder_tester_handle_frame (GstVideoEncoder * dec,
   input_num = *((guint64 *) map.data);
   gst_buffer_unmap (frame->input_buffer, &map);
 
+  /* preprocess_frame ran before us */
+  fail_unless (gst_video_codec_frame_get_user_data (frame) != NULL);
+  fail_unless (*(guint64 *) gst_video_codec_frame_get_user_data (frame) ==
+      input_num);
+  ((GstVideoEncoderTester *) dec)->preprocessed++;
+
   data = g_malloc (sizeof (guint64));
   *(guint64 *) data = input_num;
 
@@ -102,6 +110,27 @@ gst_video_encoder_tester_handle_frame (GstVideoEncoder * dec,
   return gst_video_encoder_finish_frame (dec, frame);
 }
 
+static GstFlowReturn
+gst_video_encoder_tester_preprocess_frame (GstVideoEncoder * dec,
+    GstVideoCodecFrame * frame)
+{
+  GstMapInfo map;
+  guint64 *input_num;
+
+  input_num = g_new (guint64, 1);
+
+  gst_buffer_map (frame->input_buffer, &map, GST_MAP_READ);
+  *input_num = *((guint64 *) map.data);
+  gst_buffer_unmap (frame->input_buffer, &map);
+
+  /* make frames complete out of order */
+  g_usleep ((*input_num % 4) * 500);
+
+  gst_video_codec_frame_set_user_data (frame, input_num, g_free);
+
+  return GST_FLOW_OK;
+}
+
 static void
 gst_video_encoder_tester_class_init (GstVideoEncoderTesterClass * klass)
 {
@@ -128,6 +157,8 @@ gst_video_encoder_tester_class_init (GstVideoEncoderTesterClass * klass)
   videoencoder_class->stop = gst_video_encoder_tester_stop;
   videoencoder_class->handle_frame = gst_video_encoder_tester_handle_frame;
   videoencoder_class->set_format = gst_video_encoder_tester_set_format;
+  videoencoder_class->preprocess_frame =
+      gst_video_encoder_tester_preprocess_frame;
 }
 
 static void
@@ -277,6 +308,64 @@ GST_START_TEST (videoencoder_playback)
 
 GST_END_TEST;
 
+GST_START_TEST (videoencoder_playback_lookahead)
+{
+  GstSegment segment;
+  GstBuffer *buffer;
+  guint64 i;
+  GList *iter;
+
+  setup_videoencodertester ();
+
+  gst_video_encoder_set_lookahead (GST_VIDEO_ENCODER (dec), 4);
+  fail_unless_equals_int (gst_video_encoder_get_lookahead (GST_VIDEO_ENCODER
+          (dec)), 4);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  send_startup_events ();
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    buffer = create_test_buffer (i);
+
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  /* all frames were preprocessed and encoded in order */
+  fail_unless_equals_int (((GstVideoEncoderTester *) dec)->preprocessed,
+      NUM_BUFFERS);
+  fail_unless (g_list_length (buffers) == NUM_BUFFERS);
+  i = 0;
+  for (iter = buffers; iter; iter = g_list_next (iter)) {
+    GstMapInfo map;
+    guint64 num;
+
+    buffer = iter->data;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    num = *(guint64 *) map.data;
+    fail_unless (i == num);
+    fail_unless (GST_BUFFER_PTS (buffer) == gst_util_uint64_scale_round (i,
+            GST_SECOND * TEST_VIDEO_FPS_D, TEST_VIDEO_FPS_N));
+    gst_buffer_unmap (buffer, &map);
+    i++;
+  }
+
+  g_list_free_full (buffers, (GDestroyNotify) gst_buffer_unref);
+  buffers = NULL;
+
+  cleanup_videoencodertest ();
+}
+
+GST_END_TEST;
+
 /* make sure tags sent right before eos are pushed */
 GST_START_TEST (videoencoder_tags_before_eos)
 {
@@ -503,6 +592,7 @@ gst_videoencoder_suite (void)
 
   suite_add_tcase (s, tc);
   tcase_add_test (tc, videoencoder_playback);
+  tcase_add_test (tc, videoencoder_playback_lookahead);
 
   tcase_add_test (tc, videoencoder_tags_before_eos);
   tcase_add_test (tc, videoencoder_events_before_eos);
@@ -23,6 +23,7 @@
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstbufferstraw.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 
 static gboolean got_eos = FALSE;
 
@@ -150,6 +151,286 @@ GST_START_TEST (test_memory_stream)
 
 GST_END_TEST;
 
+/* spans several readahead windows of the mapped mode */
+#define MMAP_FILE_SIZE (3 * 1024 * 1024 + 123)
+#define MMAP_BLOCK_SIZE 65536
+
+static gchar *
+create_test_file (const gchar * dir, gsize size, guint8 ** data_out)
+{
+  guint8 *data;
+  gchar *path;
+  gsize i;
+
+  data = g_malloc (size + 1);
+  for (i = 0; i < size; i++)
+    data[i] = (i * 7 + i / 256) % 256;
+
+  path = g_build_filename (dir, "data", NULL);
+  fail_unless (g_file_set_contents (path, (gchar *) data, size, NULL));
+  *data_out = data;
+
+  return path;
+}
+
+static void
+setup_pull_src (GstElement * src, GstPad ** pad)
+{
+  fail_unless_equals_int (gst_element_set_state (src, GST_STATE_READY),
+      GST_STATE_CHANGE_SUCCESS);
+  *pad = gst_element_get_static_pad (src, "src");
+  fail_unless (gst_pad_activate_mode (*pad, GST_PAD_MODE_PULL, TRUE));
+}
+
+static void
+cleanup_pull_src (GstElement * src, GstPad * pad)
+{
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, FALSE));
+  gst_object_unref (pad);
+  gst_element_set_state (src, GST_STATE_NULL);
+  gst_object_unref (src);
+}
+
+/* pulls a range and checks that it wraps the mapping of the whole file */
+static void
+check_mapped_range (GstPad * pad, const guint8 * data, guint64 offset,
+    guint size)
+{
+  GstBuffer *buf = NULL;
+  GstMemory *mem;
+  gsize expected;
+
+  expected = MIN (size, MMAP_FILE_SIZE - offset);
+
+  fail_unless_equals_int (gst_pad_get_range (pad, offset, size, &buf),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_get_size (buf), expected);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), offset);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET_END (buf), offset + expected);
+
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 1);
+  mem = gst_buffer_peek_memory (buf, 0);
+  fail_unless (GST_MEMORY_IS_READONLY (mem));
+  fail_unless_equals_int (mem->maxsize, MMAP_FILE_SIZE);
+  fail_unless_equals_int (mem->offset, offset);
+
+  fail_unless (gst_buffer_memcmp (buf, 0, data + offset, expected) == 0);
+  gst_buffer_unref (buf);
+}
+
+GST_START_TEST (test_mmap_pull)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstBuffer *buf = NULL;
+  gchar *dir, *path, *uri;
+  guint8 *data;
+  gint64 duration;
+  guint64 offset;
+  gboolean use_mmap;
+
+  dir = g_dir_make_tmp ("gst-gio-test-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  path = create_test_file (dir, MMAP_FILE_SIZE, &data);
+  uri = gst_filename_to_uri (path, NULL);
+
+  src = gst_element_factory_make ("giosrc", NULL);
+  fail_unless (src != NULL);
+  g_object_get (src, "use-mmap", &use_mmap, NULL);
+  fail_if (use_mmap);
+  g_object_set (src, "location", uri, "use-mmap", TRUE, NULL);
+  g_object_get (src, "use-mmap", &use_mmap, NULL);
+  fail_unless (use_mmap);
+
+  setup_pull_src (src, &pad);
+
+  fail_unless (gst_pad_query_duration (pad, GST_FORMAT_BYTES, &duration));
+  fail_unless_equals_int64 (duration, MMAP_FILE_SIZE);
+
+  /* sequential reads, the last one is clamped to the end of the file */
+  for (offset = 0; offset < MMAP_FILE_SIZE; offset += MMAP_BLOCK_SIZE)
+    check_mapped_range (pad, data, offset, MMAP_BLOCK_SIZE);
+
+  fail_unless_equals_int (gst_pad_get_range (pad, MMAP_FILE_SIZE,
+          MMAP_BLOCK_SIZE, &buf), GST_FLOW_EOS);
+  fail_unless (buf == NULL);
+
+  /* seeking backwards restarts the readahead window, then read forward
+   * again and jump around */
+  check_mapped_range (pad, data, 100, 10);
+  check_mapped_range (pad, data, 4096, MMAP_BLOCK_SIZE);
+  check_mapped_range (pad, data, 2 * 1024 * 1024 + 1, MMAP_BLOCK_SIZE);
+  check_mapped_range (pad, data, 1024 * 1024, MMAP_BLOCK_SIZE);
+  check_mapped_range (pad, data, MMAP_FILE_SIZE - 1, MMAP_BLOCK_SIZE);
+
+  cleanup_pull_src (src, pad);
+
+  g_unlink (path);
+  g_rmdir (dir);
+  g_free (uri);
+  g_free (path);
+  g_free (dir);
+  g_free (data);
+}
+
+GST_END_TEST;
+
+static guint64 mmap_received;
+static guint64 mmap_first_offset;
+static const guint8 *mmap_data;
+
+static void
+mmap_handoff_cb (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  guint64 offset = GST_BUFFER_OFFSET (buf);
+  gsize size = gst_buffer_get_size (buf);
+
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 1);
+  fail_unless (GST_MEMORY_IS_READONLY (gst_buffer_peek_memory (buf, 0)));
+  fail_unless (offset + size <= MMAP_FILE_SIZE);
+  fail_unless (gst_buffer_memcmp (buf, 0, mmap_data + offset, size) == 0);
+
+  if (mmap_first_offset == GST_BUFFER_OFFSET_NONE)
+    mmap_first_offset = offset;
+  mmap_received += size;
+}
+
+GST_START_TEST (test_mmap_push_seek)
+{
+  GMainLoop *loop;
+  GstElement *bin, *src, *sink;
+  GstBus *bus;
+  gchar *dir, *path, *uri;
+  guint8 *data;
+  gint64 duration;
+  guint bus_watch;
+
+  got_eos = FALSE;
+
+  dir = g_dir_make_tmp ("gst-gio-test-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  path = create_test_file (dir, MMAP_FILE_SIZE, &data);
+  uri = gst_filename_to_uri (path, NULL);
+  mmap_data = data;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  bin = gst_pipeline_new ("bin");
+
+  src = gst_element_factory_make ("giosrc", "src");
+  fail_unless (src != NULL);
+  g_object_set (src, "location", uri, "use-mmap", TRUE, "blocksize",
+      MMAP_BLOCK_SIZE, NULL);
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+  fail_unless (sink != NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (mmap_handoff_cb), NULL);
+
+  gst_bin_add_many (GST_BIN (bin), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  bus = gst_element_get_bus (bin);
+  bus_watch = gst_bus_add_watch (bus, message_handler, loop);
+  gst_object_unref (bus);
+
+  gst_element_set_state (bin, GST_STATE_PAUSED);
+  gst_element_get_state (bin, NULL, NULL, -1);
+
+  fail_unless (gst_element_query_duration (bin, GST_FORMAT_BYTES, &duration));
+  fail_unless_equals_int64 (duration, MMAP_FILE_SIZE);
+
+  /* everything from the seek position up to the end has to arrive */
+  mmap_received = 0;
+  mmap_first_offset = GST_BUFFER_OFFSET_NONE;
+  fail_unless (gst_element_seek_simple (bin, GST_FORMAT_BYTES,
+          GST_SEEK_FLAG_FLUSH, 1024 * 1024 + 17));
+  gst_element_get_state (bin, NULL, NULL, -1);
+
+  gst_element_set_state (bin, GST_STATE_PLAYING);
+  g_main_loop_run (loop);
+  gst_element_set_state (bin, GST_STATE_NULL);
+
+  fail_unless (got_eos);
+  fail_unless_equals_uint64 (mmap_first_offset, 1024 * 1024 + 17);
+  fail_unless_equals_uint64 (mmap_received,
+      MMAP_FILE_SIZE - (1024 * 1024 + 17));
+
+  gst_object_unref (bin);
+  g_main_loop_unref (loop);
+  g_source_remove (bus_watch);
+
+  g_unlink (path);
+  g_rmdir (dir);
+  g_free (uri);
+  g_free (path);
+  g_free (dir);
+  g_free (data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_mmap_fallback)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstBuffer *buf = NULL;
+  GInputStream *input;
+  gchar *dir, *path, *uri;
+  guint8 *data;
+  gint64 duration;
+
+  /* empty files can't be mapped and are read from the stream */
+  dir = g_dir_make_tmp ("gst-gio-test-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  path = create_test_file (dir, 0, &data);
+  g_free (data);
+  uri = gst_filename_to_uri (path, NULL);
+
+  src = gst_element_factory_make ("giosrc", NULL);
+  fail_unless (src != NULL);
+  g_object_set (src, "location", uri, "use-mmap", TRUE, NULL);
+  setup_pull_src (src, &pad);
+
+  fail_unless (gst_pad_query_duration (pad, GST_FORMAT_BYTES, &duration));
+  fail_unless_equals_int64 (duration, 0);
+  fail_unless_equals_int (gst_pad_get_range (pad, 0, 4096, &buf),
+      GST_FLOW_EOS);
+
+  cleanup_pull_src (src, pad);
+
+  g_unlink (path);
+  g_rmdir (dir);
+  g_free (uri);
+  g_free (path);
+  g_free (dir);
+
+  /* sources without a local file keep reading from the stream */
+  data = g_malloc (10000);
+  memset (data, 0xab, 10000);
+  input = g_memory_input_stream_new_from_data (data, 10000, g_free);
+
+  src = gst_element_factory_make ("giostreamsrc", NULL);
+  fail_unless (src != NULL);
+  g_object_set (src, "stream", input, "use-mmap", TRUE, NULL);
+  setup_pull_src (src, &pad);
+
+  fail_unless (gst_pad_query_duration (pad, GST_FORMAT_BYTES, &duration));
+  fail_unless_equals_int64 (duration, 10000);
+  fail_unless_equals_int (gst_pad_get_range (pad, 0, 4096, &buf),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 4096);
+  fail_unless (gst_buffer_memcmp (buf, 0, data, 4096) == 0);
+  /* not a view on a mapping of the whole stream */
+  fail_if (gst_buffer_peek_memory (buf, 0)->maxsize == 10000);
+  gst_buffer_unref (buf);
+
+  cleanup_pull_src (src, pad);
+  g_object_unref (input);
+}
+
+GST_END_TEST;
+
 static Suite *
 gio_suite (void)
 {
@@ -158,6 +439,9 @@ gio_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_memory_stream);
+  tcase_add_test (tc_chain, test_mmap_pull);
+  tcase_add_test (tc_chain, test_mmap_push_seek);
+  tcase_add_test (tc_chain, test_mmap_fallback);
 
   return s;
 }
@@ -0,0 +1,104 @@
+/* GStreamer audio pack/unpack microbenchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Times the unpack and pack functions of all the formats in the
+ * GstAudioFormatInfo table:
+ *
+ *   audio-pack-bench [ITERATIONS] [SAMPLES]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+
+#define DEFAULT_ITERATIONS 200
+#define DEFAULT_SAMPLES    (48000 * 2)
+
+static gdouble
+run (const GstAudioFormatInfo * finfo, gboolean pack, gpointer unpacked,
+    gpointer packed, gint samples, gint iterations)
+{
+  gint64 start, elapsed;
+  gint i;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < iterations; i++) {
+    if (pack)
+      finfo->pack_func (finfo, 0, unpacked, packed, samples);
+    else
+      finfo->unpack_func (finfo, 0, unpacked, packed, samples);
+  }
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  /* million samples per second */
+  return ((gdouble) samples * iterations) / elapsed;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstAudioFormat format;
+  gint iterations = DEFAULT_ITERATIONS;
+  gint samples = DEFAULT_SAMPLES;
+  guint8 *packed, *unpacked;
+  gint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    iterations = MAX (atoi (argv[1]), 1);
+  if (argc > 2)
+    samples = MAX (atoi (argv[2]), 1);
+
+  /* large enough for any format, packed or unpacked */
+  packed = g_malloc (samples * 8);
+  unpacked = g_malloc (samples * 8);
+  for (i = 0; i < samples * 8; i++)
+    packed[i] = g_random_int_range (0, 256);
+
+  g_print ("%d samples, %d iterations\n", samples, iterations);
+  g_print ("%-10s %14s %14s\n", "format", "unpack MS/s", "pack MS/s");
+
+  for (format = GST_AUDIO_FORMAT_S8; format <= GST_AUDIO_FORMAT_F64BE;
+      format++) {
+    const GstAudioFormatInfo *finfo = gst_audio_format_get_info (format);
+    gdouble u, p;
+
+    if (finfo->unpack_func == NULL || finfo->pack_func == NULL)
+      continue;
+
+    /* warm up the caches once */
+    finfo->unpack_func (finfo, 0, unpacked, packed, samples);
+
+    u = run (finfo, FALSE, unpacked, packed, samples, iterations);
+    p = run (finfo, TRUE, unpacked, packed, samples, iterations);
+
+    g_print ("%-10s %14.1f %14.1f\n", GST_AUDIO_FORMAT_INFO_NAME (finfo), u,
+        p);
+  }
+
+  g_free (packed);
+  g_free (unpacked);
+
+  return 0;
+}
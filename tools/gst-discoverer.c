@@ -35,6 +35,8 @@ static void my_g_string_append_printf (GString * str, int depth, const gchar * f
 /* *INDENT-ON* */
 
 static gboolean async = FALSE;
+static gint jobs = 1;
+static gboolean header_only = FALSE;
 static gboolean show_toc = FALSE;
 static gboolean verbose = FALSE;
 
@@ -540,6 +542,10 @@ main (int argc, char **argv)
   GOptionEntry options[] = {
     {"async", 'a', 0, G_OPTION_ARG_NONE, &async,
         "Run asynchronously", NULL},
+    {"jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+        "Number of URIs to discover in parallel (implies --async)", "N"},
+    {"header-only", 'H', 0, G_OPTION_ARG_NONE, &header_only,
+        "Only demux and parse streams, don't decode them", NULL},
     {"timeout", 't', 0, G_OPTION_ARG_INT, &timeout,
         "Specify timeout (in seconds, default 10)", "T"},
     /* {"elem", 'e', 0, G_OPTION_ARG_NONE, &elem_seek, */
@@ -574,6 +580,12 @@ main (int argc, char **argv)
     exit (-1);
   }
 
+  if (jobs < 1 || jobs > 256) {
+    g_print ("usage: %s [-j N] <uris>, N must be between 1 and 256\n",
+        argv[0]);
+    exit (-1);
+  }
+
   dc = gst_discoverer_new (timeout * GST_SECOND, &err);
   if (G_UNLIKELY (dc == NULL)) {
     g_print ("Error initializing: %s\n", err->message);
@@ -581,6 +593,14 @@ main (int argc, char **argv)
     exit (1);
   }
 
+  if (header_only)
+    g_object_set (dc, "header-only", TRUE, NULL);
+
+  if (jobs > 1) {
+    async = TRUE;
+    g_object_set (dc, "max-concurrent", jobs, NULL);
+  }
+
   if (!async) {
     gint i;
     for (i = 1; i < argc; i++)
@@ -412,6 +412,8 @@ gst_video_dither_method_get_type (void)
       {GST_VIDEO_DITHER_SIERRA_LITE, "GST_VIDEO_DITHER_SIERRA_LITE",
           "sierra-lite"},
       {GST_VIDEO_DITHER_BAYER, "GST_VIDEO_DITHER_BAYER", "bayer"},
+      {GST_VIDEO_DITHER_BLUE_NOISE, "GST_VIDEO_DITHER_BLUE_NOISE",
+          "blue-noise"},
       {0, NULL, NULL}
     };
     GType g_define_type_id =